@@ -1,7 +1,7 @@
 /*----==== ENGINE.CPP ====----
 	Author:		Jeff Kiah
 	Orig.Date:	06/21/2009
-	Rev.Date:	07/08/2009
+	Rev.Date:	10/17/2026
 ----------------------------*/
 
 #include "Engine.h"
@@ -9,7 +9,10 @@
 #include "HighPerfTimer.h"
 #include "Event/EventManager.h"
 #include "Event/RegisteredEvents.h"
+#include "Event/EventSerialization.h"
 #include "Process/ProcessManager.h"
+#include "Process/JobSystem.h"
+#include "Process/ResumableProcess.h"
 #include "Resource/ResCache.h"
 #include "Scripting/ScriptManager_Lua.h"
 #include "Render/RenderManager_D3D9.h"
@@ -227,6 +230,8 @@ bool Engine::initEngine()
 	renderTimer->start();
 	updateTimer = new HighPerfTimer();
 	updateTimer->start();
+	// create Job System first, the managers below may spawn jobs
+	mJobSys = new JobSystem();
 	// create Event System
 	mEventMgr = new EventManager();
 	// create Engine Event Listener
@@ -236,14 +241,19 @@ bool Engine::initEngine()
 	// create Resource Cache Manager
 	// TEMP these hard-coded values should come from real-time memory queries
 	mResCacheMgr = new ResCacheManager(2048, 512);
+	// create the listener that wakes resumable processes, after the cache's own load listener
+	mAwaitListener = new AwaitListener();
 	// create Physics Scene
 	mPhysicsScene = new PhysicsScene();
 	// create Lua Scripting System
 	mLuaMgr = new ScriptManager_Lua();
 
 	// register engine events
-	mEventMgr->registerEventType(ChangeSettingsEvent::sEventType,
-		RegEventPtr(new ScriptCallableCodeEvent<ChangeSettingsEvent>(EventDataType_NotEmpty)));
+	RegEventPtr settingsRegPtr(new ScriptCallableCodeEvent<ChangeSettingsEvent>(EventDataType_NotEmpty));
+	settingsRegPtr->setCoalesceKeyFunc(&ChangeSettingsEvent::coalesceKey);
+	settingsRegPtr->setReadEventFunc(&deserializeEvent<ChangeSettingsEvent>);
+	settingsRegPtr->setCategory(EventCategory_Engine);
+	mEventMgr->registerEventType(ChangeSettingsEvent::sEventType, settingsRegPtr);
 
 	// set the init flag
 	mInitFlags[INIT_ENGINE] = true;
@@ -452,10 +462,12 @@ void Engine::deInitEngine()
 	if (mInitFlags[INIT_ENGINE]) {
 		delete mLuaMgr;
 		delete mPhysicsScene;
+		delete mAwaitListener;
 		delete mResCacheMgr;
 		delete mProcMgr;
 		delete mEventListener;
 		delete mEventMgr;
+		delete mJobSys;
 		delete updateTimer;
 		delete renderTimer;
 	}
@@ -1,7 +1,7 @@
 /*----==== ENGINE.H ====----
 	Author:		Jeff Kiah
 	Orig.Date:	06/21/2009
-	Rev.Date:	03/03/2010
+	Rev.Date:	10/17/2026
 --------------------------*/
 
 #pragma once
@@ -24,8 +24,10 @@ using std::bitset;
 ///// STRUCTURES /////
 
 //class FastMath;
+class JobSystem;
 class EventManager;
 class ProcessManager;
+class AwaitListener;
 class ResCacheManager;
 class ScriptManager_Lua;
 class EngineEventListener;
@@ -46,8 +48,10 @@ class Engine : public Singleton<Engine> {
 		HighPerfTimer *			renderTimer;
 		HighPerfTimer *			updateTimer;
 		Settings				mSettings;
+		JobSystem *				mJobSys;
 		EventManager *			mEventMgr;
 		ProcessManager *		mProcMgr;
+		AwaitListener *			mAwaitListener;
 		ResCacheManager *		mResCacheMgr;
 		ScriptManager_Lua *		mLuaMgr;
 		EngineEventListener *	mEventListener;
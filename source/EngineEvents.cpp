@@ -1,31 +1,59 @@
 /*----==== ENGINEEVENTS.CPP ====----
 	Author:		Jeff Kiah
 	Orig.Date:	06/28/2009
-	Rev.Date:	06/28/2009
+	Rev.Date:	10/17/2026
 ----------------------------------*/
 
 #include "EngineEvents.h"
 #include "Engine.h"
+#include "Event/EventSerialization.h"
+
+///// VARIABLES /////
+
+// Interned once, script data is matched on these rather than by string compare
+static const ScriptVarKey sWndResXKey		= ScriptVarKey::intern("wndResX");
+static const ScriptVarKey sWndResYKey		= ScriptVarKey::intern("wndResY");
+static const ScriptVarKey sFsResXKey		= ScriptVarKey::intern("fsResX");
+static const ScriptVarKey sFsResYKey		= ScriptVarKey::intern("fsResY");
+static const ScriptVarKey sBppKey			= ScriptVarKey::intern("bpp");
+static const ScriptVarKey sRefreshRateKey	= ScriptVarKey::intern("refreshRate");
+static const ScriptVarKey sFullscreenKey	= ScriptVarKey::intern("fullscreen");
+static const ScriptVarKey sVsyncKey			= ScriptVarKey::intern("vsync");
 
 ////////// class ChangeSettingsEvent //////////
 
 const string ChangeSettingsEvent::sEventType("SYS_CHANGE_SETTINGS");
+const EventTypeId ChangeSettingsEvent::sEventTypeId(EVENT_TYPE_ID("SYS_CHANGE_SETTINGS"));
 
 /*---------------------------------------------------------------------
-	This is called to construct script data out of a code-defined event
+	Writes the fields for script handlers of a code-defined event
 ---------------------------------------------------------------------*/
-void ChangeSettingsEvent::buildScriptData()
+void ChangeSettingsEvent::writeScriptData(IScriptDataWriter &writer) const
+{
+	writer.setInt(sWndResXKey, wndResX);
+	writer.setInt(sWndResYKey, wndResY);
+	writer.setInt(sFsResXKey, fsResX);
+	writer.setInt(sFsResYKey, fsResY);
+	writer.setInt(sBppKey, bpp);
+	writer.setInt(sRefreshRateKey, refreshRate);
+	writer.setBool(sFullscreenKey, fullscreen);
+	writer.setBool(sVsyncKey, vsync);
+}
+
+void ChangeSettingsEvent::serialize(ostream &out) const
 {
-	mScriptData.clear();
-	mScriptData.push_back(AnyVarsValue("wndResX", wndResX));
-	mScriptData.push_back(AnyVarsValue("wndResY", wndResY));
-	mScriptData.push_back(AnyVarsValue("fsResX", fsResX));
-	mScriptData.push_back(AnyVarsValue("fsResY", fsResY));
-	mScriptData.push_back(AnyVarsValue("bpp", bpp));
-	mScriptData.push_back(AnyVarsValue("refreshRate", refreshRate));
-	mScriptData.push_back(AnyVarsValue("fullscreen", fullscreen));
-	mScriptData.push_back(AnyVarsValue("vsync", vsync));
-	mScriptDataBuilt = true;
+	writeBinary(out, wndResX);	writeBinary(out, wndResY);
+	writeBinary(out, fsResX);	writeBinary(out, fsResY);
+	writeBinary(out, bpp);		writeBinary(out, refreshRate);
+	writeBinary(out, fullscreen);	writeBinary(out, vsync);
+}
+
+void ChangeSettingsEvent::deserialize(istream &in)
+{
+	readBinary(in, wndResX);	readBinary(in, wndResY);
+	readBinary(in, fsResX);		readBinary(in, fsResY);
+	readBinary(in, bpp);		readBinary(in, refreshRate);
+	readBinary(in, fullscreen);	readBinary(in, vsync);
 }
 
 /*---------------------------------------------------------------------
@@ -33,35 +61,34 @@ void ChangeSettingsEvent::buildScriptData()
 	current values in Engine::mSettings, so if they aren't all supplied
 	by script, the setting will go unchanged.
 ---------------------------------------------------------------------*/
-ChangeSettingsEvent::ChangeSettingsEvent(const AnyVars &eventData) :
+ChangeSettingsEvent::ChangeSettingsEvent(const ScriptVars &eventData) :
 	ScriptableEvent(eventData),
 	wndResX(engine.mSettings.resX), wndResY(engine.mSettings.resY),
 	fsResX(engine.mSettings.fsResX), fsResY(engine.mSettings.fsResY),
 	bpp(engine.mSettings.bpp), refreshRate(engine.mSettings.refreshRate),
 	fullscreen(engine.mSettings.fullscreen), vsync(engine.mSettings.vsync)
 {
-	for (AnyVars::const_iterator i = eventData.begin(); i != eventData.end(); ++i) {
-		try {
-			if (_stricmp(i->first.c_str(), "wndResX") == 0) {
-				wndResX = any_cast<int>(i->second);
-			} else if (_stricmp(i->first.c_str(), "wndResY") == 0) {
-				wndResY = any_cast<int>(i->second);
-			} else if (_stricmp(i->first.c_str(), "fsResX") == 0) {
-				fsResX = any_cast<int>(i->second);
-			} else if (_stricmp(i->first.c_str(), "fsResY") == 0) {
-				fsResY = any_cast<int>(i->second);
-			} else if (_stricmp(i->first.c_str(), "bpp") == 0) {
-				bpp = any_cast<int>(i->second);
-			} else if (_stricmp(i->first.c_str(), "refreshRate") == 0) {
-				refreshRate = any_cast<int>(i->second);
-			} else if (_stricmp(i->first.c_str(), "fullscreen") == 0) {
-				fullscreen = any_cast<bool>(i->second);
-			} else if (_stricmp(i->first.c_str(), "vsync") == 0) {
-				vsync = any_cast<bool>(i->second);
-			}
-		} catch (const boost::bad_any_cast &ex) {
-			// nothing happens with a bad datatype in release build, silently ignores
-			debugPrintf("DeviceChangeEvent: bad_any_cast \"%s\"\n", ex.what());
+	for (ScriptVars::const_iterator i = eventData.begin(); i != eventData.end(); ++i) {
+		bool ok = true;
+		if (i->key == sWndResXKey) {
+			ok = i->value.get(wndResX);
+		} else if (i->key == sWndResYKey) {
+			ok = i->value.get(wndResY);
+		} else if (i->key == sFsResXKey) {
+			ok = i->value.get(fsResX);
+		} else if (i->key == sFsResYKey) {
+			ok = i->value.get(fsResY);
+		} else if (i->key == sBppKey) {
+			ok = i->value.get(bpp);
+		} else if (i->key == sRefreshRateKey) {
+			ok = i->value.get(refreshRate);
+		} else if (i->key == sFullscreenKey) {
+			ok = i->value.get(fullscreen);
+		} else if (i->key == sVsyncKey) {
+			ok = i->value.get(vsync);
+		}
+		if (!ok) { // nothing happens with a bad datatype in release build, silently ignores
+			debugPrintf("ChangeSettingsEvent: bad type for \"%s\"\n", i->key.name);
 		}
 	}
 }
@@ -1,7 +1,7 @@
 /*----==== ENGINEEVENTS.H ====----
 	Author:		Jeff Kiah
 	Orig.Date:	06/25/2009
-	Rev.Date:	06/28/2009
+	Rev.Date:	10/17/2026
 --------------------------------*/
 
 #pragma once
@@ -24,6 +24,7 @@ class ChangeSettingsEvent : public ScriptableEvent {
 		///// VARIABLES /////
 		// Static
 		static const string sEventType;
+		static const EventTypeId sEventTypeId;
 
 		// Member
 		int		wndResX, wndResY;
@@ -35,13 +36,19 @@ class ChangeSettingsEvent : public ScriptableEvent {
 
 		///// FUNCTIONS /////
 		virtual const string & type() const { return sEventType; }
-		virtual void serialize(ostream &out) const {}
-		virtual void deserialize(istream &in) {}
+		virtual EventTypeId typeId() const { return sEventTypeId; }
+		virtual void serialize(ostream &out) const;
+		virtual void deserialize(istream &in);
 
 		/*---------------------------------------------------------------------
-			This is called to construct script data out of a code-defined event
+			Writes the fields for script handlers of a code-defined event
 		---------------------------------------------------------------------*/
-		virtual void buildScriptData();
+		virtual void writeScriptData(IScriptDataWriter &writer) const;
+
+		/*---------------------------------------------------------------------
+			Coalesce key, every settings change supersedes the last
+		---------------------------------------------------------------------*/
+		static uint64 coalesceKey(const Event &e) { return 0; }
 
 		// Constructors
 		explicit ChangeSettingsEvent(int _wndResX, int _wndResY, int _fsResX, int _fsResY,
@@ -55,7 +62,15 @@ class ChangeSettingsEvent : public ScriptableEvent {
 			current values in Engine::mSettings, so if they aren't all supplied
 			by script, the setting will go unchanged.
 		---------------------------------------------------------------------*/
-		explicit ChangeSettingsEvent(const AnyVars &eventData);
+		explicit ChangeSettingsEvent(const ScriptVars &eventData);
+		/*---------------------------------------------------------------------
+			Used by deserializeEvent, the data is filled in by deserialize
+		---------------------------------------------------------------------*/
+		explicit ChangeSettingsEvent() :
+			ScriptableEvent(),
+			wndResX(0), wndResY(0), fsResX(0), fsResY(0),
+			bpp(0), refreshRate(0), fullscreen(false), vsync(false)
+		{}
 
 		// Destructor
 		virtual ~ChangeSettingsEvent() {}
@@ -0,0 +1,142 @@
+/*----==== BOUNDEDEVENTQUEUE.CPP ====----
+	Author:		Jeff Kiah
+	Orig.Date:	10/17/2026
+	Rev.Date:	10/17/2026
+---------------------------------------*/
+
+#include "BoundedEventQueue.h"
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+////////// class BoundedEventQueue //////////
+
+/*-----------------------------------------------------------------------------
+	Under the Block policy, reserves room for one event, waiting if the queue
+	is full. The count is only incremented when there is room, so it never
+	goes over capacity unless a wait times out.
+-----------------------------------------------------------------------------*/
+void BoundedEventQueue::reserveBlocking()
+{
+	bool waited = false;
+	boost::system_time timeout;
+	for (;;) {
+		LONG count = mCount;
+		if (count < static_cast<LONG>(mCapacity)) {
+			if (InterlockedCompareExchange(&mCount, count + 1, count) == count) return;
+			continue; // another producer got there first
+		}
+		if (!waited) {
+			waited = true;
+			InterlockedIncrement(&mNumBlocked);
+			timeout = boost::get_system_time() + boost::posix_time::milliseconds(EVENTQUEUE_MAX_BLOCK_MILLIS);
+		}
+		mutex::scoped_lock lock(mSpaceMutex);
+		InterlockedIncrement(&mSpaceWaiters); // full barrier, pairs with the one in release
+		bool timedOut = false;
+		while (mCount >= static_cast<LONG>(mCapacity) && !timedOut) {
+			timedOut = !mSpaceCondVar.timed_wait(lock, timeout);
+		}
+		InterlockedDecrement(&mSpaceWaiters);
+		if (timedOut && mCount >= static_cast<LONG>(mCapacity)) {
+			// the consumer isn't keeping up (or isn't running), go over rather than hang
+			InterlockedIncrement(&mNumOverflowed);
+			InterlockedIncrement(&mCount);
+			return;
+		}
+	}
+}
+
+/*-----------------------------------------------------------------------------
+	Consumer side. Enforces capacity for DropOldest and Coalesce and updates
+	the high water mark, before events are taken.
+-----------------------------------------------------------------------------*/
+void BoundedEventQueue::applyOverflow()
+{
+	uint count = static_cast<uint>(mCount);
+	if (count > mHighWater) mHighWater = count;
+	if (mCapacity == 0 || count <= mCapacity || mPolicy == EventOverflow_Block) return;
+
+	if (mPolicy == EventOverflow_Coalesce && mKeyFunc) {
+		uint removed = mQueue.coalesce(mKeyFunc);
+		mNumCoalesced += removed;
+		release(removed);
+		count = static_cast<uint>(mCount);
+		if (count <= mCapacity) return;
+	}
+	uint dropped = mQueue.dropFront(count - mCapacity);
+	mNumDropped += dropped;
+	release(dropped);
+	debugPrintf("BoundedEventQueue: over capacity, %u events dropped\n", dropped);
+}
+
+/*-----------------------------------------------------------------------------
+	Consumer side. Gives back room for taken or discarded events and wakes
+	producers waiting on it.
+-----------------------------------------------------------------------------*/
+void BoundedEventQueue::release(uint count)
+{
+	if (count == 0) return;
+	InterlockedExchangeAdd(&mCount, -static_cast<LONG>(count)); // full barrier
+	if (mSpaceWaiters > 0) {
+		// taking the lock guarantees a waiter is either inside wait or hasn't
+		// checked the count yet, so the notify can't be lost
+		mutex::scoped_lock lock(mSpaceMutex);
+		lock.unlock();
+		mSpaceCondVar.notify_all();
+	}
+}
+
+/*-----------------------------------------------------------------------------
+	Consumer only, copies the counters
+-----------------------------------------------------------------------------*/
+EventQueueStats BoundedEventQueue::stats() const
+{
+	EventQueueStats s;
+	s.pushed = static_cast<uint>(mNumPushed);
+	s.dropped = mNumDropped;
+	s.coalesced = mNumCoalesced;
+	s.blocked = static_cast<uint>(mNumBlocked);
+	s.overflowed = static_cast<uint>(mNumOverflowed);
+	s.highWater = mHighWater;
+	return s;
+}
+
+/*-----------------------------------------------------------------------------
+	Safe to call from any thread. May wait under the Block policy.
+-----------------------------------------------------------------------------*/
+void BoundedEventQueue::push(const EventPtr &ePtr)
+{
+	if (mCapacity > 0 && mPolicy == EventOverflow_Block && GetCurrentThreadId() != mConsumerThreadId) {
+		reserveBlocking();
+	} else {
+		InterlockedIncrement(&mCount);
+	}
+	InterlockedIncrement(&mNumPushed);
+	mQueue.push(ePtr);
+}
+
+/*-----------------------------------------------------------------------------
+	Consumer only, see MPSCQueue
+-----------------------------------------------------------------------------*/
+bool BoundedEventQueue::tryPop(EventPtr &outPtr)
+{
+	applyOverflow();
+	if (!mQueue.tryPop(outPtr)) return false;
+	release(1);
+	return true;
+}
+
+void BoundedEventQueue::waitPop(EventPtr &outPtr)
+{
+	applyOverflow();
+	mQueue.waitPop(outPtr);
+	release(1);
+}
+
+// Constructor
+BoundedEventQueue::BoundedEventQueue(uint capacity, EventOverflowPolicy policy) :
+	mQueue(), mCount(0),
+	mCapacity(capacity), mPolicy(policy), mKeyFunc(0),
+	mConsumerThreadId(0), mSpaceWaiters(0),
+	mNumPushed(0), mNumBlocked(0), mNumOverflowed(0),
+	mNumDropped(0), mNumCoalesced(0), mHighWater(0)
+{}
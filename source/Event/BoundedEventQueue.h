@@ -0,0 +1,164 @@
+/*----==== BOUNDEDEVENTQUEUE.H ====----
+	Author:		Jeff Kiah
+	Orig.Date:	10/17/2026
+	Rev.Date:	10/17/2026
+-------------------------------------*/
+
+#pragma once
+
+#include <boost/noncopyable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include "Event.h"
+#include "../Utility/MPSCQueue.h"
+#include "../Utility/Typedefs.h"
+
+using boost::mutex;
+using boost::condition_variable;
+
+///// DEFINITIONS /////
+
+#define EVENTQUEUE_MAX_BLOCK_MILLIS	100	// longest a producer waits for room before pushing anyway
+
+/*=============================================================================
+	What happens when a producer pushes into a full queue
+=============================================================================*/
+enum EventOverflowPolicy : uchar {
+	EventOverflow_Block = 0,	// the producer waits for the consumer to make room, up to
+								// EVENTQUEUE_MAX_BLOCK_MILLIS, so a runaway thread is throttled
+	EventOverflow_DropOldest,	// the consumer discards the oldest events beyond capacity
+	EventOverflow_Coalesce		// the consumer collapses events with the same coalesce key, keeping
+								// the newest, then discards the oldest if still over capacity
+};
+
+///// STRUCTURES /////
+
+/*=============================================================================
+struct EventQueueStats
+	Counts for one queue since it was created. The producer-side counts are
+	updated with interlocked ops, so they are only approximate while pushes
+	are in flight.
+=============================================================================*/
+struct EventQueueStats {
+	uint	pushed;			// events accepted by push
+	uint	dropped;		// discarded by DropOldest, or by Coalesce when collapsing wasn't enough
+	uint	coalesced;		// discarded because a newer event with the same key superseded them
+	uint	blocked;		// pushes that had to wait for room
+	uint	overflowed;		// pushes that waited the maximum and went in over capacity anyway
+	uint	highWater;		// most events waiting at once, as seen by the consumer
+};
+
+/*=============================================================================
+class BoundedEventQueue
+	Multiple producer, single consumer event queue with an optional capacity.
+	Built on MPSCQueue, so an unbounded queue (capacity 0, the default) costs
+	the same single interlocked push as before plus a count. When bounded,
+	the overflow policy decides what happens to a burst:
+	Block throttles producers, which is right for worker threads that must not
+	lose events (like resource load results) but shouldn't be allowed to bury
+	the consumer. Pushes from the consumer's own thread never block, or they
+	would deadlock, and a producer gives up waiting after
+	EVENTQUEUE_MAX_BLOCK_MILLIS so shutdown can't hang on a full queue.
+	DropOldest and Coalesce never block a producer, the consumer enforces the
+	capacity when it next takes events, so memory is bounded by what arrives
+	between two drains. Coalesce needs a key function, events it returns false
+	for are only ever dropped as the oldest.
+	The capacity and policy should be set before producers start pushing.
+=============================================================================*/
+class BoundedEventQueue : private boost::noncopyable {
+	public:
+		///// DEFINITIONS /////
+		typedef bool (*CoalesceKeyFunc)(const EventPtr &ePtr, uint64 &outGroup, uint64 &outKey);
+
+	private:
+		///// VARIABLES /////
+		MPSCQueue<EventPtr>	mQueue;
+		volatile LONG		mCount;			// events pushed and not yet taken by the consumer
+		uint				mCapacity;		// 0 is unbounded
+		EventOverflowPolicy	mPolicy;
+		CoalesceKeyFunc		mKeyFunc;
+		DWORD				mConsumerThreadId;	// pushes from this thread never block
+
+		// producers waiting for room under the Block policy
+		volatile LONG		mSpaceWaiters;
+		mutex				mSpaceMutex;
+		condition_variable	mSpaceCondVar;
+
+		// stats, the producer-side counts are LONG for the interlocked ops
+		volatile LONG		mNumPushed;
+		volatile LONG		mNumBlocked;
+		volatile LONG		mNumOverflowed;
+		uint				mNumDropped;
+		uint				mNumCoalesced;
+		uint				mHighWater;
+
+		///// FUNCTIONS /////
+		/*---------------------------------------------------------------------
+			Under the Block policy, reserves room for one event, waiting if the
+			queue is full
+		---------------------------------------------------------------------*/
+		void	reserveBlocking();
+
+		/*---------------------------------------------------------------------
+			Consumer side. Enforces capacity for DropOldest and Coalesce and
+			updates the high water mark, before events are taken.
+		---------------------------------------------------------------------*/
+		void	applyOverflow();
+
+		/*---------------------------------------------------------------------
+			Consumer side. Gives back room for taken or discarded events and
+			wakes producers waiting on it.
+		---------------------------------------------------------------------*/
+		void	release(uint count);
+
+	public:
+		uint				capacity() const	{ return mCapacity; }
+		EventOverflowPolicy	policy() const		{ return mPolicy; }
+		/*---------------------------------------------------------------------
+			Approximate, producers may be pushing
+		---------------------------------------------------------------------*/
+		uint				size() const		{ return static_cast<uint>(mCount); }
+		bool				empty() const		{ return mQueue.empty(); }
+
+		/*---------------------------------------------------------------------
+			Sets the capacity (0 for unbounded) and overflow policy
+		---------------------------------------------------------------------*/
+		void	setCapacity(uint capacity, EventOverflowPolicy policy) {
+					mCapacity = capacity;
+					mPolicy = policy;
+				}
+		void	setCoalesceKeyFunc(CoalesceKeyFunc keyFunc)	{ mKeyFunc = keyFunc; }
+		void	setConsumerThread(DWORD threadId)			{ mConsumerThreadId = threadId; }
+
+		/*---------------------------------------------------------------------
+			Consumer only, copies the counters
+		---------------------------------------------------------------------*/
+		EventQueueStats	stats() const;
+
+		/*---------------------------------------------------------------------
+			Safe to call from any thread. May wait under the Block policy.
+		---------------------------------------------------------------------*/
+		void	push(const EventPtr &ePtr);
+
+		/*---------------------------------------------------------------------
+			Consumer only, see MPSCQueue
+		---------------------------------------------------------------------*/
+		bool	tryPop(EventPtr &outPtr);
+		void	waitPop(EventPtr &outPtr);
+
+		/*---------------------------------------------------------------------
+			Consumer only. Calls func(const EventPtr &) on up to maxItems
+			events (0 for all), oldest first, after enforcing the capacity.
+			The rest stay queued. Returns the number handled.
+		---------------------------------------------------------------------*/
+		template <typename Func>
+		uint	drain(Func func, uint maxItems = 0) {
+					applyOverflow();
+					uint count = mQueue.drain(func, maxItems);
+					release(count);
+					return count;
+				}
+
+		// Constructor
+		explicit BoundedEventQueue(uint capacity = 0, EventOverflowPolicy policy = EventOverflow_Block);
+};
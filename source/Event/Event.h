@@ -1,7 +1,7 @@
 /*----==== EVENT.H ====----
 	Author: Jeffrey Kiah
 	Orig.Date: 07/28/2007
-	Rev.Date:  05/04/2009
+	Rev.Date:  10/17/2026
 -------------------------*/
 
 #pragma once
@@ -13,6 +13,8 @@
 #include <boost/any.hpp>
 #include <iostream>
 #include "../Utility/Typedefs.h"
+#include "EventTypeId.h"
+#include "ScriptVars.h"
 
 using std::string;	using std::shared_ptr;
 using std::ostream;	using std::istream;
@@ -25,7 +27,8 @@ enum EventState : uchar {
 	EventState_New = 0,
 	EventState_Raised,
 	EventState_Triggered,
-	EventState_Handled
+	EventState_Handled,
+	EventState_Scheduled	// waiting in the timer wheel to be raised
 };
 
 enum EventSource : uchar {
@@ -45,20 +48,55 @@ enum EventDataType : uchar {
 	EventDataType_NotEmpty		// determines that EventManager's raise and trigger by string cannot be used
 };
 
+/*=============================================================================
+	Event categories, one bit each. A registered event type belongs to one or
+	more categories (see RegisteredEvent::setCategory), and a wildcard
+	listener can subscribe with a mask of the categories it wants, so it is
+	never called for the rest. Types that don't set a category are General.
+=============================================================================*/
+typedef uint EventCategoryMask;
+
+enum EventCategory : uint {
+	EventCategory_None		= 0,
+	EventCategory_General	= 1 << 0,	// default for types that don't set one
+	EventCategory_Engine	= 1 << 1,	// settings, application and frame events
+	EventCategory_Input		= 1 << 2,
+	EventCategory_Physics	= 1 << 3,
+	EventCategory_Resource	= 1 << 4,	// loading and caching
+	EventCategory_Scripting	= 1 << 5,	// script calls and script-defined events
+	EventCategory_Render	= 1 << 6,
+	EventCategory_Audio		= 1 << 7,
+	EventCategory_Game		= 1 << 8,	// game code, the bits above this are free for game use too
+	EventCategory_All		= 0xFFFFFFFF
+};
+
+/*=============================================================================
+	Queue lanes for raised events, set per type with RegisteredEvent::
+	setPriority. notifyQueued handles the lanes in this order every frame.
+	Realtime is always drained whatever the time budget, Normal runs within
+	the budget, and Bulk gets what is left (or its own smaller budget), so
+	when a frame runs out of time it is bulk traffic that rolls over.
+=============================================================================*/
+enum EventPriority : uchar {
+	EventPriority_Realtime = 0,	// input and UI, latency sensitive, never deferred
+	EventPriority_Normal,		// default
+	EventPriority_Bulk,			// high volume and deferrable, like resource requests
+	EventPriority_NumLanes
+};
+
 class Event;
 class RegisteredEvent;
 typedef shared_ptr<Event>	EventPtr;
 typedef shared_ptr<RegisteredEvent>	RegEventPtr;
-typedef pair<string, any>	AnyVarsValue;	// key/value pair where string is key and value utilizes boost::any
-typedef list<AnyVarsValue>	AnyVars;		// list of key/value pairs. This does not provide constant time
-											// random access to elements, so lists should generally be short
 ///// STRUCTURES /////
 
 /*=============================================================================
 class Event
 	An abstract base class for all Event types to inherit from. There are pure
 	virtual methods to be overloaded. type() should usually return a const
-	reference to a static string variable with the event type name. mTime and
+	reference to a static string variable with the event type name, and
+	typeId() the matching static EventTypeId. typeId() is what EventManager
+	dispatches on, type() is kept for debugging and script. mTime and
 	mState are private because derived classes should not try to manage those
 	attributes since EventManager does that job.
 =============================================================================*/
@@ -78,6 +116,7 @@ class Event : private boost::noncopyable {
 
 	public:
 		virtual const string &	type() const = 0;
+		virtual EventTypeId		typeId() const = 0;
 		__int64					time() const	{ return mTime; }
 		EventState				state() const	{ return mState; }
 
@@ -110,7 +149,11 @@ class ScriptableEvent
 	from script, just inherit from Event instead. This adds two new attributes,
 	some public interfaces to deal with the new attributes, a new virtual
 	function to be overloaded, and requires a new constructor signature to be
-	implemented in the derived class (const AnyVars &).
+	implemented in the derived class (const ScriptVars &).
+	writeScriptData writes the native fields to an IScriptDataWriter. The Lua
+	handler passes its table writer straight in, so an event raised in code
+	reaches script without building a ScriptVars at all. buildScriptData is
+	only needed when something wants the data as a ScriptVars.
 	**NOTE**
 	Event handlers for ScriptableEvents should treat any custom event data as
 	immutable, since serialization to/from script data only occurs once in an
@@ -122,9 +165,9 @@ class ScriptableEvent
 =============================================================================*/
 class ScriptableEvent : public Event {
 	protected:
-		AnyVars	mScriptData;		// adds a private var to store event data for script handlers
-		bool	mScriptDataBuilt;	// tracks whether the event data has been built (only built when
-									// fired from script, or if it actually has a script handler)
+		ScriptVars	mScriptData;		// adds a private var to store event data for script handlers
+		bool		mScriptDataBuilt;	// tracks whether the event data has been built (only built when
+										// fired from script, or when buildScriptData is called)
 	public:
 		/*---------------------------------------------------------------------
 			Check this prior to calling buildScriptData when handling a script
@@ -134,14 +177,24 @@ class ScriptableEvent : public Event {
 		/*---------------------------------------------------------------------
 			Get access to the script data
 		---------------------------------------------------------------------*/
-		const AnyVars &	getScriptData() const { return mScriptData; }
+		const ScriptVars &	getScriptData() const { return mScriptData; }
 
 		/*---------------------------------------------------------------------
-			Scriptable events should overload this to build the mEventData list
-			from its native property values. It should also set mEventDataBuilt
-			to true before returning.
+			Scriptable events should overload this to write their native
+			property values with interned keys. Must write the same keys the
+			ScriptVars constructor reads.
 		---------------------------------------------------------------------*/
-		virtual void	buildScriptData() = 0;
+		virtual void	writeScriptData(IScriptDataWriter &writer) const = 0;
+
+		/*---------------------------------------------------------------------
+			Builds mScriptData from writeScriptData, once
+		---------------------------------------------------------------------*/
+		void			buildScriptData() {
+							if (mScriptDataBuilt) return;
+							ScriptVarsWriter writer(mScriptData);
+							writeScriptData(writer);
+							mScriptDataBuilt = true;
+						}
 
 		/*---------------------------------------------------------------------
 			This constructor would be called on the code side, does not set
@@ -155,13 +208,13 @@ class ScriptableEvent : public Event {
 		/*---------------------------------------------------------------------
 			This constructor would be called by the script manager for an event
 			fired from script. Derived classes should implement a constructor
-			with the same signature and convert AnyVar values to native object
-			properties. The constructor would call this to init the the base
+			with the same signature and convert ScriptVars values to native
+			object properties. The constructor would call this to init the the base
 			class.
 		---------------------------------------------------------------------*/
-		explicit ScriptableEvent(const AnyVars &eventData) :
+		explicit ScriptableEvent(const ScriptVars &eventData) :
 			Event(),
-			mScriptData(eventData),	// nice, the std::list, std::pair and boost::any are all copy constructible
+			mScriptData(eventData),	// shallow, strings and tables in the values are shared
 			mScriptDataBuilt(true)
 		{}
 		virtual ~ScriptableEvent() {}
@@ -172,37 +225,40 @@ class ScriptEvent
 	ScriptEvent is registered in script, so we know it will only have script
 	handlers. For that reason, any data passed in the event doesn't need to be
 	translated to and from native C++ types, basically pass whatever data
-	object as the only occupant of the AnyVars list, and it will just be passed
+	object as the only occupant of the ScriptVars list, and it will just be passed
 	right back untouched. This acts as a simple pass-through class.
 =============================================================================*/
 class ScriptEvent : public ScriptableEvent {
 	friend class ScriptDefinedEvent;
 	private:
-		string	mEventType;
+		string		mEventType;
+		EventTypeId	mEventTypeId;
 
 		/*---------------------------------------------------------------------
 			To prevent programmers from inheriting this by mistake (instead of
 			ScriptableEvent) made constructor private and friended
 			class ScriptDefinedEvent where this is called.
 		---------------------------------------------------------------------*/
-		explicit ScriptEvent(const string &eventType, const AnyVars &eventData) :
+		explicit ScriptEvent(const string &eventType, const ScriptVars &eventData) :
 			ScriptableEvent(eventData),
-			mEventType(eventType)
+			mEventType(eventType),
+			mEventTypeId(hashEventType(eventType))
 		{}
 	public:
-		virtual const string & type() const { return mEventType; }
+		virtual const string &	type() const	{ return mEventType; }
+		virtual EventTypeId		typeId() const	{ return mEventTypeId; }
 
 		/*---------------------------------------------------------------------
 			Since this is a pass-through object, the event data will always be
 			built in the constructor (notice there is no default constructor),
 			so there is never a need to call this method.
 		---------------------------------------------------------------------*/
-		virtual void	buildScriptData() { // a debug build will catch this method being called
+		virtual void	writeScriptData(IScriptDataWriter &) const { // a debug build will catch this method being called
 							_ASSERTE(false && "Should never call this method for script-only events!");
 						}
 
 		virtual void	serialize(ostream &out) const { out << mEventType; }
-		virtual void	deserialize(istream &in) { in >> mEventType; }
+		virtual void	deserialize(istream &in) { in >> mEventType; mEventTypeId = hashEventType(mEventType); }
 
 		virtual ~ScriptEvent() {}
 };
@@ -224,18 +280,23 @@ class EmptyEvent
 class EmptyEvent : public Event {
 	friend class EventManager;
 	private:
-		string	mEventType;
+		string		mEventType;
+		EventTypeId	mEventTypeId;
 
+	protected:
 		// Constructors
-		explicit EmptyEvent(const string &eventType) :	// We don't want empty events being created anywhere, so to avoid the
-			Event(),									// unsafe practice of constructing these manually, it is made private.
-			mEventType(eventType)						// Friending EventManager lets it create these from raise and trigger
-		{}												// by string methods.
+		explicit EmptyEvent(const string &eventType,	// We don't want empty events being created anywhere, so to avoid the
+							EventTypeId eventTypeId) :	// unsafe practice of constructing these manually, it is made protected.
+			Event(),									// EventManager creates these from raise and trigger by string methods
+			mEventType(eventType),						// through a derived class so they can come from the event pool. The
+			mEventTypeId(eventTypeId)					// manager passes in the id it already hashed to look up the registration.
+		{}
 	public:
-		virtual const string & type() const { return mEventType; }
+		virtual const string &	type() const	{ return mEventType; }
+		virtual EventTypeId		typeId() const	{ return mEventTypeId; }
 		
 		virtual void	serialize(ostream &out) const { out << mEventType; }
-		virtual void	deserialize(istream &in) { in >> mEventType; }
+		virtual void	deserialize(istream &in) { in >> mEventType; mEventTypeId = hashEventType(mEventType); }
 
 		/*---------------------------------------------------------------------
 			This contructor is only made public so the program will compile
@@ -246,10 +307,10 @@ class EmptyEvent : public Event {
 			Empty events can be created from script, but are handled as a
 			special case to avoid overhead, so no need for this constructor to
 			ever be called (just needs to be here to compile). If I had derived
-			from ScriptableEvent, it would carry an unneeded AnyVars attribute.
+			from ScriptableEvent, it would carry an unneeded ScriptVars attribute.
 		---------------------------------------------------------------------*/
-		explicit EmptyEvent(const AnyVars &) {
-			_ASSERTE(false && "Shouldn't be calling EmptyEvent(const AnyVars &) constructor!");
+		explicit EmptyEvent(const ScriptVars &) : mEventTypeId(0) {
+			_ASSERTE(false && "Shouldn't be calling EmptyEvent(const ScriptVars &) constructor!");
 		}
 		// Destructor
 		virtual ~EmptyEvent() {}
@@ -262,16 +323,37 @@ class RegisteredEvent
 	or raised. They are registered using one of the derived types.
 =============================================================================*/
 class RegisteredEvent {
+	public:
+		///// DEFINITIONS /////
+		/*---------------------------------------------------------------------
+			Returns the key that identifies what state an event describes, for
+			event types where only the latest event per key matters. Events
+			of the type with different state must get different keys, two
+			events are only coalesced if their keys are equal.
+		---------------------------------------------------------------------*/
+		typedef uint64 (*CoalesceKeyFunc)(const Event &e);
+
+		/*---------------------------------------------------------------------
+			Creates an event of the type from its serialized form, see
+			deserializeEvent in EventSerialization.h
+		---------------------------------------------------------------------*/
+		typedef EventPtr (*ReadEventFunc)(istream &in);
+
 	private:
 		const EventSource		mEventSource;
 		const EventDataType		mEventDataType;
+		CoalesceKeyFunc			mCoalesceKeyFunc;	// null unless the type has opted in to coalescing
+		ReadEventFunc			mReadEventFunc;		// null unless the type can be read back from an event log
+		EventCategoryMask		mCategory;			// EventCategory bits, General by default
+		EventPriority			mPriority;			// queue lane for raised events, Normal by default
 
 	public:
 		/*---------------------------------------------------------------------
 			Called from scripting manager for events triggered/raised in script
 		---------------------------------------------------------------------*/
-		virtual	bool		triggerEventFromScript(const string &eventType, const AnyVars &eventData) const = 0;
-		virtual	bool		raiseEventFromScript(const string &eventType, const AnyVars &eventData) const = 0;
+		virtual	bool		triggerEventFromScript(const string &eventType, const ScriptVars &eventData) const = 0;
+		virtual	bool		raiseEventFromScript(const string &eventType, const ScriptVars &eventData,
+												 ulong delayMillis) const = 0;
 		/*---------------------------------------------------------------------
 			This is basically RTTI for this class hierarchy
 		---------------------------------------------------------------------*/
@@ -289,10 +371,60 @@ class RegisteredEvent {
 		---------------------------------------------------------------------*/
 		bool				isEmpty() const			{ return (mEventDataType == EventDataType_Empty); }
 
+		/*---------------------------------------------------------------------
+			Opts the event type in to coalescing. When an event of this type
+			is raised while another with the same key is still queued, the
+			new event replaces the old one in its queue position instead of
+			being added. For events carrying state where only the latest
+			value matters. Set it before registering the type.
+		---------------------------------------------------------------------*/
+		void				setCoalesceKeyFunc(CoalesceKeyFunc func) { mCoalesceKeyFunc = func; }
+		bool				isCoalesced() const		{ return (mCoalesceKeyFunc != 0); }
+		uint64				coalesceKey(const Event &e) const {
+								_ASSERTE(mCoalesceKeyFunc);
+								return mCoalesceKeyFunc(e);
+							}
+
+		/*---------------------------------------------------------------------
+			Makes the event type serializable for event logs. Empty event
+			types don't need this, they are recorded by type id alone. Events
+			of a type that isn't serializable are left out of recordings.
+		---------------------------------------------------------------------*/
+		void				setReadEventFunc(ReadEventFunc func) { mReadEventFunc = func; }
+		bool				isSerializable() const	{ return (isEmpty() || mReadEventFunc != 0); }
+		EventPtr			readEvent(istream &in) const {
+								_ASSERTE(mReadEventFunc);
+								return mReadEventFunc(in);
+							}
+
+		/*---------------------------------------------------------------------
+			Sets the categories the event type belongs to, used to filter
+			wildcard listeners. Set it before registering the type.
+		---------------------------------------------------------------------*/
+		void				setCategory(EventCategoryMask category) {
+								_ASSERTE(category != EventCategory_None);
+								mCategory = category;
+							}
+		EventCategoryMask	category() const		{ return mCategory; }
+
+		/*---------------------------------------------------------------------
+			Sets the queue lane raised events of this type go in. Set it
+			before registering the type.
+		---------------------------------------------------------------------*/
+		void				setPriority(EventPriority priority) {
+								_ASSERTE(priority < EventPriority_NumLanes);
+								mPriority = priority;
+							}
+		EventPriority		priority() const		{ return mPriority; }
+
 		// Constructor / destructor
 		explicit RegisteredEvent(const EventSource src, const EventDataType dt) :
 			mEventSource(src),
-			mEventDataType(dt)
+			mEventDataType(dt),
+			mCoalesceKeyFunc(0),
+			mReadEventFunc(0),
+			mCategory(EventCategory_General),
+			mPriority(EventPriority_Normal)
 		{}
 		virtual ~RegisteredEvent() {}
 };
\ No newline at end of file
@@ -0,0 +1,409 @@
+/*----==== EVENTBENCHMARK.CPP ====----
+	Author:		Jeff Kiah
+	Orig.Date:	10/17/2026
+	Rev.Date:	10/17/2026
+------------------------------------*/
+
+#include "EventBenchmark.h"
+
+#if EVENT_BENCHMARK
+
+#include <fstream>
+#include <algorithm>
+#include <vector>
+#include <boost/thread/thread.hpp>
+#include <boost/scoped_ptr.hpp>
+#include "EventManager.h"
+#include "RegisteredEvents.h"
+#include "EventHandler.h"
+#include "../HighPerfTimer.h"
+
+using std::ofstream;
+using std::vector;
+using boost::thread;
+using boost::scoped_ptr;
+
+///// DEFINITIONS /////
+
+#define EVENTBENCH_EVENTS			100000	// events per trigger and raise case
+#define EVENTBENCH_THREAD_EVENTS	20000	// events raised by each thread in the raiseThreadSafe cases
+#define EVENTBENCH_WARMUP			1000	// events dispatched before timing, fills the event pool
+#define EVENTBENCH_TIMEOUT_SECONDS	30.0f	// a raiseThreadSafe case gives up waiting after this long
+
+static const string			sBenchEmptyType("BENCH_EMPTY");
+static const EventTypeId	sBenchEmptyTypeId(EVENT_TYPE_ID("BENCH_EMPTY"));
+
+enum BenchKind : uchar {
+	BenchKind_Trigger = 0,		// trigger, timed per event including dispatch
+	BenchKind_Raise,			// raise only, timed per event
+	BenchKind_NotifyQueued,		// notifyQueued of the raised events, timed per event
+	BenchKind_RaiseThreadSafe	// raiseThreadSafe from worker threads until all are dispatched
+};
+
+static const char *sBenchKindNames[] = { "trigger", "raise", "notifyQueued", "raiseThreadSafe" };
+
+///// STRUCTURES /////
+
+/*=============================================================================
+class BenchDataEvent
+	A non-empty event about the size of a typical gameplay event
+=============================================================================*/
+class BenchDataEvent : public Event {
+	public:
+		static const string			sEventType;
+		static const EventTypeId	sEventTypeId;
+
+		int		id;
+		float	values[4];
+
+		virtual const string &	type() const	{ return sEventType; }
+		virtual EventTypeId		typeId() const	{ return sEventTypeId; }
+		virtual void	serialize(ostream &out) const {
+							out.write(reinterpret_cast<const char *>(&id), sizeof(id));
+							out.write(reinterpret_cast<const char *>(values), sizeof(values));
+						}
+		virtual void	deserialize(istream &in) {
+							in.read(reinterpret_cast<char *>(&id), sizeof(id));
+							in.read(reinterpret_cast<char *>(values), sizeof(values));
+						}
+
+		explicit BenchDataEvent(int _id) : Event(), id(_id) {
+			for (int v = 0; v < 4; ++v) values[v] = static_cast<float>(_id + v);
+		}
+		virtual ~BenchDataEvent() {}
+};
+
+const string BenchDataEvent::sEventType("BENCH_DATA");
+const EventTypeId BenchDataEvent::sEventTypeId(EVENT_TYPE_ID("BENCH_DATA"));
+
+/*=============================================================================
+struct BenchCase
+	One point in the benchmark matrix
+=============================================================================*/
+struct BenchCase {
+	BenchKind	kind;
+	bool		dataEvent;		// BenchDataEvent through a typed delegate, else an empty event through a handler
+	uint		numListeners;
+	uint		numWildcards;	// wildcard listeners added, on top of the manager's EventSnooper
+	bool		priorities;		// every listener has its own priority, else all are 0 (FIFO)
+	bool		consume;		// the first listener consumes the event
+	uint		numThreads;		// raising threads, raiseThreadSafe only
+};
+
+/*=============================================================================
+struct BenchResult
+=============================================================================*/
+struct BenchResult {
+	BenchCase		c;
+	uint			ops;
+	double			totalMs;
+	vector<__int64>	latency;	// raise or trigger to first handler, in timer counts, may be empty
+};
+
+/*=============================================================================
+class BenchListener
+	Counts what it handles. The first listener of a case also records the
+	latency from the event's timestamp (set when it was raised or triggered)
+	to the handler, and is the one that consumes when the case asks for it.
+	It is always called first, with the highest priority or registered first.
+=============================================================================*/
+class BenchListener : public EventListener {
+	private:
+		uint &				mCount;
+		vector<__int64> *	mLatency;	// null except for the first listener
+		bool				mConsume;
+
+		bool	handled(const Event &e) {
+					++mCount;
+					if (mLatency) mLatency->push_back(HighPerfTimer::queryCounts() - e.time());
+					return mConsume;
+				}
+		bool	handleEmpty(const EventPtr &ePtr)		{ return handled(*ePtr); }
+		bool	handleData(const BenchDataEvent &e)		{ return handled(e); }
+		bool	handleAll(const EventPtr &ePtr)			{ ++mCount; return false; }
+
+	public:
+		explicit BenchListener(const BenchCase &c, uint index, uint &count, vector<__int64> *latency) :
+			EventListener("BenchListener"),
+			mCount(count), mLatency(latency), mConsume(c.consume && latency != 0)
+		{
+			uint priority = c.priorities ? index + 1 : 0;
+			if (c.dataEvent) {
+				subscribe(this, &BenchListener::handleData, priority);
+			} else {
+				IEventHandlerPtr p(new EventHandler<BenchListener>(this, &BenchListener::handleEmpty));
+				registerEventHandler(sBenchEmptyType, p, priority);
+			}
+		}
+		/*---------------------------------------------------------------------
+			Wildcard listener constructor
+		---------------------------------------------------------------------*/
+		explicit BenchListener(uint &count) :
+			EventListener("BenchWildcard"),
+			mCount(count), mLatency(0), mConsume(false)
+		{
+			IEventHandlerPtr p(new EventHandler<BenchListener>(this, &BenchListener::handleAll));
+			registerWildcardHandler(p, EventCategory_All);
+		}
+		virtual ~BenchListener() {}
+};
+
+/*=============================================================================
+class BenchSetup
+	A fresh EventManager with the bench event types registered and the case's
+	listeners attached, torn down in reverse
+=============================================================================*/
+class BenchSetup : private boost::noncopyable {
+	private:
+		scoped_ptr<EventManager>	mEventMgr;
+		vector<BenchListener*>		mListeners;
+
+	public:
+		uint				handled;	// typed and wildcard handler calls
+		vector<__int64>		latency;
+
+		explicit BenchSetup(const BenchCase &c, uint expectedEvents) :
+			mEventMgr(new EventManager()), mListeners(), handled(0), latency()
+		{
+			events.registerEventType(sBenchEmptyType, RegEventPtr(new CodeOnlyEvent(EventDataType_Empty)));
+			events.registerEventType(BenchDataEvent::sEventType, RegEventPtr(new CodeOnlyEvent(EventDataType_NotEmpty)));
+			latency.reserve(expectedEvents + EVENTBENCH_WARMUP);
+			for (uint l = 0; l < c.numListeners; ++l) {
+				mListeners.push_back(new BenchListener(c, l, handled, (l == 0) ? &latency : 0));
+			}
+			for (uint w = 0; w < c.numWildcards; ++w) {
+				mListeners.push_back(new BenchListener(handled));
+			}
+		}
+		~BenchSetup() {
+			for (vector<BenchListener*>::reverse_iterator li = mListeners.rbegin(); li != mListeners.rend(); ++li) {
+				delete *li;
+			}
+		}
+};
+
+///// FUNCTIONS /////
+
+static inline void benchRaise(bool dataEvent, int i)
+{
+	if (dataEvent) {
+		events.raise(makeEvent<BenchDataEvent>(i));
+	} else {
+		events.raise(sBenchEmptyTypeId);
+	}
+}
+
+static inline void benchTrigger(bool dataEvent, int i)
+{
+	if (dataEvent) {
+		events.trigger(makeEvent<BenchDataEvent>(i));
+	} else {
+		events.trigger(sBenchEmptyTypeId);
+	}
+}
+
+static inline void benchRaiseThreadSafe(bool dataEvent, int i)
+{
+	if (dataEvent) {
+		events.raiseThreadSafe(makeEvent<BenchDataEvent>(i));
+	} else {
+		events.raiseThreadSafe(sBenchEmptyTypeId);
+	}
+}
+
+static inline double countsToMs(__int64 counts)
+{
+	return static_cast<double>(counts) * 1000.0 / static_cast<double>(HighPerfTimer::timerFreq());
+}
+
+/*-----------------------------------------------------------------------------
+	Times trigger of every event
+-----------------------------------------------------------------------------*/
+static void benchTriggerCase(const BenchCase &c, vector<BenchResult> &results)
+{
+	BenchSetup s(c, EVENTBENCH_EVENTS);
+	for (int i = 0; i < EVENTBENCH_WARMUP; ++i) benchTrigger(c.dataEvent, i);
+	s.latency.clear();
+
+	__int64 start = HighPerfTimer::queryCounts();
+	for (int i = 0; i < EVENTBENCH_EVENTS; ++i) benchTrigger(c.dataEvent, i);
+	__int64 end = HighPerfTimer::queryCounts();
+
+	BenchResult r = { c, EVENTBENCH_EVENTS, countsToMs(end - start), vector<__int64>() };
+	r.latency.swap(s.latency);
+	results.push_back(r);
+}
+
+/*-----------------------------------------------------------------------------
+	Times raising every event, then one notifyQueued with no time limit that
+	dispatches them all. Two results, raise and notifyQueued.
+-----------------------------------------------------------------------------*/
+static void benchRaiseCase(const BenchCase &c, vector<BenchResult> &results)
+{
+	BenchSetup s(c, EVENTBENCH_EVENTS);
+	for (int i = 0; i < EVENTBENCH_WARMUP; ++i) benchRaise(c.dataEvent, i);
+	events.notifyQueued(0);
+	s.latency.clear();
+
+	__int64 start = HighPerfTimer::queryCounts();
+	for (int i = 0; i < EVENTBENCH_EVENTS; ++i) benchRaise(c.dataEvent, i);
+	__int64 raised = HighPerfTimer::queryCounts();
+	events.notifyQueued(0);
+	__int64 end = HighPerfTimer::queryCounts();
+
+	BenchCase rc = c;
+	rc.kind = BenchKind_Raise;
+	BenchResult r = { rc, EVENTBENCH_EVENTS, countsToMs(raised - start), vector<__int64>() };
+	results.push_back(r);
+
+	BenchCase nc = c;
+	nc.kind = BenchKind_NotifyQueued;
+	BenchResult n = { nc, EVENTBENCH_EVENTS, countsToMs(end - raised), vector<__int64>() };
+	n.latency.swap(s.latency);
+	results.push_back(n);
+}
+
+/*-----------------------------------------------------------------------------
+	Worker for the raiseThreadSafe case, raises its share of events as fast
+	as the lanes let it
+-----------------------------------------------------------------------------*/
+static void benchRaiseThread(bool dataEvent, volatile LONG *go)
+{
+	while (*go == 0) Sleep(0);
+	for (int i = 0; i < EVENTBENCH_THREAD_EVENTS; ++i) benchRaiseThreadSafe(dataEvent, i);
+}
+
+/*-----------------------------------------------------------------------------
+	Starts the raising threads together and runs notifyQueued frames on this
+	thread until every event has been dispatched. Times from the start to the
+	last dispatch, so it includes lane back pressure and the drain budget.
+-----------------------------------------------------------------------------*/
+static void benchThreadCase(const BenchCase &c, vector<BenchResult> &results)
+{
+	uint total = c.numThreads * EVENTBENCH_THREAD_EVENTS;
+	BenchSetup s(c, total);
+	uint expected = total * (c.consume ? 1 : c.numListeners) + total * c.numWildcards;
+
+	volatile LONG go = 0;
+	vector<thread*> threads;
+	for (uint t = 0; t < c.numThreads; ++t) {
+		threads.push_back(new thread(&benchRaiseThread, c.dataEvent, &go));
+	}
+	__int64 start = HighPerfTimer::queryCounts();
+	InterlockedExchange(&go, 1);
+	while (s.handled < expected) {
+		events.notifyQueued(0);
+		if (HighPerfTimer::secondsSince(start) > EVENTBENCH_TIMEOUT_SECONDS) {
+			debugPrintf("EventBenchmark: raiseThreadSafe case timed out, %u of %u handled\n", s.handled, expected);
+			break;
+		}
+	}
+	__int64 end = HighPerfTimer::queryCounts();
+	for (vector<thread*>::const_iterator ti = threads.begin(); ti != threads.end(); ++ti) {
+		(*ti)->join();
+		delete *ti;
+	}
+
+	BenchResult r = { c, total, countsToMs(end - start), vector<__int64>() };
+	r.latency.swap(s.latency);
+	results.push_back(r);
+}
+
+/*-----------------------------------------------------------------------------
+	Writes percentile of sorted latency samples in nanoseconds
+-----------------------------------------------------------------------------*/
+static double latencyNs(const vector<__int64> &sorted, double percentile)
+{
+	size_t i = static_cast<size_t>(percentile * static_cast<double>(sorted.size() - 1));
+	return countsToMs(sorted[i]) * 1000000.0;
+}
+
+static void writeResult(ofstream &out, BenchResult &r)
+{
+	const BenchCase &c = r.c;
+	out << "    {\"benchmark\": \"" << sBenchKindNames[c.kind] << "\""
+		<< ", \"event\": \"" << (c.dataEvent ? "data" : "empty") << "\""
+		<< ", \"listeners\": " << c.numListeners
+		<< ", \"wildcards\": " << c.numWildcards
+		<< ", \"priorities\": " << (c.priorities ? "true" : "false")
+		<< ", \"consume\": " << (c.consume ? "true" : "false")
+		<< ", \"threads\": " << c.numThreads
+		<< ", \"ops\": " << r.ops
+		<< ", \"totalMs\": " << r.totalMs
+		<< ", \"nsPerOp\": " << (r.ops ? r.totalMs * 1000000.0 / r.ops : 0.0)
+		<< ", \"opsPerSec\": " << (r.totalMs > 0 ? r.ops * 1000.0 / r.totalMs : 0.0);
+	if (!r.latency.empty()) {
+		std::sort(r.latency.begin(), r.latency.end());
+		out << ", \"latencyNs\": {\"p50\": " << latencyNs(r.latency, 0.5)
+			<< ", \"p90\": " << latencyNs(r.latency, 0.9)
+			<< ", \"p99\": " << latencyNs(r.latency, 0.99)
+			<< ", \"max\": " << latencyNs(r.latency, 1.0) << "}";
+	}
+	out << "}";
+}
+
+/*-----------------------------------------------------------------------------
+	Runs the benchmark matrix and writes the results to a JSON file
+-----------------------------------------------------------------------------*/
+bool runEventBenchmarks(const string &filename)
+{
+	_ASSERTE(HighPerfTimer::initialized());
+	ofstream out(filename.c_str(), std::ios::out | std::ios::trunc);
+	if (!out) {
+		debugPrintf("EventBenchmark: cannot write \"%s\"\n", filename.c_str());
+		return false;
+	}
+
+	// the dispatch matrix, run for trigger and for raise/notifyQueued
+	vector<BenchCase> cases;
+	static const uint sListenerCounts[] = { 1, 8, 64 };
+	for (int d = 0; d < 2; ++d) {
+		for (int l = 0; l < 3; ++l) {
+			BenchCase c = { BenchKind_Trigger, d != 0, sListenerCounts[l], 0, false, false, 0 };
+			cases.push_back(c);
+		}
+		BenchCase wildcards = { BenchKind_Trigger, d != 0, 8, 4, false, false, 0 };
+		BenchCase priorities = { BenchKind_Trigger, d != 0, 8, 0, true, false, 0 };
+		BenchCase consume = { BenchKind_Trigger, d != 0, 8, 0, true, true, 0 };
+		cases.push_back(wildcards);
+		cases.push_back(priorities);
+		cases.push_back(consume);
+	}
+
+	vector<BenchResult> results;
+	vector<BenchCase>::const_iterator ci, end = cases.end();
+	for (ci = cases.begin(); ci != end; ++ci) {
+		benchTriggerCase(*ci, results);
+		benchRaiseCase(*ci, results);
+	}
+	static const uint sThreadCounts[] = { 1, 2, 4, 8 };
+	for (int d = 0; d < 2; ++d) {
+		for (int t = 0; t < 4; ++t) {
+			BenchCase c = { BenchKind_RaiseThreadSafe, d != 0, 1, 0, false, false, sThreadCounts[t] };
+			benchThreadCase(c, results);
+		}
+	}
+
+	out << "{\n  \"timerFreq\": " << HighPerfTimer::timerFreq()
+		<< ",\n  \"eventProfiler\": " << (EVENT_PROFILER ? "true" : "false")
+		#ifdef DEBUG_CONSOLE
+		<< ",\n  \"debugConsole\": true"
+		#else
+		<< ",\n  \"debugConsole\": false"
+		#endif
+		#ifdef _DEBUG
+		<< ",\n  \"debugBuild\": true"
+		#else
+		<< ",\n  \"debugBuild\": false"
+		#endif
+		<< ",\n  \"results\": [\n";
+	for (size_t r = 0; r < results.size(); ++r) {
+		writeResult(out, results[r]);
+		out << (r + 1 < results.size() ? ",\n" : "\n");
+	}
+	out << "  ]\n}\n";
+	debugPrintf("EventBenchmark: %u results written to \"%s\"\n", results.size(), filename.c_str());
+	return out.good();
+}
+
+#endif
@@ -0,0 +1,40 @@
+/*----==== EVENTBENCHMARK.H ====----
+	Author:		Jeff Kiah
+	Orig.Date:	10/17/2026
+	Rev.Date:	10/17/2026
+----------------------------------*/
+
+#pragma once
+
+///// DEFINITIONS /////
+
+// Set EVENT_BENCHMARK to 1 in the project settings to build in the event system micro-benchmarks.
+// They are run from WinMain in place of the engine when the command line has -eventbench, and
+// write their results to EVENTBENCH_DEFAULT_FILE (or -eventbench=file.json). Build Release without
+// DEBUG_CONSOLE for meaningful numbers, debugPrintf in the dispatch path dominates otherwise.
+#ifndef EVENT_BENCHMARK
+#define EVENT_BENCHMARK	0
+#endif
+
+#if EVENT_BENCHMARK
+
+#include <string>
+
+using std::string;
+
+#define EVENTBENCH_SWITCH			"-eventbench"
+#define EVENTBENCH_DEFAULT_FILE		"eventbench.json"
+
+///// FUNCTIONS /////
+
+/*-----------------------------------------------------------------------------
+	Measures trigger, raise, notifyQueued and raiseThreadSafe throughput and
+	latency for empty and non-empty events, over listener counts, wildcard
+	listeners, priorities, consumption and raising thread counts, and writes
+	the results to a JSON file. Each case runs on its own EventManager, so
+	call this before the engine creates one. HighPerfTimer must be
+	initialized. Returns false if the file can't be written.
+-----------------------------------------------------------------------------*/
+bool runEventBenchmarks(const string &filename);
+
+#endif
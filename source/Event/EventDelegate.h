@@ -0,0 +1,100 @@
+/*----==== EVENTDELEGATE.H ====----
+	Author:		Jeff Kiah
+	Orig.Date:	10/17/2026
+	Rev.Date:	10/17/2026
+---------------------------------*/
+
+#pragma once
+
+#include <cstring>
+#include "Event.h"
+
+///// DEFINITIONS /////
+
+#define EVENTDELEGATE_METHOD_SIZE	16	// large enough for any MSVC pointer to member function
+
+///// STRUCTURES /////
+
+/*=============================================================================
+class EventDelegate
+	A typed event handler stored by value, small enough to sit in the
+	listener arrays of the dispatch table. It holds the object pointer, the
+	member (or free) function pointer in an inline buffer, and a thunk that is
+	instantiated for the concrete event and listener types. Calling it is one
+	indirect call to the thunk, which restores the method pointer and calls it
+	with the event cast to its concrete type, so handlers take const E &
+	instead of const EventPtr & and don't need a static_cast. No allocation,
+	no virtual call, no map lookup.
+	**NOTE**
+	The cast is unchecked, like the static_cast in a classic handler, so the
+	delegate must only be registered for E's own event type. The subscribe
+	functions in EventListener guarantee that by using E::sEventTypeId.
+=============================================================================*/
+class EventDelegate {
+	private:
+		///// DEFINITIONS /////
+		typedef bool (*Thunk)(const EventDelegate &d, const Event &e);
+
+		///// VARIABLES /////
+		void *	mObject;
+		Thunk	mThunk;
+		char	mMethod[EVENTDELEGATE_METHOD_SIZE];
+
+		///// FUNCTIONS /////
+		template <typename E, typename X>
+		static bool	methodThunk(const EventDelegate &d, const Event &e) {
+						typedef bool (X::*Method)(const E &);
+						Method m;
+						memcpy(&m, d.mMethod, sizeof(Method));
+						return (static_cast<X *>(d.mObject)->*m)(static_cast<const E &>(e));
+					}
+
+		template <typename E>
+		static bool	functionThunk(const EventDelegate &d, const Event &e) {
+						typedef bool (*Function)(const E &);
+						Function f;
+						memcpy(&f, d.mMethod, sizeof(Function));
+						return (*f)(static_cast<const E &>(e));
+					}
+
+	public:
+		/*---------------------------------------------------------------------
+			Binds a member function bool X::method(const E &)
+		---------------------------------------------------------------------*/
+		template <typename E, typename X>
+		static EventDelegate	fromMethod(X *obj, bool (X::*method)(const E &)) {
+									typedef bool (X::*Method)(const E &);
+									static_assert(sizeof(Method) <= EVENTDELEGATE_METHOD_SIZE,
+												  "Member function pointer too large for EventDelegate");
+									_ASSERTE(obj && method);
+									EventDelegate d;
+									d.mObject = obj;
+									d.mThunk = &methodThunk<E, X>;
+									memcpy(d.mMethod, &method, sizeof(Method));
+									return d;
+								}
+
+		/*---------------------------------------------------------------------
+			Binds a free or static function bool function(const E &)
+		---------------------------------------------------------------------*/
+		template <typename E>
+		static EventDelegate	fromFunction(bool (*function)(const E &)) {
+									_ASSERTE(function);
+									EventDelegate d;
+									d.mThunk = &functionThunk<E>;
+									memcpy(d.mMethod, &function, sizeof(function));
+									return d;
+								}
+
+		bool	isBound() const { return (mThunk != 0); }
+
+		/*---------------------------------------------------------------------
+			Calls the handler, returns true if the event was consumed
+		---------------------------------------------------------------------*/
+		bool	operator()(const Event &e) const { return mThunk(*this, e); }
+
+		// Constructor, unbound
+		EventDelegate() : mObject(0), mThunk(0) {
+			memset(mMethod, 0, sizeof(mMethod));
+		}
+};
@@ -0,0 +1,233 @@
+/*----==== EVENTFUTURE.H ====----
+	Author:		Jeff Kiah
+	Orig.Date:	10/17/2026
+	Rev.Date:	10/17/2026
+-------------------------------*/
+
+#pragma once
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN	// defined in project settings
+#endif
+
+#include <Windows.h>
+#include <memory>
+#include <boost/noncopyable.hpp>
+#include <boost/function.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include "Event.h"
+
+using std::shared_ptr;
+using boost::mutex;
+using boost::condition_variable;
+
+///// DEFINITIONS /////
+
+enum EventFutureStatus : LONG {
+	EventFuture_Pending = 0,
+	EventFuture_Ready,
+	EventFuture_Failed		// nobody answered: the handler failed it, or the request was dropped or never handled
+};
+
+#define EVENTFUTURE_WAIT_FOREVER	0xFFFFFFFF
+
+template <typename T> class EventPromise;
+
+///// STRUCTURES /////
+
+/*=============================================================================
+class EventFutureState
+	Shared by an EventPromise and its EventFutures. The status is set with an
+	interlocked exchange after the value is written, so a thread that polls
+	and sees Ready can read the value without the lock. The lock is only for
+	waiting and for the continuation.
+=============================================================================*/
+template <typename T>
+class EventFutureState : private boost::noncopyable {
+	public:
+		///// DEFINITIONS /////
+		typedef boost::function<void (bool succeeded, const T &value)>	Continuation;
+
+		///// VARIABLES /////
+		volatile LONG		status;
+		T					value;
+		mutex				waitMutex;
+		condition_variable	waitCondVar;
+		Continuation		continuation;	// run once, by whichever of complete and then comes last
+
+		///// FUNCTIONS /////
+		/*---------------------------------------------------------------------
+			Sets the result once, wakes waiters and runs the continuation on
+			the calling thread. Returns false if it was already complete.
+		---------------------------------------------------------------------*/
+		bool	complete(const T *result) {
+					Continuation c;
+					{
+						mutex::scoped_lock lock(waitMutex);
+						if (status != EventFuture_Pending) return false;
+						if (result) value = *result;
+						InterlockedExchange(&status, result ? EventFuture_Ready : EventFuture_Failed);
+						c.swap(continuation);
+					}
+					waitCondVar.notify_all();
+					if (c) c(status == EventFuture_Ready, value);
+					return true;
+				}
+
+		explicit EventFutureState() : status(EventFuture_Pending), value() {}
+};
+
+/*=============================================================================
+class EventFuture
+	The receiving end of a request/response event. A worker thread raises a
+	RequestEvent with raiseThreadSafe, keeps its future, and carries on. The
+	main thread services the request in notifyQueued and responds, and the
+	worker picks up the result whenever it suits it: poll with isReady or
+	tryGet, block with wait, or register a continuation with then. Neither
+	side blocks unless the worker asks to wait.
+	Futures are cheap to copy, they share the state with the promise.
+=============================================================================*/
+template <typename T>
+class EventFuture {
+	friend class EventPromise<T>;
+	public:
+		///// DEFINITIONS /////
+		typedef typename EventFutureState<T>::Continuation	Continuation;
+
+	private:
+		///// VARIABLES /////
+		shared_ptr<EventFutureState<T>>	mState;
+
+		explicit EventFuture(const shared_ptr<EventFutureState<T>> &state) : mState(state) {}
+
+	public:
+		bool				valid() const		{ return (mState.get() != 0); }
+		EventFutureStatus	status() const		{ return static_cast<EventFutureStatus>(mState->status); }
+		/*---------------------------------------------------------------------
+			True once the request was answered or failed, never blocks
+		---------------------------------------------------------------------*/
+		bool				isReady() const		{ return (mState->status != EventFuture_Pending); }
+		bool				succeeded() const	{ return (mState->status == EventFuture_Ready); }
+
+		/*---------------------------------------------------------------------
+			Copies the result if it has arrived, never blocks. Returns false
+			while pending, or if the request failed.
+		---------------------------------------------------------------------*/
+		bool	tryGet(T &outValue) const {
+					if (mState->status != EventFuture_Ready) return false;
+					outValue = mState->value;
+					return true;
+				}
+
+		/*---------------------------------------------------------------------
+			Returns the result, only valid once succeeded() is true
+		---------------------------------------------------------------------*/
+		const T &	get() const { _ASSERTE(succeeded()); return mState->value; }
+
+		/*---------------------------------------------------------------------
+			Blocks until the request completes or the timeout passes, returns
+			isReady(). Don't call this from the main thread for a request the
+			main thread services, it would wait for itself.
+		---------------------------------------------------------------------*/
+		bool	wait(ulong timeoutMillis = EVENTFUTURE_WAIT_FOREVER) const {
+					if (isReady()) return true;
+					mutex::scoped_lock lock(mState->waitMutex);
+					if (timeoutMillis == EVENTFUTURE_WAIT_FOREVER) {
+						while (!isReady()) mState->waitCondVar.wait(lock);
+					} else {
+						boost::system_time timeout = boost::get_system_time() +
+													 boost::posix_time::milliseconds(timeoutMillis);
+						while (!isReady()) {
+							if (!mState->waitCondVar.timed_wait(lock, timeout)) break;
+						}
+					}
+					return isReady();
+				}
+
+		/*---------------------------------------------------------------------
+			Calls func(succeeded, value) when the request completes, on the
+			thread that completes it (for requests serviced in notifyQueued,
+			the main thread), or right away on this thread if it already has.
+			Only one continuation, a second call replaces the first.
+		---------------------------------------------------------------------*/
+		void	then(const Continuation &func) {
+					{
+						mutex::scoped_lock lock(mState->waitMutex);
+						if (!isReady()) {
+							mState->continuation = func;
+							return;
+						}
+					}
+					func(succeeded(), mState->value);
+				}
+
+		// Constructor
+		explicit EventFuture() : mState() {}
+};
+
+/*=============================================================================
+class EventPromise
+	The answering end of a request/response event. Completing it is safe
+	from any thread. If the promise is destroyed without an answer, which is
+	what happens when the request event is dropped from a full queue or
+	nobody handles it, the future fails instead of waiting forever.
+=============================================================================*/
+template <typename T>
+class EventPromise : private boost::noncopyable {
+	private:
+		///// VARIABLES /////
+		shared_ptr<EventFutureState<T>>	mState;
+
+	public:
+		EventFuture<T>	future() const { return EventFuture<T>(mState); }
+
+		/*---------------------------------------------------------------------
+			Sets the result, returns false if already completed. Const so
+			that handlers taking a const event can answer it.
+		---------------------------------------------------------------------*/
+		bool	setValue(const T &value) const	{ return mState->complete(&value); }
+		bool	setFailed() const				{ return mState->complete(0); }
+
+		// Constructor / destructor
+		explicit EventPromise() : mState(std::make_shared<EventFutureState<T>>()) {}
+		~EventPromise() { setFailed(); } // does nothing if already answered
+};
+
+/*=============================================================================
+class RequestEvent
+	Base for events that ask a question of whoever handles them and expect
+	an answer of type TResult. Derive the request type from it, raise it
+	(typically with raiseThreadSafe from a worker) and keep the future:
+		shared_ptr<MyRequest> req(new MyRequest(...));
+		EventFuture<Answer> answer = req->future();
+		events.raiseThreadSafe(req);
+		...
+		if (answer.isReady()) { ... }
+	The handler calls respond (or fail) on the event. A request that is never
+	answered fails when the event is destroyed.
+=============================================================================*/
+template <typename TResult>
+class RequestEvent : public Event {
+	private:
+		EventPromise<TResult>	mPromise;
+
+	public:
+		///// DEFINITIONS /////
+		typedef TResult					ResultType;
+		typedef EventFuture<TResult>	Future;
+
+		///// FUNCTIONS /////
+		Future	future() const { return mPromise.future(); }
+
+		/*---------------------------------------------------------------------
+			Answers the request, returns false if it was already answered
+		---------------------------------------------------------------------*/
+		bool	respond(const TResult &result) const	{ return mPromise.setValue(result); }
+		bool	fail() const							{ return mPromise.setFailed(); }
+
+		// Constructor / destructor
+		explicit RequestEvent() : Event(), mPromise() {}
+		virtual ~RequestEvent() {}
+};
@@ -1,15 +1,15 @@
 /*----==== EVENTHANDLER.H ====----
 	Author:		Jeffrey Kiah
 	Orig.Date:	07/28/2007
-	Rev.Date:	05/04/2009
+	Rev.Date:	10/17/2026
 --------------------------------*/
 
 #pragma once
 
 #include "Event.h"
-#include "../Utility/ConcurrentQueue.h"
+#include "BoundedEventQueue.h"
 
-typedef ConcurrentQueue<EventPtr>	ThreadSafeEventQueue;
+typedef BoundedEventQueue	ThreadSafeEventQueue;
 
 /*=============================================================================
 class IEventHandler
@@ -73,9 +73,12 @@ class ThreadEventHandler
 	This class can be used to handle events in worker threads. It is made
 	thread safe by queueing events in a thread safe queue as they are sent to
 	the handler, instead of calling a functor to handle them. The handler
-	should be created in the main thread, because registration with the manager
-	is not thread safe. The thread process can waitPop() items from the queue
-	to handle them.
+	can be registered from the worker thread itself, registration with the
+	manager is thread safe. The thread process can waitPop() items from the queue
+	to handle them. The queue is lock-free single consumer, so only one thread
+	should pop from a given handler. It is unbounded by default, a capacity
+	and overflow policy can be given (see BoundedEventQueue), but since the
+	main thread is the producer here, Block will stall the frame when full.
 =============================================================================*/
 class ThreadEventHandler : public IEventHandler {
 	public:
@@ -86,5 +89,7 @@ class ThreadEventHandler : public IEventHandler {
 			return false; // allow the event to propagate
 		}
 
-		explicit ThreadEventHandler() {}
+		explicit ThreadEventHandler(uint capacity = 0, EventOverflowPolicy policy = EventOverflow_DropOldest) :
+			mEventQueue(capacity, policy)
+		{}
 };
\ No newline at end of file
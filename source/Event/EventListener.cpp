@@ -1,15 +1,17 @@
 /*----==== EVENTLISTENER.CPP ====----
 	Author:		Jeffrey Kiah
 	Orig.Date:	07/28/2007
-	Rev.Date:	05/04/2009
+	Rev.Date:	10/17/2026
 -----------------------------------*/
 
 #include "EventListener.h"
 #include "EventManager.h"
+#include <cstdlib>
 
 ////////// class EventListener //////////
 
 const string EventListener::sWildcardType("*"); // defines the wildcard event type string for listeners
+const EventTypeId EventListener::sWildcardTypeId(EVENT_TYPE_ID("*"));
 
 /*-----------------------------------------------------------------------------
 	Inserts a handler functor for an event type, adding it to the
@@ -17,9 +19,10 @@ const string EventListener::sWildcardType("*"); // defines the wildcard event ty
 -----------------------------------------------------------------------------*/
 bool EventListener::insertEventHandler(const string &eventType, const IEventHandlerPtr &handler)
 {
-	EventHandlerMap::const_iterator ei = mHandlerMap.find(eventType);
-	if (ei == mHandlerMap.end()) { // event type handler does not exist yet
-		EventHandlerMapResult r = mHandlerMap.insert(EventHandlerMapValue(eventType, handler));
+	EventTypeId eventTypeId = hashEventType(eventType);
+	if (mTypeNames.find(eventTypeId) == mTypeNames.end()) { // event type handler does not exist yet
+		EventHandlerMapResult r = mHandlerMap.insert(EventHandlerMapValue(eventTypeId, handler));
+		mTypeNames[eventTypeId] = eventType;
 		debugPrintf("%s: handler created for event type \"%s\"\n", mName.c_str(), eventType.c_str());
 		_ASSERTE(r.second == true);
 	} else { // event type handler already exists
@@ -36,12 +39,14 @@ bool EventListener::insertEventHandler(const string &eventType, const IEventHand
 bool EventListener::removeEventHandler(const string &eventType)
 {
 	// check for event type in the map
-	EventHandlerMap::iterator ei = mHandlerMap.find(eventType);
+	EventTypeId eventTypeId = hashEventType(eventType);
+	EventHandlerMap::iterator ei = mHandlerMap.find(eventTypeId);
 	if (ei == mHandlerMap.end()) {
 		debugPrintf("%s: handler not found for event type \"%s\", not removed\n", mName.c_str(), eventType.c_str());
 		return false;
 	}
 	mHandlerMap.erase(ei);
+	mTypeNames.erase(eventTypeId);
 	debugPrintf("%s: handler for event type \"%s\" removed\n", mName.c_str(), eventType.c_str());
 	return true;
 }
@@ -52,10 +57,40 @@ bool EventListener::removeEventHandler(const string &eventType)
 -----------------------------------------------------------------------------*/
 bool EventListener::registerEventHandler(const string &eventType, const IEventHandlerPtr &handler, uint priority)
 {
+	// refused from a concurrent batch, leave the handler map as it is
+	if (EventManager::inConcurrentBatch()) {
+		_ASSERTE(false && "handlers can't be registered from a concurrent handler");
+		return false;
+	}
 	// perform the insert, and if it fails, exit early
 	if (!insertEventHandler(eventType, handler)) return false;
 	// if the insert succeeds, register the handler with EventManager
-	eventMgr.registerListener(eventType, this, priority); // register listener with manager
+	if (eventType == sWildcardType) {
+		// wildcard handlers go through handle, so type-specific handlers still take precedence
+		eventMgr.registerListener(eventType, this, priority);
+	} else {
+		// the handler also goes in the listener's slot, so dispatch calls it without the map lookup
+		eventMgr.registerListener(eventType, this, priority, EventDelegate(), handler); // register listener with manager
+	}
+	return true;
+}
+
+/*-----------------------------------------------------------------------------
+	Registers a wildcard handler that is only called for events in the given
+	categories. The filtering is done by EventManager's dispatch lists, the
+	handler is never called for other events.
+-----------------------------------------------------------------------------*/
+bool EventListener::registerWildcardHandler(const IEventHandlerPtr &handler, EventCategoryMask categories,
+											uint priority)
+{
+	_ASSERTE(categories != EventCategory_None);
+	// refused from a concurrent batch, leave the handler map as it is
+	if (EventManager::inConcurrentBatch()) {
+		_ASSERTE(false && "handlers can't be registered from a concurrent handler");
+		return false;
+	}
+	if (!insertEventHandler(sWildcardType, handler)) return false;
+	eventMgr.registerListener(sWildcardType, this, priority, EventDelegate(), IEventHandlerPtr(), categories);
 	return true;
 }
 
@@ -65,6 +100,11 @@ bool EventListener::registerEventHandler(const string &eventType, const IEventHa
 -----------------------------------------------------------------------------*/
 bool EventListener::unregisterEventHandler(const string &eventType)
 {
+	// refused from a concurrent batch, leave the handler map as it is
+	if (EventManager::inConcurrentBatch()) {
+		_ASSERTE(false && "handlers can't be unregistered from a concurrent handler");
+		return false;
+	}
 	// remove the handler, if the removal fails exit early
 	if (!removeEventHandler(eventType)) return false;
 	// if removal from map succeeds, unregister with EventManager
@@ -72,22 +112,67 @@ bool EventListener::unregisterEventHandler(const string &eventType)
 	return true;
 }
 
+/*-----------------------------------------------------------------------------
+	Registers the listener with EventManager for the event type with a typed
+	delegate. Returns false if the listener already handles the type. Called
+	by subscribe.
+-----------------------------------------------------------------------------*/
+bool EventListener::subscribeDelegate(const string &eventType, const EventDelegate &delegate, uint priority)
+{
+	EventTypeId eventTypeId = hashEventType(eventType);
+	if (mTypeNames.find(eventTypeId) != mTypeNames.end()) {
+		debugPrintf("%s: handler for event type \"%s\" already exists, not subscribed\n", mName.c_str(), eventType.c_str());
+		return false;
+	}
+	if (!eventMgr.registerListener(eventType, this, priority, delegate)) return false;
+	mTypeNames[eventTypeId] = eventType;
+	return true;
+}
+
+/*-----------------------------------------------------------------------------
+	Removes a typed subscription, returns true if removal succeeds. Called by
+	unsubscribe.
+-----------------------------------------------------------------------------*/
+bool EventListener::unsubscribeType(const string &eventType)
+{
+	// refused from a concurrent batch, leave the handler map as it is
+	if (EventManager::inConcurrentBatch()) {
+		_ASSERTE(false && "handlers can't be unregistered from a concurrent handler");
+		return false;
+	}
+	EventTypeId eventTypeId = hashEventType(eventType);
+	if (mHandlerMap.find(eventTypeId) != mHandlerMap.end() ||
+		mTypeNames.erase(eventTypeId) == 0)
+	{
+		debugPrintf("%s: no subscription for event type \"%s\", not removed\n", mName.c_str(), eventType.c_str());
+		return false;
+	}
+	eventMgr.removeListener(eventType, this);
+	return true;
+}
+
 /*-----------------------------------------------------------------------------
 	Cleanup for when listener is destroyed or being reset. Unregisters all
-	remaining handlers in the map. If the derived listener hasn't explicitly
-	unregistered them, this will catch it.
+	remaining handlers and typed subscriptions. If the derived listener hasn't
+	explicitly unregistered them, this will catch it. A listener can't be
+	destroyed or reset from a concurrent batch: its removal would only happen
+	after the batches join, and other threads, or its own batch, could call
+	it after it is freed. That is a fatal error in every build.
 -----------------------------------------------------------------------------*/
 void EventListener::clearHandlers()
 {
-	// this loop unregisters all remaining handlers
-	EventHandlerMap::const_iterator ei = mHandlerMap.begin(),
-									end = mHandlerMap.end();
-	while (ei != end) {
-		const string key(ei->first);
-		++ei;
-		unregisterEventHandler(key);
+	if (EventManager::inConcurrentBatch()) {
+		debugPrintf("%s: listener destroyed or reset from a concurrent batch, aborting\n", mName.c_str());
+		_ASSERTE(false && "listeners can't be destroyed or reset from a concurrent handler");
+		std::abort();
+	}
+	// this loop unregisters all remaining handlers and subscriptions
+	EventTypeNameMap::const_iterator ni, end = mTypeNames.end();
+	for (ni = mTypeNames.begin(); ni != end; ++ni) {
+		eventMgr.removeListener(ni->second, this);
 	}
 	mHandlerMap.clear();
+	mTypeNames.clear();
 }
 
 /*-----------------------------------------------------------------------------
@@ -99,11 +184,11 @@ void EventListener::clearHandlers()
 bool EventListener::handle(const EventPtr &ePtr)
 {
 	// handle specific event type registrations
-	EventHandlerMap::const_iterator ei = mHandlerMap.find((*ePtr).type());
+	EventHandlerMap::const_iterator ei = mHandlerMap.find((*ePtr).typeId());
 	if (ei == mHandlerMap.end()) {
 		// if a specific event handler is not found for this type, check for any wildcard handlers
 		// so in this case, specific handlers in a listener will override the wildcard for any event type
-		ei = mHandlerMap.find(EventListener::sWildcardType);
+		ei = mHandlerMap.find(EventListener::sWildcardTypeId);
 		if (ei != mHandlerMap.end()) {
 			(*ei->second)(ePtr); // ignore return value for wildcard event handlers
 			return false;
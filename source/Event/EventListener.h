@@ -1,20 +1,25 @@
 /*----==== EVENTLISTENER.H ====----
 	Author:		Jeffrey Kiah
 	Orig.Date:	07/28/2007
-	Rev.Date	05/04/2009
+	Rev.Date	10/17/2026
 ---------------------------------*/
 
 #pragma once;
 
 #include <hash_map>
 #include <string>
+#include <vector>
 #include <memory>
 #include "EventHandler.h"
+#include "EventTypeId.h"
+#include "EventDelegate.h"
+#include "EventProfiler.h"
 
 using stdext::hash_map;
 using std::string;
 using std::pair;
 using std::shared_ptr;
+using std::vector;
 
 /*=============================================================================
 class EventListener
@@ -22,7 +27,7 @@ class EventListener
 	its registered event types. A single listener can be used to handle many
 	different event types, and each type can have only one handler function
 	registered in the listener class. Handlers are stored as functors to
-	member, static, or free functions.
+	member, static, or free functions, keyed by EventTypeId.
 	**Wildcard Handlers**
 	A listener may register a wildcard handler to receive all event types to a
 	single generic function. Specific handlers can be defined in this case to
@@ -30,23 +35,87 @@ class EventListener
 	picked up by the generic handler. To override, use the insertEventHandler
 	and removeEventHandler functions in the constructor/destructor instead of
 	registerEventHandler and unregisterEventHandler.
+	**Typed Subscriptions**
+	For code-defined events, subscribe<E>(this, &MyListener::onE) registers
+	a member function taking const E & directly. The handler is stored as an
+	EventDelegate in EventManager's listener array, so it is called without
+	going through handle, the handler map or a heap-allocated functor, and
+	without a static_cast in the handler. Typed subscriptions and functor
+	handlers can be mixed in one listener, but not for the same event type.
+	Subscriptions are removed with unsubscribe<E>, or by clearHandlers.
+	**Concurrent Listeners**
+	A listener constructed with concurrent = true declares that its handlers
+	only read event data and don't care what order they run in relative to
+	other listeners. For queued events, EventManager collects the events that
+	reach a concurrent listener in its place in the priority order and hands
+	the whole batch to a worker thread at the end of notifyQueued. The
+	listener's own events are still handled in queue order, and a listener is
+	never called on two threads at once, but different listeners run in
+	parallel. Because of that, a concurrent listener can't consume events (its
+	return value is ignored) and must not touch non-thread-safe engine state
+	from its handlers. Registering or unregistering handlers of any listener
+	from inside a batch is refused, and asserts in debug builds. Destroying
+	or resetting a listener there aborts in every build, see clearHandlers.
+	Triggered events are still handled immediately on the calling thread.
+	**Threads**
+	Registering and unregistering is safe from any thread, EventManager
+	publishes a new copy of the type's listener list and dispatch never
+	locks. A listener's own handler map isn't locked though, so one listener
+	should only be registered and unregistered from one thread at a time. A
+	listener unregistered off the main thread is not called again once
+	unregisterEventHandler returns, so it is then safe to destroy.
 =============================================================================*/
 class EventListener {
+	friend class EventManager;	// EventManager fills in the concurrent batch
+
 	public:
 		///// DEFINITIONS /////
 		typedef shared_ptr<IEventHandler>				IEventHandlerPtr;
-		typedef pair<string, IEventHandlerPtr>			EventHandlerMapValue;
-		typedef hash_map<string, IEventHandlerPtr>		EventHandlerMap;
+		typedef pair<EventTypeId, IEventHandlerPtr>		EventHandlerMapValue;
+		typedef hash_map<EventTypeId, IEventHandlerPtr>	EventHandlerMap;
 		typedef pair<EventHandlerMap::iterator, bool>	EventHandlerMapResult;
+		typedef hash_map<EventTypeId, string>			EventTypeNameMap;
+
+		/*---------------------------------------------------------------------
+			An event waiting in a concurrent listener's batch, with the
+			delegate or handler to call for it, taken from the listener's slot
+		---------------------------------------------------------------------*/
+		struct ConcurrentBatchItem {
+			EventPtr			ePtr;
+			EventDelegate		delegate;
+			IEventHandlerPtr	handler;
+			explicit ConcurrentBatchItem(const EventPtr &_ePtr, const EventDelegate &_delegate,
+										 const IEventHandlerPtr &_handler) :
+				ePtr(_ePtr), delegate(_delegate), handler(_handler)
+			{}
+		};
+		typedef vector<ConcurrentBatchItem>				ConcurrentBatch;
 
-		static const string	sWildcardType;	// stores the wildcard event type string
+		static const string			sWildcardType;		// stores the wildcard event type string
+		static const EventTypeId	sWildcardTypeId;	// and its interned id
 		
 	protected:
 		///// VARIABLES /////
 		string				mName;			// name of the listener, mostly for debugging
 		EventHandlerMap		mHandlerMap;	// map of functors, one for each event type that is listened for
 											// the listener registers event types and functors with itself which
-		///// FUNCTIONS /////				// also registers the listener with the event manager for that event type
+											// also registers the listener with the event manager for that event type
+		EventTypeNameMap	mTypeNames;		// type names of every registered type (handlers in mHandlerMap and
+											// typed subscriptions), needed to unregister
+		const bool			mConcurrent;	// handlers are thread-safe and order-independent, see above
+
+	private:
+		ConcurrentBatch		mConcurrentBatch;	// queued events waiting to be handled on a worker this frame
+		#if EVENT_PROFILER
+		LatencyHistogram	mLatency;			// time spent in handle, recorded by EventManager
+		uint64				mBatchStart;		// timing of the last concurrent batch, for the trace
+		uint64				mBatchEnd;
+		DWORD				mBatchThreadId;
+		#endif
+
+	protected:
+
+		///// FUNCTIONS /////
 
 		/*---------------------------------------------------------------------
 			Inserts a handler functor for an event type, adding it to the
@@ -74,16 +143,59 @@ class EventListener {
 					return registerEventHandler(eventType, handler, 0);
 				}
 
+		/*---------------------------------------------------------------------
+			Registers a wildcard handler that is only called for events in
+			the given categories (EventCategory bits). Registering for
+			sWildcardType with registerEventHandler is the same as passing
+			EventCategory_All. Unregister with sWildcardType.
+		---------------------------------------------------------------------*/
+		bool	registerWildcardHandler(const IEventHandlerPtr &handler, EventCategoryMask categories,
+										uint priority = 0);
+
 		/*---------------------------------------------------------------------
 			Calls removeEventHandler, also unregisters the listener for that
 			event type with the EventManager. Returns true if removal succeeds.
 		---------------------------------------------------------------------*/
 		bool	unregisterEventHandler(const string &eventType);
 
+		/*---------------------------------------------------------------------
+			Registers the listener with EventManager for the event type with a
+			typed delegate. Returns false if the listener already handles the
+			type. Called by subscribe.
+		---------------------------------------------------------------------*/
+		bool	subscribeDelegate(const string &eventType, const EventDelegate &delegate, uint priority);
+
+		/*---------------------------------------------------------------------
+			Removes a typed subscription, returns true if removal succeeds.
+			Called by unsubscribe.
+		---------------------------------------------------------------------*/
+		bool	unsubscribeType(const string &eventType);
+
+		/*---------------------------------------------------------------------
+			Subscribes a member function bool X::method(const E &) to event
+			type E, where E is a code-defined event with static sEventType
+			and sEventTypeId members. Priority as in registerEventHandler.
+		---------------------------------------------------------------------*/
+		template <typename E, typename X>
+		bool	subscribe(X *obj, bool (X::*method)(const E &), uint priority = 0) {
+					return subscribeDelegate(E::sEventType, EventDelegate::fromMethod(obj, method), priority);
+				}
+
+		/*---------------------------------------------------------------------
+			Subscribes a free or static function bool function(const E &)
+		---------------------------------------------------------------------*/
+		template <typename E>
+		bool	subscribe(bool (*function)(const E &), uint priority = 0) {
+					return subscribeDelegate(E::sEventType, EventDelegate::fromFunction(function), priority);
+				}
+
+		template <typename E>
+		bool	unsubscribe() { return unsubscribeType(E::sEventType); }
+
 		/*---------------------------------------------------------------------
 			Cleanup for when listener is destroyed or being reset. Unregisters
-			all remaining handlers in the map. If the derived listener hasn't
-			explicitly unregistered them, this will catch it.
+			all remaining handlers and typed subscriptions. If the derived
+			listener hasn't explicitly unregistered them, this will catch it.
 		---------------------------------------------------------------------*/
 		void	clearHandlers();
 
@@ -93,6 +205,14 @@ class EventListener {
 		---------------------------------------------------------------------*/
 		const string & name() const { return mName; }
 
+		/*---------------------------------------------------------------------
+			True if this listener's queued events can be handled on a worker
+			thread, in parallel with other listeners
+		---------------------------------------------------------------------*/
+		bool	isConcurrent() const { return mConcurrent; }
+
+		ifEventProfiler(const LatencyHistogram & latency() const { return mLatency; })
+
 		/*---------------------------------------------------------------------
 			shared_ptr passes the event, so even if frame ends and list is
 			purged, events with data that is needed longer are not actually
@@ -102,6 +222,9 @@ class EventListener {
 		bool	handle(const EventPtr &ePtr);	// return type could be enum
 
 		// Constructor / destructor
-		explicit EventListener(const string &listenerName) : mName(listenerName) {}
+		explicit EventListener(const string &listenerName, bool concurrent = false) :
+			mName(listenerName), mConcurrent(concurrent)
+			ifEventProfiler(, mBatchStart(0), mBatchEnd(0), mBatchThreadId(0))
+		{}
 		virtual ~EventListener() { clearHandlers(); }
 };
\ No newline at end of file
@@ -0,0 +1,229 @@
+/*----==== EVENTLOG.CPP ====----
+	Author:		Jeff Kiah
+	Orig.Date:	10/17/2026
+	Rev.Date:	10/17/2026
+------------------------------*/
+
+#include <cstring>
+#include "EventLog.h"
+#include "../HighPerfTimer.h"
+
+////////// class EventRecorder //////////
+
+/*-----------------------------------------------------------------------------
+	Maps the file at the given size, extending it if needed
+-----------------------------------------------------------------------------*/
+bool EventRecorder::map(uint64 capacity)
+{
+	mMapping = CreateFileMapping(mFile, NULL, PAGE_READWRITE,
+								 static_cast<DWORD>(capacity >> 32), static_cast<DWORD>(capacity),
+								 NULL);
+	if (mMapping == NULL) {
+		debugPrintf("EventRecorder: CreateFileMapping failed (error %d)\n", GetLastError());
+		return false;
+	}
+	mView = static_cast<char *>(MapViewOfFile(mMapping, FILE_MAP_WRITE, 0, 0, 0));
+	if (mView == NULL) {
+		debugPrintf("EventRecorder: MapViewOfFile failed (error %d)\n", GetLastError());
+		CloseHandle(mMapping);
+		mMapping = NULL;
+		return false;
+	}
+	mCapacity = capacity;
+	return true;
+}
+
+void EventRecorder::unmap()
+{
+	if (mView) {
+		UnmapViewOfFile(mView);
+		mView = 0;
+	}
+	if (mMapping) {
+		CloseHandle(mMapping);
+		mMapping = NULL;
+	}
+}
+
+/*-----------------------------------------------------------------------------
+	Creates (or truncates) the log file and writes the header
+-----------------------------------------------------------------------------*/
+bool EventRecorder::open(const string &filename)
+{
+	close();
+	mFile = CreateFileA(filename.c_str(),
+						GENERIC_READ | GENERIC_WRITE,	// mapping for write needs both
+						FILE_SHARE_READ,
+						NULL,
+						CREATE_ALWAYS,
+						FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+						NULL);
+	if (mFile == INVALID_HANDLE_VALUE) {
+		debugPrintf("EventRecorder: could not create \"%s\" (error %d)\n", filename.c_str(), GetLastError());
+		mFile = NULL;
+		return false;
+	}
+	if (!map(EVENTLOG_INITIAL_CAPACITY)) {
+		close();
+		return false;
+	}
+	EventLogHeader header = { EVENTLOG_MAGIC, EVENTLOG_VERSION, HighPerfTimer::timerFreq() };
+	memcpy(mView, &header, sizeof(header));
+	mSize = sizeof(header);
+	mNumRecords = 0;
+	return true;
+}
+
+/*-----------------------------------------------------------------------------
+	Trims the file to what was written and closes it
+-----------------------------------------------------------------------------*/
+void EventRecorder::close()
+{
+	unmap();
+	if (mFile) {
+		LARGE_INTEGER end;
+		end.QuadPart = static_cast<LONGLONG>(mSize);
+		if (!SetFilePointerEx(mFile, end, NULL, FILE_BEGIN) || !SetEndOfFile(mFile)) {
+			debugPrintf("EventRecorder: could not trim log file (error %d)\n", GetLastError());
+		}
+		CloseHandle(mFile);
+		mFile = NULL;
+		debugPrintf("EventRecorder: closed log, %u records, %I64u bytes\n", mNumRecords, mSize);
+	}
+	mCapacity = 0;
+	mSize = 0;
+}
+
+/*-----------------------------------------------------------------------------
+	Appends a record header and its payload, returns false if the view couldn't
+	be grown
+-----------------------------------------------------------------------------*/
+bool EventRecorder::append(EventLogRecordKind kind, EventTypeId typeId, __int64 time,
+						   const char *payload, uint size)
+{
+	_ASSERTE(isOpen());
+	uint64 needed = mSize + sizeof(EventLogRecord) + size;
+	if (needed > mCapacity) {
+		uint64 capacity = mCapacity * 2;
+		while (capacity < needed) capacity *= 2;
+		unmap();
+		if (!map(capacity)) {
+			debugPrintf("EventRecorder: failed to grow log to %I64u bytes, recording stopped\n", capacity);
+			close();
+			return false;
+		}
+	}
+	EventLogRecord rec;
+	memset(&rec, 0, sizeof(rec));
+	rec.size = size;
+	rec.typeId = typeId;
+	rec.kind = kind;
+	rec.time = time;
+	memcpy(mView + mSize, &rec, sizeof(rec));
+	if (size > 0) memcpy(mView + mSize + sizeof(rec), payload, size);
+	mSize = needed;
+	++mNumRecords;
+	return true;
+}
+
+// Constructor
+EventRecorder::EventRecorder() :
+	mFile(NULL), mMapping(NULL), mView(0),
+	mCapacity(0), mSize(0), mNumRecords(0)
+{}
+
+////////// class EventReplayer //////////
+
+/*-----------------------------------------------------------------------------
+	Maps the log file and checks its header
+-----------------------------------------------------------------------------*/
+bool EventReplayer::open(const string &filename)
+{
+	close();
+	mFile = CreateFileA(filename.c_str(),
+						GENERIC_READ,
+						FILE_SHARE_READ,
+						NULL,
+						OPEN_EXISTING,
+						FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+						NULL);
+	if (mFile == INVALID_HANDLE_VALUE) {
+		debugPrintf("EventReplayer: could not open \"%s\" (error %d)\n", filename.c_str(), GetLastError());
+		mFile = NULL;
+		return false;
+	}
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(mFile, &fileSize) || fileSize.QuadPart < static_cast<LONGLONG>(sizeof(EventLogHeader))) {
+		debugPrintf("EventReplayer: \"%s\" is not an event log\n", filename.c_str());
+		close();
+		return false;
+	}
+	mMapping = CreateFileMapping(mFile, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mMapping == NULL) {
+		debugPrintf("EventReplayer: CreateFileMapping failed (error %d)\n", GetLastError());
+		close();
+		return false;
+	}
+	mView = static_cast<const char *>(MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0));
+	if (mView == NULL) {
+		debugPrintf("EventReplayer: MapViewOfFile failed (error %d)\n", GetLastError());
+		close();
+		return false;
+	}
+	mSize = static_cast<uint64>(fileSize.QuadPart);
+
+	EventLogHeader header;
+	memcpy(&header, mView, sizeof(header));
+	if (header.magic != EVENTLOG_MAGIC || header.version != EVENTLOG_VERSION) {
+		debugPrintf("EventReplayer: \"%s\" has a bad header or version\n", filename.c_str());
+		close();
+		return false;
+	}
+	mTimerFreq = header.timerFreq;
+	mPos = sizeof(header);
+	return true;
+}
+
+void EventReplayer::close()
+{
+	if (mView) {
+		UnmapViewOfFile(mView);
+		mView = 0;
+	}
+	if (mMapping) {
+		CloseHandle(mMapping);
+		mMapping = NULL;
+	}
+	if (mFile) {
+		CloseHandle(mFile);
+		mFile = NULL;
+	}
+	mSize = 0;
+	mPos = 0;
+}
+
+/*-----------------------------------------------------------------------------
+	Reads the next record, outPayload points into the mapped view and is valid
+	until close. Returns false at the end of the log or if the record is
+	truncated.
+-----------------------------------------------------------------------------*/
+bool EventReplayer::next(EventLogRecord &outRecord, const char *&outPayload)
+{
+	if (!isOpen() || mPos + sizeof(EventLogRecord) > mSize) return false;
+	memcpy(&outRecord, mView + mPos, sizeof(EventLogRecord));
+	uint64 end = mPos + sizeof(EventLogRecord) + outRecord.size;
+	if (end > mSize) {
+		debugPrintf("EventReplayer: truncated record at offset %I64u\n", mPos);
+		mPos = mSize;
+		return false;
+	}
+	outPayload = mView + mPos + sizeof(EventLogRecord);
+	mPos = end;
+	return true;
+}
+
+// Constructor
+EventReplayer::EventReplayer() :
+	mFile(NULL), mMapping(NULL), mView(0),
+	mSize(0), mPos(0), mTimerFreq(0)
+{}
@@ -0,0 +1,150 @@
+/*----==== EVENTLOG.H ====----
+	Author:		Jeff Kiah
+	Orig.Date:	10/17/2026
+	Rev.Date:	10/17/2026
+----------------------------*/
+
+#pragma once
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN	// defined in project settings
+#endif
+
+#include <Windows.h>
+#include <string>
+#include <boost/noncopyable.hpp>
+#include "EventTypeId.h"
+#include "../Utility/Typedefs.h"
+
+using std::string;
+
+///// DEFINITIONS /////
+
+#define EVENTLOG_MAGIC				0x4C56454E	// "NEVL"
+#define EVENTLOG_VERSION			1
+#define EVENTLOG_INITIAL_CAPACITY	(16 * 1024 * 1024)	// bytes mapped when recording starts, doubles as needed
+
+/*=============================================================================
+	What a record in the log is. Frame markers separate the events of one
+	notifyQueued call from the next.
+=============================================================================*/
+enum EventLogRecordKind : uchar {
+	EventLogRecord_Frame = 0,	// marker, no payload
+	EventLogRecord_Raised,		// went through raise
+	EventLogRecord_Thread		// went through raiseThreadSafe, recorded when drained
+};
+
+///// STRUCTURES /////
+
+/*=============================================================================
+struct EventLogHeader
+	At the start of every log file
+=============================================================================*/
+struct EventLogHeader {
+	uint		magic;
+	uint		version;
+	__int64		timerFreq;	// HighPerfTimer counts per second of the recording session
+};
+
+/*=============================================================================
+struct EventLogRecord
+	Precedes every record, followed by size bytes of payload written by the
+	event's serialize method. Empty events have no payload.
+=============================================================================*/
+struct EventLogRecord {
+	uint				size;		// payload bytes following this header
+	EventTypeId			typeId;		// 0 for frame markers
+	EventLogRecordKind	kind;
+	uchar				pad[7];
+	__int64				time;		// HighPerfTimer counts when the event was raised
+};
+
+/*=============================================================================
+class EventRecorder
+	Appends records to a log file through a memory-mapped view, so recording
+	an event is a memcpy into the view. When the view fills up it is remapped
+	at twice the size, which extends the file. The file is truncated to the
+	data actually written when closed. The recorder only deals in bytes, what
+	goes in the records is up to EventManager.
+=============================================================================*/
+class EventRecorder : private boost::noncopyable {
+	private:
+		///// VARIABLES /////
+		HANDLE		mFile;
+		HANDLE		mMapping;
+		char *		mView;
+		uint64		mCapacity;	// bytes mapped
+		uint64		mSize;		// bytes written
+		uint		mNumRecords;
+
+		///// FUNCTIONS /////
+		/*---------------------------------------------------------------------
+			Maps the file at the given size, extending it if needed
+		---------------------------------------------------------------------*/
+		bool	map(uint64 capacity);
+		void	unmap();
+
+	public:
+		bool	isOpen() const		{ return (mView != 0); }
+		uint	numRecords() const	{ return mNumRecords; }
+
+		/*---------------------------------------------------------------------
+			Creates (or truncates) the log file and writes the header
+		---------------------------------------------------------------------*/
+		bool	open(const string &filename);
+
+		/*---------------------------------------------------------------------
+			Trims the file to what was written and closes it
+		---------------------------------------------------------------------*/
+		void	close();
+
+		/*---------------------------------------------------------------------
+			Appends a record header and its payload, returns false if the view
+			couldn't be grown
+		---------------------------------------------------------------------*/
+		bool	append(EventLogRecordKind kind, EventTypeId typeId, __int64 time,
+					   const char *payload, uint size);
+
+		// Constructor / destructor
+		explicit EventRecorder();
+		~EventRecorder() { close(); }
+};
+
+/*=============================================================================
+class EventReplayer
+	Reads a log written by EventRecorder through a read-only memory-mapped
+	view of the whole file. Records are handed out in order with their payload
+	pointing straight into the view.
+=============================================================================*/
+class EventReplayer : private boost::noncopyable {
+	private:
+		///// VARIABLES /////
+		HANDLE			mFile;
+		HANDLE			mMapping;
+		const char *	mView;
+		uint64			mSize;
+		uint64			mPos;		// offset of the next record
+		__int64			mTimerFreq;	// from the header
+
+	public:
+		bool	isOpen() const	{ return (mView != 0); }
+		bool	atEnd() const	{ return (mPos >= mSize); }
+		__int64	timerFreq() const { return mTimerFreq; }
+
+		/*---------------------------------------------------------------------
+			Maps the log file and checks its header
+		---------------------------------------------------------------------*/
+		bool	open(const string &filename);
+		void	close();
+
+		/*---------------------------------------------------------------------
+			Reads the next record, outPayload points into the mapped view and
+			is valid until close. Returns false at the end of the log or if the
+			record is truncated.
+		---------------------------------------------------------------------*/
+		bool	next(EventLogRecord &outRecord, const char *&outPayload);
+
+		// Constructor / destructor
+		explicit EventReplayer();
+		~EventReplayer() { close(); }
+};
@@ -1,52 +1,533 @@
 /*----==== EVENTMANAGER.CPP ====----
 	Author:		Jeffrey Kiah
 	Orig.Date:	07/23/2007
-	Rev.Date:	05/22/2009
+	Rev.Date:	10/17/2026
 ----------------------------------*/
 
 #include "EventManager.h"
+#include "EventSerialization.h"
 #include "../HighPerfTimer.h"
-#include "../Utility/ConcurrentQueue.h"
+#include "BoundedEventQueue.h"
+#include "../Process/JobSystem.h"
+#include <algorithm>
+
+///// VARIABLES /////
+
+// Calling thread's lane, valid while tlsThreadLaneGen matches the manager's mThreadLaneGen
+static __declspec(thread) ThreadSafeEventQueue *	tlsThreadLane = 0;
+static __declspec(thread) LONG						tlsThreadLaneGen = 0;
+static volatile LONG								sThreadLaneGen = 0;
+// Set while the calling thread runs a concurrent batch, see inConcurrentBatch
+static __declspec(thread) bool						tlsInConcurrentBatch = false;
+
+///// STRUCTURES /////
+
+/*=============================================================================
+class PooledEmptyEvent
+	allocate_shared constructs the object from inside the standard library, so
+	it can't reach EmptyEvent's protected constructor. This exposes it to
+	makeEvent without letting anyone outside this file create empty events.
+=============================================================================*/
+class PooledEmptyEvent : public EmptyEvent {
+	public:
+		explicit PooledEmptyEvent(const string &eventType, EventTypeId eventTypeId) :
+			EmptyEvent(eventType, eventTypeId)
+		{}
+		virtual ~PooledEmptyEvent() {}
+};
 
 ////////// class EventManager //////////
 
 /*-----------------------------------------------------------------------------
-	Notifies listeners of a single event raised or triggered
+	Notifies listeners of a single event raised or triggered, the caller passes
+	in the type entry it has already looked up. When deferConcurrent is true,
+	concurrent listeners get the event added to their batch instead of being
+	called. Concurrent listeners never consume, even when called directly.
 -----------------------------------------------------------------------------*/
-void EventManager::notifyListeners(const EventPtr &ePtr) const
+void EventManager::notifyListeners(const EventPtr &ePtr, const EventTypeEntry &entry, bool deferConcurrent)
 {
+	// the listener lists are snapshots that stay alive until the outermost read section ends,
+	// so iterating here is safe even if a handler (or another thread) registers or removes
+	// listeners, removals null out the slot in the snapshot
+	beginRead();
+	ifEventProfiler(uint64 dispatchStart = EventProfiler::now();)
+
 	// this section is for listeners of the wildcard type EventListener::sWildcardType
 	// if the handler returns true to consume, will not stop propagation here
-	EventTypeMap::const_iterator ei = mEventTypeMap.find(EventListener::sWildcardType);
-	if (ei != mEventTypeMap.end()) {
-		ListenerList::const_iterator li, end = ei->second.end();
-		for (li = ei->second.begin(); li != end; ++li) {
-			(*li).first->handle(ePtr);
+	// the entry's wildcard list only has the wildcard listeners that want its category
+	const ListenerList &wildcardList = *entry.wildcards;
+	ListenerList::const_iterator li, end = wildcardList.end();
+	for (li = wildcardList.begin(); li != end; ++li) {
+		EventListener *lPtr = li->listener;
+		if (!lPtr) continue; // removed during dispatch
+		if (deferConcurrent && lPtr->isConcurrent()) {
+			deferToConcurrent(*li, ePtr);
+		} else {
+			callListener(*li, ePtr, entry);
 		}
 	}
 
 	// this section looks for listeners actually registered for the specific event
 	// and will honor the return value of true for consumed events
-	ei = mEventTypeMap.find((*ePtr).type());
-	if (ei != mEventTypeMap.end()) {
-		ListenerList::const_iterator li, end = ei->second.end();
-		for (li = ei->second.begin(); li != end; ++li) {
-			// if a handler returns true, it consumes the event and stops propagation
-			bool consumed = (*li).first->handle(ePtr);
-			if (consumed) {
-				#ifdef _DEBUG
-				ListenerList::const_iterator li_check = li;
-				++li_check;
-				if (li_check != end) {
-					debugPrintf("EventMgr: Listener \"%s\" consumed event of type \"%s\", listeners skipped\n",
-						(*li).first->name().c_str(), (*ePtr).type().c_str());
-				}
-				#endif
-				break;
+	const ListenerList &typeList = *entry.listeners;
+	end = typeList.end();
+	for (li = typeList.begin(); li != end; ++li) {
+		EventListener *lPtr = li->listener;
+		if (!lPtr) continue; // removed during dispatch
+		// concurrent listeners are batched in their place in the priority order, so they
+		// see exactly the events they would have seen if called here
+		if (lPtr->isConcurrent()) {
+			if (deferConcurrent) {
+				deferToConcurrent(*li, ePtr);
+			} else {
+				callListener(*li, ePtr, entry);
+			}
+			continue;
+		}
+		// if a handler returns true, it consumes the event and stops propagation
+		bool consumed = callListener(*li, ePtr, entry);
+		if (consumed) {
+			#ifdef _DEBUG
+			ListenerList::const_iterator li_check = li;
+			++li_check;
+			if (li_check != end) {
+				debugPrintf("EventMgr: Listener \"%s\" consumed event of type \"%s\", listeners skipped\n",
+					lPtr->name().c_str(), entry.name.c_str());
 			}
+			#endif
+			break;
 		}
 	}
 	(*ePtr).mState = EventState_Handled;
+	#if EVENT_PROFILER
+	++entry.stats.dispatched;
+	entry.stats.dispatchCycles += EventProfiler::now() - dispatchStart;
+	#endif
+
+	endRead();
+}
+
+/*-----------------------------------------------------------------------------
+	Called off the main thread after publishing a removal. The main thread
+	only holds old snapshots inside a read section, so once it leaves the one
+	it was in (or wasn't in one to begin with) it can't be calling into the
+	removed listener. Read sections are a frame's dispatch at most, and this
+	is only for the rare worker thread removal, so it sleeps rather than spins.
+-----------------------------------------------------------------------------*/
+void EventManager::waitForReaders() const
+{
+	LONG epoch = mReadEpoch;
+	if ((epoch & 1) == 0) return;
+	while (mReadEpoch == epoch) Sleep(1);
+}
+
+/*-----------------------------------------------------------------------------
+	Runs every pending concurrent batch as a job and waits for them to finish,
+	or runs them in turn if there is no JobSystem. The batches are released
+	here on the main thread after the join, then the listener removals the
+	batches deferred are carried out.
+-----------------------------------------------------------------------------*/
+void EventManager::dispatchConcurrent()
+{
+	if (mConcurrentPending.empty()) return;
+
+	vector<EventListener*>::const_iterator li, end = mConcurrentPending.end();
+	if (mConcurrentPending.size() == 1 || !JobSystem::exists()) {
+		// not worth the handoff, or no pool to hand off to, run them here
+		for (li = mConcurrentPending.begin(); li != end; ++li) {
+			runConcurrentBatch(*li);
+		}
+	} else {
+		JobCounter batches;
+		for (li = mConcurrentPending.begin(); li != end; ++li) {
+			jobSys.spawn(&EventManager::runConcurrentBatch, *li, &batches);
+		}
+		jobSys.wait(batches); // the main thread runs batches too while it waits
+	}
+	for (li = mConcurrentPending.begin(); li != end; ++li) {
+		(*li)->mConcurrentBatch.clear();
+		#if EVENT_PROFILER
+		if (mProfiler.capturing()) {
+			mProfiler.addSpan((*li)->name(), string(), (*li)->mBatchStart, (*li)->mBatchEnd, (*li)->mBatchThreadId);
+		}
+		#endif
+	}
+	mConcurrentPending.clear();
+
+	// no batch is running now, so the lock is only for form's sake
+	vector<std::pair<string, EventListener*> > removals;
+	{
+		mutex::scoped_lock lock(mDeferredMutex);
+		removals.swap(mDeferredRemovals);
+	}
+	for (uint r = 0; r < removals.size(); ++r) {
+		removeListener(removals[r].first, removals[r].second);
+	}
+}
+
+/*-----------------------------------------------------------------------------
+	Job function, handles one listener's batch in order
+-----------------------------------------------------------------------------*/
+void EventManager::runConcurrentBatch(void *param)
+{
+	EventListener &l = *static_cast<EventListener*>(param);
+	tlsInConcurrentBatch = true;
+	// the listener's stats are only touched by the one thread running its batch
+	ifEventProfiler(l.mBatchThreadId = GetCurrentThreadId(); l.mBatchStart = EventProfiler::now();)
+	EventListener::ConcurrentBatch::const_iterator bi, end = l.mConcurrentBatch.end();
+	for (bi = l.mConcurrentBatch.begin(); bi != end; ++bi) {
+		#if EVENT_PROFILER
+		uint64 start = EventProfiler::now();
+		#endif
+		// return value ignored, concurrent listeners can't consume
+		if (bi->delegate.isBound()) {
+			bi->delegate(*bi->ePtr);
+		} else if (bi->handler) {
+			(*bi->handler)(bi->ePtr);
+		} else {
+			l.handle(bi->ePtr);
+		}
+		ifEventProfiler(l.mLatency.add(EventProfiler::now() - start);)
+	}
+	ifEventProfiler(l.mBatchEnd = EventProfiler::now();)
+	tlsInConcurrentBatch = false;
+}
+
+/*-----------------------------------------------------------------------------
+	True on a thread that is running a concurrent batch. Listeners can't be
+	registered from there, and removal is deferred until the batches join: on
+	a worker, removal would wait for the main thread to leave a read section
+	it is holding open until this very batch returns, and on the main thread
+	it would erase from the batches being iterated.
+-----------------------------------------------------------------------------*/
+bool EventManager::inConcurrentBatch()
+{
+	return tlsInConcurrentBatch;
+}
+
+/*-----------------------------------------------------------------------------
+	Drops events of one type (or all, for the wildcard) from a listener's
+	pending batch, used when the listener is removed. Batches only exist
+	during notifyQueued, so this matters when a handler removes a listener.
+-----------------------------------------------------------------------------*/
+void EventManager::purgeConcurrent(EventListener *lPtr, const EventTypeEntry &entry)
+{
+	EventListener::ConcurrentBatch &batch = lPtr->mConcurrentBatch;
+	if (&entry == mWildcardEntry) {
+		batch.clear();
+	} else {
+		EventListener::ConcurrentBatch::iterator bi = batch.begin();
+		while (bi != batch.end()) {
+			if ((*bi->ePtr).typeId() == entry.id) {
+				bi = batch.erase(bi);
+			} else {
+				++bi;
+			}
+		}
+	}
+	if (batch.empty()) {
+		mConcurrentPending.erase(std::remove(mConcurrentPending.begin(), mConcurrentPending.end(), lPtr),
+								 mConcurrentPending.end());
+	}
+}
+
+/*-----------------------------------------------------------------------------
+	Stamps a raised event and adds it to its type's queue lane. For coalesced
+	event types, if an event with the same key is still queued the new event
+	takes its place instead, so listeners only see the latest state and the
+	event keeps the older event's position in the queue. A type's lane never
+	changes, so the coalesce sequence always refers to that lane. The event
+	is recorded before coalescing, a replay queues it here again and so
+	coalesces the same way.
+-----------------------------------------------------------------------------*/
+void EventManager::queueEvent(const EventPtr &ePtr, const EventTypeEntry &entry)
+{
+	(*ePtr).mState = EventState_Raised;
+	(*ePtr).mTime = HighPerfTimer::queryCounts();
+	if (mRecorder) recordEvent(ePtr, entry, EventLogRecord_Raised);
+
+	EventQueue &queue = mEventQueues[entry.regPtr->priority()];
+	if (entry.regPtr->isCoalesced()) {
+		CoalesceKeyMap &keys = mCoalesceMap[entry.id];
+		uint64 key = entry.regPtr->coalesceKey(*ePtr);
+		CoalesceKeyMap::iterator ci = keys.find(key);
+		if (ci != keys.end() && queue.hasSequence(ci->second)) {
+			queue.atSequence(ci->second) = ePtr; // releases the superseded event
+			ifEventProfiler(++entry.stats.coalesced;)
+			debugPrintf("EventMgr: \"%s\" event coalesced\n", entry.name.c_str());
+			return;
+		}
+		keys[key] = queue.nextSequence();
+	}
+	queue.push_back(ePtr);
+	ifEventProfiler(++entry.stats.raised;)
+}
+
+/*-----------------------------------------------------------------------------
+	Converts HighPerfTimer counts to timer wheel ticks. Expire times round up
+	so a scheduled event is never raised early. Whole seconds and the
+	remainder are converted separately, multiplying the whole delta by 1000
+	would overflow after a few weeks of uptime.
+-----------------------------------------------------------------------------*/
+uint64 EventManager::countsToTick(__int64 counts, bool roundUp) const
+{
+	if (counts <= mTimerBase) return 0;
+	uint64 delta = static_cast<uint64>(counts - mTimerBase);
+	uint64 freq = static_cast<uint64>(HighPerfTimer::timerFreq());
+	uint64 remMs = (delta % freq) * 1000; // remainder < freq, so this can't overflow
+	return (delta / freq) * 1000 + (roundUp ? (remMs + freq - 1) / freq : remMs / freq);
+}
+
+/*-----------------------------------------------------------------------------
+	Queues every scheduled event that has come due. Timers that expire during
+	a replay are dropped like any live raise.
+-----------------------------------------------------------------------------*/
+void EventManager::expireTimers()
+{
+	mTimerWheel.advance(countsToTick(HighPerfTimer::queryCounts(), false), [this](const EventPtr &ePtr) {
+		if (mReplayer) return; // the log supplies raised events during a replay
+		// registration was checked when scheduled, and entries are never removed
+		const EventTypeEntry *te = mTypeTable.find((*ePtr).typeId());
+		_ASSERTE(te && "Scheduled event without a type entry");
+		queueEvent(ePtr, *te);
+		debugPrintf("EventMgr: scheduled \"%s\" event raised\n", te->name.c_str());
+	});
+}
+
+/*-----------------------------------------------------------------------------
+	Returns the calling thread's lane, creating it on the thread's first
+	raiseThreadSafe. After that it's one thread local read. The lane is
+	published by the interlocked increment of mNumThreadLanes, so the main
+	thread never sees a count that includes a lane not yet stored.
+-----------------------------------------------------------------------------*/
+ThreadSafeEventQueue & EventManager::threadLane()
+{
+	if (tlsThreadLane && tlsThreadLaneGen == mThreadLaneGen) return *tlsThreadLane;
+
+	mutex::scoped_lock lock(mThreadLaneMutex);
+	ThreadSafeEventQueue *lane = 0;
+	if (mNumThreadLanes < EVENTMGR_MAX_THREAD_LANES) {
+		lane = new ThreadSafeEventQueue(mThreadCapacity, mThreadPolicy);
+		// the main thread consumes every lane, its own raiseThreadSafe calls must never block
+		lane->setConsumerThread(mMainThreadId);
+		lane->setCoalesceKeyFunc(&EventManager::threadCoalesceKey);
+		mThreadLanes[mNumThreadLanes] = lane;
+		InterlockedIncrement(&mNumThreadLanes);
+	} else {
+		lane = mThreadLanes[0];
+		debugPrintf("EventMgr: out of thread queues, thread %u shares the main thread's\n", GetCurrentThreadId());
+	}
+	tlsThreadLane = lane;
+	tlsThreadLaneGen = mThreadLaneGen;
+	return *lane;
+}
+
+/*-----------------------------------------------------------------------------
+	Drains every lane into mThreadDrainBuffer, merging them in timestamp order.
+	Each lane is already in time order, since a thread stamps mTime just
+	before it pushes, so each drained run is merged into the buffer with
+	inplace_merge (stable, so equal times keep lane order). Only the shared
+	lane 0 can hold slightly out of order events, from threads racing to
+	push. The budget is drained in rounds: each round splits what is left of
+	it evenly between the lanes that still have events, and a lane that
+	comes up short of its share is done for the frame. So one busy thread
+	can't hold back the others, but idle lanes don't cost it any of the
+	budget, a lone busy thread gets all of it.
+-----------------------------------------------------------------------------*/
+void EventManager::drainThreadLanes()
+{
+	LONG numLanes = mNumThreadLanes; // lanes created after this read wait for next frame
+	LONG active[EVENTMGR_MAX_THREAD_LANES];
+	LONG numActive = 0;
+	for (LONG l = 0; l < numLanes; ++l) {
+		if (!mThreadLanes[l]->empty()) active[numActive++] = l;
+	}
+	uint budgetLeft = mThreadDrainBudget;
+	while (numActive > 0) {
+		uint laneBudget = 0; // 0 drains a lane completely
+		if (mThreadDrainBudget > 0) {
+			if (budgetLeft == 0) break;
+			laneBudget = (budgetLeft + numActive - 1) / numActive;
+		}
+		LONG stillActive = 0;
+		for (LONG i = 0; i < numActive; ++i) {
+			size_t runStart = mThreadDrainBuffer.size();
+			uint count = mThreadLanes[active[i]]->drain([this](const EventPtr &ePtr) {
+				mThreadDrainBuffer.push_back(ePtr);
+			}, (mThreadDrainBudget > 0) ? std::min(laneBudget, budgetLeft) : 0);
+			if (runStart > 0 && mThreadDrainBuffer.size() > runStart) {
+				std::inplace_merge(mThreadDrainBuffer.begin(), mThreadDrainBuffer.begin() + runStart,
+					mThreadDrainBuffer.end(),
+					[](const EventPtr &a, const EventPtr &b) { return (*a).time() < (*b).time(); });
+			}
+			if (mThreadDrainBudget > 0) {
+				budgetLeft -= count;
+				if (count == laneBudget) active[stillActive++] = active[i];
+				if (budgetLeft == 0) break;
+			}
+		}
+		numActive = stillActive; // without a budget every lane was drained in the first round
+	}
+}
+
+/*-----------------------------------------------------------------------------
+	Dispatches everything drained from the thread-safe queue, in order. For
+	coalesced event types only the last event for each key is dispatched, in
+	the position of the first.
+-----------------------------------------------------------------------------*/
+void EventManager::notifyThreadEvents()
+{
+	bool anyCoalesced = false;
+	vector<EventPtr>::const_iterator ei, end = mThreadDrainBuffer.end();
+	for (ei = mThreadDrainBuffer.begin(); ei != end; ++ei) {
+		const EventTypeEntry *te = mTypeTable.find((**ei).typeId());
+		_ASSERTE(te && "Thread-safe event raised without a type entry");
+		ifEventProfiler(++te->stats.threadRaised;)
+		if (mRecorder) recordEvent(*ei, *te, EventLogRecord_Thread);
+		if (te->regPtr->isCoalesced()) {
+			// remember the last event for each key, later ones overwrite
+			uint64 key = te->regPtr->coalesceKey(**ei);
+			mThreadCoalesceMap[te->id][key] = static_cast<uint>(ei - mThreadDrainBuffer.begin());
+			anyCoalesced = true;
+		}
+	}
+
+	for (ei = mThreadDrainBuffer.begin(); ei != end; ++ei) {
+		const EventTypeEntry *te = mTypeTable.find((**ei).typeId());
+		if (anyCoalesced && te->regPtr->isCoalesced()) {
+			CoalesceKeyMap &keys = mThreadCoalesceMap[te->id];
+			CoalesceKeyMap::iterator ci = keys.find(te->regPtr->coalesceKey(**ei));
+			if (ci == keys.end()) { // latest for this key already dispatched
+				ifEventProfiler(++te->stats.coalesced;)
+				continue;
+			}
+			const EventPtr &latest = mThreadDrainBuffer[ci->second];
+			keys.erase(ci);
+			ifEventProfiler(if (&latest != &*ei) ++te->stats.coalesced;)
+			notifyListeners(latest, *te, true);
+		} else {
+			notifyListeners(*ei, *te, true);
+		}
+	}
+	mThreadDrainBuffer.clear();
+}
+
+/*-----------------------------------------------------------------------------
+	Serializes an event into the log being recorded. Events of types that
+	aren't serializable are skipped, empty events are recorded by type alone.
+-----------------------------------------------------------------------------*/
+void EventManager::recordEvent(const EventPtr &ePtr, const EventTypeEntry &entry, EventLogRecordKind kind)
+{
+	if (!entry.regPtr->isSerializable()) return;
+
+	mRecordBuffer.clear();
+	if (!entry.regPtr->isEmpty()) {
+		VectorStreamBuf buf(mRecordBuffer);
+		ostream out(&buf);
+		(*ePtr).serialize(out);
+	}
+	uint size = static_cast<uint>(mRecordBuffer.size());
+	if (!mRecorder->append(kind, entry.id, (*ePtr).mTime, (size > 0) ? &mRecordBuffer[0] : 0, size)) {
+		stopRecording();
+	}
+}
+
+/*-----------------------------------------------------------------------------
+	Feeds the next recorded frame from the log being replayed into the queues.
+	A frame in the log ends at its marker, which was written after the thread
+	events were handled and before the regular queue was processed, so raised
+	events go on the back of the queue and thread events into the drain buffer
+	in the order they were recorded. Stops the replay at the end of the log.
+-----------------------------------------------------------------------------*/
+void EventManager::replayFrame()
+{
+	EventLogRecord rec;
+	const char *payload = 0;
+	for (;;) {
+		if (!mReplayer->next(rec, payload)) {
+			debugPrintf("EventMgr: replay finished\n");
+			stopReplay();
+			return;
+		}
+		if (rec.kind == EventLogRecord_Frame) return;
+
+		EventTypeEntry *te = findRegistered(rec.typeId);
+		if (!te || !te->regPtr->isSerializable()) {
+			debugPrintf("EventMgr: replay skipped event id %u, not registered\n", rec.typeId);
+			continue;
+		}
+		EventPtr ePtr;
+		if (te->regPtr->isEmpty()) {
+			ePtr = makeEvent<PooledEmptyEvent>(te->name, rec.typeId);
+		} else {
+			MemoryStreamBuf buf(payload, rec.size);
+			istream in(&buf);
+			ePtr = te->regPtr->readEvent(in);
+			if (!in) {
+				debugPrintf("EventMgr: replay failed to read \"%s\" event\n", te->name.c_str());
+				continue;
+			}
+		}
+		if (rec.kind == EventLogRecord_Thread) {
+			(*ePtr).mState = EventState_Raised;
+			(*ePtr).mTime = HighPerfTimer::queryCounts();
+			mThreadDrainBuffer.push_back(ePtr);
+		} else {
+			queueEvent(ePtr, *te);
+		}
+	}
+}
+
+/*-----------------------------------------------------------------------------
+	Records every raised event to a memory-mapped log file
+-----------------------------------------------------------------------------*/
+bool EventManager::startRecording(const string &filename)
+{
+	if (mReplayer) {
+		debugPrintf("EventMgr: cannot record during a replay\n");
+		return false;
+	}
+	stopRecording();
+	mRecorder = new EventRecorder();
+	if (!mRecorder->open(filename)) {
+		delete mRecorder;
+		mRecorder = 0;
+		return false;
+	}
+	debugPrintf("EventMgr: recording events to \"%s\"\n", filename.c_str());
+	return true;
+}
+
+void EventManager::stopRecording()
+{
+	delete mRecorder; // closes the log
+	mRecorder = 0;
+}
+
+/*-----------------------------------------------------------------------------
+	Replays a recorded log, one recorded frame per notifyQueued call
+-----------------------------------------------------------------------------*/
+bool EventManager::startReplay(const string &filename)
+{
+	if (mRecorder) {
+		debugPrintf("EventMgr: cannot replay while recording\n");
+		return false;
+	}
+	stopReplay();
+	mReplayer = new EventReplayer();
+	if (!mReplayer->open(filename)) {
+		delete mReplayer;
+		mReplayer = 0;
+		return false;
+	}
+	debugPrintf("EventMgr: replaying events from \"%s\"\n", filename.c_str());
+	return true;
+}
+
+void EventManager::stopReplay()
+{
+	delete mReplayer;
+	mReplayer = 0;
 }
 
 /*-----------------------------------------------------------------------------
@@ -54,13 +535,13 @@ void EventManager::notifyListeners(const EventPtr &ePtr) const
 -----------------------------------------------------------------------------*/
 void EventManager::raise(const EventPtr &ePtr)
 {	// Take the pointer passed in and fill with info like time, class that raised event, etc.
-	if (!isEventTypeRegistered((*ePtr).type())) {
+	const EventTypeEntry *te = findRegistered((*ePtr).typeId());
+	if (!te) {
 		debugPrintf("EventMgr: cannot raise \"%s\" event, not registered\n", (*ePtr).type().c_str());
 		return;
 	}
-	(*ePtr).mState = EventState_Raised;
-	(*ePtr).mTime = HighPerfTimer::queryCounts();
-	mEventQueue[mActiveQueue].push_back(ePtr);
+	if (mReplayer) return; // the log supplies raised events during a replay
+	queueEvent(ePtr, *te);
 	debugPrintf("EventMgr: \"%s\" event raised\n", (*ePtr).type().c_str());
 }
 /*-----------------------------------------------------------------------------
@@ -68,57 +549,150 @@ void EventManager::raise(const EventPtr &ePtr)
 	This cannot be used to trigger events where the registered type
 	specifies "EventData_NotEmpty".
 -----------------------------------------------------------------------------*/
-void EventManager::raise(const string &eventType)
+void EventManager::raise(EventTypeId eventTypeId)
 {
-	RegEventMap::const_iterator ri = mRegEventMap.find(eventType);
-	if (ri != mRegEventMap.end()) {
-		_ASSERTE(ri->second->isEmpty() && "Cannot raise non-empty event with this interface, use EventPtr interface");
-		if (ri->second->isEmpty()) {
-			EventPtr ePtr(new EmptyEvent(eventType));
-			(*ePtr).mState = EventState_Raised;
-			(*ePtr).mTime = HighPerfTimer::queryCounts();
-			mEventQueue[mActiveQueue].push_back(ePtr);
-			debugPrintf("EventMgr: \"%s\" event raised\n", (*ePtr).type().c_str());
+	EventTypeEntry *te = findRegistered(eventTypeId);
+	if (te) {
+		_ASSERTE(te->regPtr->isEmpty() && "Cannot raise non-empty event with this interface, use EventPtr interface");
+		if (te->regPtr->isEmpty()) {
+			if (mReplayer) return; // the log supplies raised events during a replay
+			EventPtr ePtr(makeEvent<PooledEmptyEvent>(te->name, eventTypeId));
+			queueEvent(ePtr, *te);
+			debugPrintf("EventMgr: \"%s\" event raised\n", te->name.c_str());
 		} else {
 			// add message to release logging
 		}
 	} else {
-		debugPrintf("EventMgr: cannot raise \"%s\" event, not registered\n", eventType.c_str());
+		debugPrintf("EventMgr: cannot raise event id %u, not registered\n", eventTypeId);
 	}
 }
 
+/*-----------------------------------------------------------------------------
+	Raises the event at a time in HighPerfTimer counts, the same clock as
+	Event::time. It is queued by the first notifyQueued at or after that time
+	(to 1ms resolution) and handled like any raised event. Returns an id for
+	cancelTimer, or 0 if the event can't be raised.
+-----------------------------------------------------------------------------*/
+EventTimerId EventManager::raiseAt(const EventPtr &ePtr, __int64 timeCounts)
+{
+	if (!findRegistered((*ePtr).typeId())) {
+		debugPrintf("EventMgr: cannot schedule \"%s\" event, not registered\n", (*ePtr).type().c_str());
+		return 0;
+	}
+	if (mReplayer) return 0; // the log supplies raised events during a replay
+	(*ePtr).mState = EventState_Scheduled;
+	return mTimerWheel.schedule(ePtr, countsToTick(timeCounts, true));
+}
+
+EventTimerId EventManager::raiseAt(EventTypeId eventTypeId, __int64 timeCounts)
+{
+	EventTypeEntry *te = findRegistered(eventTypeId);
+	if (!te) {
+		debugPrintf("EventMgr: cannot schedule event id %u, not registered\n", eventTypeId);
+		return 0;
+	}
+	_ASSERTE(te->regPtr->isEmpty() && "Cannot raise non-empty event with this interface, use EventPtr interface");
+	if (!te->regPtr->isEmpty()) return 0;
+	return raiseAt(EventPtr(makeEvent<PooledEmptyEvent>(te->name, eventTypeId)), timeCounts);
+}
+
+/*-----------------------------------------------------------------------------
+	Raises the event delayMillis from now, see raiseAt
+-----------------------------------------------------------------------------*/
+EventTimerId EventManager::raiseAfter(const EventPtr &ePtr, ulong delayMillis)
+{
+	return raiseAt(ePtr, HighPerfTimer::queryCounts() +
+					(static_cast<__int64>(delayMillis) * HighPerfTimer::timerFreq()) / 1000);
+}
+
+EventTimerId EventManager::raiseAfter(EventTypeId eventTypeId, ulong delayMillis)
+{
+	return raiseAt(eventTypeId, HighPerfTimer::queryCounts() +
+					(static_cast<__int64>(delayMillis) * HighPerfTimer::timerFreq()) / 1000);
+}
+
 /*-----------------------------------------------------------------------------
 	Multithread safe raise methods
 -----------------------------------------------------------------------------*/
 void EventManager::raiseThreadSafe(const EventPtr &ePtr)
 {
-	if (!isEventTypeRegistered((*ePtr).type())) {
+	if (!findRegistered((*ePtr).typeId())) {
 		debugPrintf("EventMgr: cannot raise \"%s\" event, not registered\n", (*ePtr).type().c_str());
 		return;
 	}
 	(*ePtr).mState = EventState_Raised;
 	(*ePtr).mTime = HighPerfTimer::queryCounts();
-	mThreadEventQueue->push(ePtr);
+	threadLane().push(ePtr);
 	debugPrintf("EventMgr: thread safe \"%s\" event raised\n", (*ePtr).type().c_str());
 }
 
-void EventManager::raiseThreadSafe(const string &eventType)
+void EventManager::raiseThreadSafe(EventTypeId eventTypeId)
 {
-	RegEventMap::const_iterator ri = mRegEventMap.find(eventType);
-	if (ri != mRegEventMap.end()) {
-		_ASSERTE(ri->second->isEmpty() && "Cannot raise non-empty event with this interface, use EventPtr interface");
-		if (ri->second->isEmpty()) {
-			EventPtr ePtr(new EmptyEvent(eventType));
+	EventTypeEntry *te = findRegistered(eventTypeId);
+	if (te) {
+		_ASSERTE(te->regPtr->isEmpty() && "Cannot raise non-empty event with this interface, use EventPtr interface");
+		if (te->regPtr->isEmpty()) {
+			EventPtr ePtr(makeEvent<PooledEmptyEvent>(te->name, eventTypeId));
 			(*ePtr).mState = EventState_Raised;
 			(*ePtr).mTime = HighPerfTimer::queryCounts();
-			mThreadEventQueue->push(ePtr);
-			debugPrintf("EventMgr: thread safe \"%s\" event raised\n", (*ePtr).type().c_str());
+			threadLane().push(ePtr);
+			debugPrintf("EventMgr: thread safe \"%s\" event raised\n", te->name.c_str());
 		} else {
 			// add message to release logging
 		}
 	} else {
-		debugPrintf("EventMgr: cannot raise \"%s\" event, not registered\n", eventType.c_str());
+		debugPrintf("EventMgr: cannot raise event id %u, not registered\n", eventTypeId);
+	}
+}
+
+/*-----------------------------------------------------------------------------
+	Coalesce key function for the thread-safe queue, gives events of coalesced
+	types the same key as the main queue uses, grouped by type id. Called on
+	the main thread, the queue's consumer, so reading the type table is safe.
+-----------------------------------------------------------------------------*/
+bool EventManager::threadCoalesceKey(const EventPtr &ePtr, uint64 &outGroup, uint64 &outKey)
+{
+	const EventTypeEntry *te = eventMgr.findRegistered((*ePtr).typeId());
+	if (!te || !te->regPtr->isCoalesced()) return false;
+	outGroup = te->id;
+	outKey = te->regPtr->coalesceKey(*ePtr);
+	return true;
+}
+
+/*-----------------------------------------------------------------------------
+	Sets the capacity (0 for unbounded) and overflow policy of each thread's
+	queue, and how many thread events are dispatched per notifyQueued (0 for
+	all). Call before worker threads start raising.
+-----------------------------------------------------------------------------*/
+void EventManager::setThreadQueueLimits(uint capacity, EventOverflowPolicy policy, uint drainBudget)
+{
+	mutex::scoped_lock lock(mThreadLaneMutex);
+	mThreadCapacity = capacity;
+	mThreadPolicy = policy;
+	mThreadDrainBudget = drainBudget;
+	for (LONG l = 0; l < mNumThreadLanes; ++l) {
+		mThreadLanes[l]->setCapacity(capacity, policy);
+	}
+}
+
+/*-----------------------------------------------------------------------------
+	Dropped, coalesced and blocked counts of the thread-safe queues, summed
+	over all lanes (highWater is the highest of any lane)
+-----------------------------------------------------------------------------*/
+EventQueueStats EventManager::threadQueueStats() const
+{
+	EventQueueStats total = { 0 };
+	LONG numLanes = mNumThreadLanes;
+	for (LONG l = 0; l < numLanes; ++l) {
+		EventQueueStats qs = mThreadLanes[l]->stats();
+		total.pushed += qs.pushed;
+		total.dropped += qs.dropped;
+		total.coalesced += qs.coalesced;
+		total.blocked += qs.blocked;
+		total.overflowed += qs.overflowed;
+		if (qs.highWater > total.highWater) total.highWater = qs.highWater;
 	}
+	return total;
 }
 
 /*-----------------------------------------------------------------------------
@@ -126,88 +700,171 @@ void EventManager::raiseThreadSafe(const string &eventType)
 -----------------------------------------------------------------------------*/
 void EventManager::trigger(const EventPtr &ePtr)
 {
-	if (!isEventTypeRegistered((*ePtr).type())) {
+	EventTypeEntry *te = findRegistered((*ePtr).typeId());
+	if (!te) {
 		debugPrintf("EventMgr: cannot trigger \"%s\" event, not registered\n", (*ePtr).type().c_str());
 		return;
 	}
-	debugPrintf("EventMgr: \"%s\" event triggered\n", (*ePtr).type().c_str());
+	debugPrintf("EventMgr: \"%s\" event triggered\n", te->name.c_str());
 	(*ePtr).mState = EventState_Triggered;
 	(*ePtr).mTime = HighPerfTimer::queryCounts();
-	notifyListeners(ePtr);
+	ifEventProfiler(++te->stats.triggered;)
+	notifyListeners(ePtr, *te, false);
 }
 /*-----------------------------------------------------------------------------
 	Invoke listeners immediately, does not queue the no-data event.
 	This cannot be used to trigger events where the registered type
 	specifies "EventData_NotEmpty".
 -----------------------------------------------------------------------------*/
-void EventManager::trigger(const string &eventType)
+void EventManager::trigger(EventTypeId eventTypeId)
 {
-	RegEventMap::const_iterator ri = mRegEventMap.find(eventType);
-	if (ri != mRegEventMap.end()) {
-		_ASSERTE(ri->second->isEmpty() && "Cannot trigger non-empty event with this interface, use EventPtr interface");
-		if (ri->second->isEmpty()) {
-			EventPtr ePtr(new EmptyEvent(eventType));
-			debugPrintf("EventMgr: \"%s\" event triggered\n", eventType.c_str());
+	EventTypeEntry *te = findRegistered(eventTypeId);
+	if (te) {
+		_ASSERTE(te->regPtr->isEmpty() && "Cannot trigger non-empty event with this interface, use EventPtr interface");
+		if (te->regPtr->isEmpty()) {
+			EventPtr ePtr(makeEvent<PooledEmptyEvent>(te->name, eventTypeId));
+			debugPrintf("EventMgr: \"%s\" event triggered\n", te->name.c_str());
 			(*ePtr).mState = EventState_Triggered;
 			(*ePtr).mTime = HighPerfTimer::queryCounts();
-			notifyListeners(ePtr);
+			ifEventProfiler(++te->stats.triggered;)
+			notifyListeners(ePtr, *te, false);
 		} else {
 			// add message to release logging
 		}
 	} else {
-		debugPrintf("EventMgr: cannot trigger \"%s\" event, not registered\n", eventType.c_str());
+		debugPrintf("EventMgr: cannot trigger event id %u, not registered\n", eventTypeId);
 	}
 }
 
 /*-----------------------------------------------------------------------------
-	Run through the queue and notify listeners, then purge the queue
-	If maxMillis > 0, the loop will exit after time expires, and remaining
-	events will be processed next frame
+	Dispatches up to numToProcess events from the front of one lane, stopping
+	once the deadline (in timer counts, 0 for none) passes. Returns the number
+	processed, the rest stay at the front of the lane.
 -----------------------------------------------------------------------------*/
-void EventManager::notifyQueued(ulong maxMillis)
+uint EventManager::notifyQueueLane(EventQueue &queue, uint numToProcess, __int64 deadline)
 {
-	// This section handles all events pushed into the thread-safe queue. These are processed first
-	// to make sure we maximize concurrency, but it opens up the possibility of a thread spamming
-	// the event system, where events are added faster than they can be processed, causing the
-	// program stutter or hang. Can't do much about this case except design worker threads carefully
-	// to not send events too often.
+	uint numProcessed = 0;
 	EventPtr ePtr;
-	while (mThreadEventQueue->tryPop(ePtr)) {
-		notifyListeners(ePtr);
+	while (numProcessed < numToProcess) {
+		queue.pop_front(ePtr);
+		// registration was checked when raised, and entries are never removed
+		const EventTypeEntry *te = mTypeTable.find((*ePtr).typeId());
+		_ASSERTE(te && "Queued event raised without a type entry");
+		notifyListeners(ePtr, *te, true);
+		++numProcessed;
+		// if the deadline has passed, time to break out of the loop
+		if (deadline != 0 && (numProcessed % EVENTMGR_BUDGET_CHECK_INTERVAL) == 0 &&
+			HighPerfTimer::queryCounts() > deadline)
+		{
+			break;
+		}
+	}
+	return numProcessed;
+}
+
+/*-----------------------------------------------------------------------------
+	Run through the queue lanes and notify listeners, highest priority first.
+	The realtime lane is always drained. For the other lanes, if maxMillis > 0
+	(or the lane has its own budget) the loop will exit after time expires,
+	and remaining events will be processed next frame. Only the events already
+	queued on entry are processed, events raised by handlers go on the back of
+	their lane behind them, so there's no endless loop and no need to move
+	anything around when time runs out.
+-----------------------------------------------------------------------------*/
+void EventManager::notifyQueued(ulong maxMillis)
+{
+	// Listener snapshots taken from here on are held until after the concurrent batches have run,
+	// a worker thread removing a listener waits for that before it can destroy the listener
+	beginRead();
+
+	// This section handles events pushed into the thread-safe queues. These are processed first
+	// to make sure we maximize concurrency. A thread spamming the event system can't stall the
+	// frame: each lane is bounded, so past its capacity the worker is throttled or events are
+	// dropped or collapsed (by policy), and at most mThreadDrainBudget events are taken per frame,
+	// the rest wait at the front of their lanes for the next one. Events pushed by other threads
+	// while we're notifying also wait until next frame. The events are collected first, merged
+	// across lanes by time, so that coalesced types can be collapsed across the batch.
+	#if EVENT_PROFILER
+	uint queueDepth = 0;
+	for (int lane = 0; lane < EventPriority_NumLanes; ++lane) {
+		queueDepth += mEventQueues[lane].size();
+	}
+	mProfiler.beginFrame(queueDepth);
+	#endif
+	if (!mReplayer) {
+		drainThreadLanes();
+	} else {
+		// live thread events are dropped, the recorded frame fills the queues instead
+		LONG numLanes = mNumThreadLanes;
+		for (LONG l = 0; l < numLanes; ++l) {
+			mThreadLanes[l]->drain([](const EventPtr &) {});
+		}
+		replayFrame();
 	}
+	ifEventProfiler(mProfiler.threadDrained(static_cast<uint>(mThreadDrainBuffer.size()));)
+	if (!mThreadDrainBuffer.empty()) notifyThreadEvents();
 
-	// Now work on the regular event queue
-	// flip the active queue so any events raised while processing the current queue will not set up an endless loop
-	uint processQueue = mActiveQueue;
-	mActiveQueue = (mActiveQueue == 0) ? 1 : 0;
-	clearEventQueue(mActiveQueue); // make sure new active queue starts empty, but should already be empty
+	// scheduled events that have come due join the back of the queue and are handled this frame
+	expireTimers();
 
-	// run through the now inactive queue and notify listeners to handle each event
-	// may not reach end of queue if time expires
-	HighPerfTimer timer;
-	timer.start();
-	EventQueue::const_iterator	ei = mEventQueue[processQueue].begin(),
-								end = mEventQueue[processQueue].end();
-	int temp = 0;
-	while (ei != end) {
-		notifyListeners(*ei);
-		++temp;
-		++ei;
-		mEventQueue[processQueue].pop_front();
-		// if maxMillis is exceeded, time to break out of the loop
-		// timer.stop() is an expensive call, consider calling this conditional once per 10 events or something
-		if (timer.stop() > maxMillis && maxMillis != 0) break;
+	// Now work on the queue lanes, highest priority first. Only the events queued by this point are
+	// processed, events raised by handlers go on the back of their lane behind them, so there's no
+	// endless loop and no need to move anything around when time runs out. The realtime lane is
+	// always drained, the others stop at the frame deadline or their own budget, so it is the bulk
+	// lane that absorbs a spike. The deadlines are converted to timer counts once per lane, and the
+	// counter is only read every EVENTMGR_BUDGET_CHECK_INTERVAL events.
+	uint numToProcess[EventPriority_NumLanes];
+	for (int lane = 0; lane < EventPriority_NumLanes; ++lane) {
+		numToProcess[lane] = mEventQueues[lane].size();
+	}
+	__int64 frameDeadline = 0;
+	if (maxMillis > 0) {
+		frameDeadline = HighPerfTimer::queryCounts() + (static_cast<__int64>(maxMillis) * HighPerfTimer::timerFreq()) / 1000;
+	}
+	// everything recorded since the last marker is exactly what this frame is about to process
+	if (mRecorder && !mRecorder->append(EventLogRecord_Frame, 0, HighPerfTimer::queryCounts(), 0, 0)) {
+		stopRecording();
 	}
+	uint totalRolledOver = 0;
+	for (int lane = 0; lane < EventPriority_NumLanes; ++lane) {
+		if (numToProcess[lane] == 0) continue;
+		__int64 deadline = 0;
+		if (lane != EventPriority_Realtime) {
+			__int64 now = HighPerfTimer::queryCounts();
+			deadline = frameDeadline;
+			if (mQueueBudget[lane] > 0) {
+				__int64 laneDeadline = now + (static_cast<__int64>(mQueueBudget[lane]) * HighPerfTimer::timerFreq()) / 1000;
+				if (deadline == 0 || laneDeadline < deadline) deadline = laneDeadline;
+			}
+			if (deadline != 0 && now > deadline) deadline = -1; // out of time already, the whole lane waits
+		}
+		uint numProcessed = (deadline >= 0) ? notifyQueueLane(mEventQueues[lane], numToProcess[lane], deadline) : 0;
 
-	// if there are remaining events in the queue, push them to front of active queue so they'll be processed first next frame
-	// clears the inactive queue if not already empty
-	if (mEventQueue[processQueue].size() > 0) {
-		debugPrintf("%i queued events rolled over\n", mEventQueue[processQueue].size());
-		do {
-			mEventQueue[mActiveQueue].push_front(mEventQueue[processQueue].back());
-			mEventQueue[processQueue].pop_back();
-		} while (mEventQueue[processQueue].size() > 0);
+		// anything not processed is already at the front of its lane for next frame
+		if (numProcessed < numToProcess[lane]) {
+			debugPrintf("EventMgr: %u queued events rolled over in lane %d\n", numToProcess[lane] - numProcessed, lane);
+			totalRolledOver += numToProcess[lane] - numProcessed;
+		}
+	}
+	// coalesce entries only refer to queued events, once the queues are empty they can all go
+	if (!mCoalesceMap.empty()) {
+		bool allEmpty = true;
+		for (int lane = 0; allEmpty && lane < EventPriority_NumLanes; ++lane) {
+			allEmpty = mEventQueues[lane].empty();
+		}
+		if (allEmpty) {
+			// keep the per-type maps, the same types will coalesce again next frame
+			CoalesceMap::iterator ci, cend = mCoalesceMap.end();
+			for (ci = mCoalesceMap.begin(); ci != cend; ++ci) {
+				ci->second.clear();
+			}
+		}
 	}
+
+	// concurrent listeners have been collecting their share of the events above, run them now
+	dispatchConcurrent();
+	endRead(); // frees the snapshots retired this frame
+	ifEventProfiler(mProfiler.endFrame(totalRolledOver);)
 }
 
 /*-----------------------------------------------------------------------------
@@ -217,15 +874,17 @@ void EventManager::notifyQueued(ulong maxMillis)
 -----------------------------------------------------------------------------*/
 bool EventManager::registerEventType(const string &eventType, const RegEventPtr &regPtr)
 {
-	RegEventMap::iterator ri = mRegEventMap.find(eventType);
-	if (ri == mRegEventMap.end()) { // not yet registered, good
-		RegEventMapResult r = mRegEventMap.insert(RegEventMapValue(eventType, regPtr));
-		if (r.second) {
-			debugPrintf("EventMgr: event type \"%s\" registered\n", eventType.c_str());
-		} else {
-			debugPrintf("EventMgr: event type \"%s\" failed to register!\n", eventType.c_str());
-		}
-		return r.second;
+	EventTypeId eventTypeId = hashEventType(eventType);
+	EventTypeEntry *te = mTypeTable.findOrInsert(eventTypeId, eventType);
+	if (te->name != eventType) { // hash collision, findOrInsert has already asserted
+		debugPrintf("EventMgr: event type \"%s\" failed to register!\n", eventType.c_str());
+		return false;
+	}
+	if (!te->regPtr) { // not yet registered, good
+		te->regPtr = regPtr;
+		mTypeTable.setCategory(*te, regPtr->category());
+		debugPrintf("EventMgr: event type \"%s\" registered (id %u)\n", eventType.c_str(), eventTypeId);
+		return true;
 	}
 	// event type already registered, kick back
 	debugPrintf("EventMgr: failed to register event type \"%s\", already exists\n", eventType.c_str());
@@ -235,99 +894,175 @@ bool EventManager::registerEventType(const string &eventType, const RegEventPtr
 /*-----------------------------------------------------------------------------
 	Returns true if added, false if already exists, with priority (1 is highest
 	priority, 0 is no priority or FIFO order). If event type does not exist it
-	is added. An O(n) operation since it traverses the existing list for
-	duplicates.
+	is added. Safe from any thread and from inside a handler, a copy of the
+	listener list is published with the listener inserted, and a dispatch in
+	progress carries on with the old list, so the listener won't see the event
+	currently being handled. If a bound delegate is passed it is called
+	instead of the listener's handle function, as is a handler. For the
+	wildcard type, categories is the mask of event categories the listener is
+	called for.
 -----------------------------------------------------------------------------*/
-bool EventManager::registerListener(const string &eventType, EventListener *lPtr, uint priority)
+bool EventManager::registerListener(const string &eventType, EventListener *lPtr, uint priority,
+									const EventDelegate &delegate, const shared_ptr<IEventHandler> &handler,
+									EventCategoryMask categories)
 {
 	_ASSERTE(lPtr);
+	_ASSERTE(!inConcurrentBatch() && "listeners can't be registered from a concurrent handler");
+	if (inConcurrentBatch()) {
+		debugPrintf("EventMgr: listener \"%s\" for event type \"%s\" not registered, called from a concurrent batch\n", lPtr->name().c_str(), eventType.c_str());
+		return false;
+	}
 
-	EventTypeMap::iterator ei = mEventTypeMap.find(eventType);
-	if (ei == mEventTypeMap.end()) {	// event type does not exist yet, so add it and register the listener
-		EventTypeMapResult r = mEventTypeMap.insert(EventTypeMapValue(eventType, ListenerList()));
-		debugPrintf("EventMgr: event type \"%s\" created in listener map\n", eventType.c_str());
-		(*r.first).second.push_back(ListenerListValue(lPtr,priority));
-		debugPrintf("EventMgr: listener \"%s\" for event type \"%s\" registered with priority %d\n", lPtr->name().c_str(), eventType.c_str(), priority);
-		_ASSERTE(r.second == true);
-
-	} else { // event type exists, check that listener doesn't already exist
-		ListenerList::iterator	li, lPriorityInsert = (*ei).second.begin(),
-								end = (*ei).second.end();
-		for (li = (*ei).second.begin(); li != end; ++li) {
-			// 1) check the whole list to see if it's a repeat
-			if ((*li).first == lPtr) {
-				debugPrintf("EventMgr: listener \"%s\" for event type \"%s\" already exists, not registered\n", lPtr->name().c_str(), eventType.c_str());
-				return false;
-			}
-			// 2) find where it would be inserted if based on priority
-			if (((priority >= (*li).second) && ((*li).second != 0)) || (priority == 0)) ++lPriorityInsert;
-		}
-		if (priority == 0) { // just add to back of list for FIFO order
-			(*ei).second.push_back(ListenerListValue(lPtr,0));
-			debugPrintf("EventMgr: listener \"%s\" for event type \"%s\" registered with priority %d\n", lPtr->name().c_str(), eventType.c_str(), priority);
-		} else { // insert in priority order
-			(*ei).second.insert(lPriorityInsert, ListenerListValue(lPtr,priority));
-			debugPrintf("EventMgr: listener \"%s\" for event type \"%s\" registered with priority %d\n", lPtr->name().c_str(), eventType.c_str(), priority);
-		}
+	// creates the type entry if this is the first we've heard of it
+	EventTypeEntry *te = mTypeTable.findOrInsert(hashEventType(eventType), eventType);
+
+	// check that listener doesn't already exist
+	if (!mTypeTable.addListener(*te, lPtr, priority, delegate, handler, categories)) {
+		debugPrintf("EventMgr: listener \"%s\" for event type \"%s\" already exists, not registered\n", lPtr->name().c_str(), eventType.c_str());
+		return false;
 	}
+	// outside of dispatch on the main thread nothing can hold the old list
+	if (GetCurrentThreadId() == mMainThreadId && mDispatchDepth == 0) mTypeTable.reclaim();
+	debugPrintf("EventMgr: listener \"%s\" for event type \"%s\" registered with priority %d\n", lPtr->name().c_str(), eventType.c_str(), priority);
 
 	return true;
 }
 		
 /*-----------------------------------------------------------------------------
-	Removes a listener from an event type, if event type has no more listeners
-	it is removed
+	Removes a listener from an event type. The type entry itself is kept even
+	if it has no more listeners, entries are never removed from the table.
+	Safe from any thread and from inside a handler. The listener's slot is
+	nulled in the snapshots a dispatch may still be iterating. Off the main
+	thread this waits for the main thread to leave dispatch, so the caller
+	can destroy the listener as soon as it returns. From a concurrent batch
+	the removal is queued and done by dispatchConcurrent after the join, the
+	listener must outlive that (EventListener::clearHandlers enforces it).
 -----------------------------------------------------------------------------*/
 bool EventManager::removeListener(const string &eventType, EventListener *lPtr)
 {
 	_ASSERTE(lPtr);
+	if (inConcurrentBatch()) {
+		mutex::scoped_lock lock(mDeferredMutex);
+		mDeferredRemovals.push_back(std::make_pair(eventType, lPtr));
+		debugPrintf("EventMgr: listener \"%s\" for event type \"%s\" will be removed after the concurrent batches\n", lPtr->name().c_str(), eventType.c_str());
+		return true;
+	}
 
-	// check for event type in the map
-	EventTypeMap::iterator ei = mEventTypeMap.find(eventType);
-	if (ei == mEventTypeMap.end()) {
+	// check for event type in the table
+	EventTypeEntry *te = mTypeTable.find(hashEventType(eventType));
+	if (!te) {
 		debugPrintf("EventMgr: event type \"%s\" not found, listener \"%s\" not removed\n", eventType.c_str(), lPtr->name().c_str());
 		return false;
 	}
-
-	size_t startSize = (*ei).second.size();	// store size of the list before attempting a removal
-
-	// remove the matching listener in the event type's list
-	ListenerList::iterator li, end = (*ei).second.end();
-	for (li = (*ei).second.begin(); li != end; ++li) {
-		if ((*li).first == lPtr) {	// match
-			(*ei).second.erase(li);
-			debugPrintf("EventMgr: listener \"%s\" for event type \"%s\" removed\n", lPtr->name().c_str(), eventType.c_str());
-			break;
-		}
-	}
-	if ((*ei).second.size() == startSize) {
+	if (!mTypeTable.removeListener(*te, lPtr)) {
 		debugPrintf("EventMgr: listener \"%s\" for event type \"%s\" not found, not removed\n", lPtr->name().c_str(), eventType.c_str());
-		return false;	// listener not found for removal in the list
+		return false;	// listener not found for removal
 	}
 
-	// if the event type has no more listeners, it can be removed from the map
-	if ((*ei).second.size() == 0) {
-		mEventTypeMap.erase(ei);
-		debugPrintf("EventMgr: event type \"%s\" removed from listener map, no more listeners\n", eventType.c_str());
+	if (GetCurrentThreadId() == mMainThreadId) {
+		if (!lPtr->mConcurrentBatch.empty()) purgeConcurrent(lPtr, *te);
+		if (mDispatchDepth == 0) mTypeTable.reclaim();
+	} else {
+		// batches are run and cleared before the main thread leaves its read section
+		waitForReaders();
 	}
-	
-	return true;	
+	debugPrintf("EventMgr: listener \"%s\" for event type \"%s\" removed\n", lPtr->name().c_str(), eventType.c_str());
+	return true;
+}
+
+/*-----------------------------------------------------------------------------
+	Writes the dispatch timeline of the next notifyQueued call to a file in
+	Chrome trace JSON format
+-----------------------------------------------------------------------------*/
+void EventManager::captureEventTrace(const string &filename)
+{
+	#if EVENT_PROFILER
+	mProfiler.captureNextFrame(filename);
+	#else
+	debugPrintf("EventMgr: cannot capture \"%s\", EVENT_PROFILER is disabled\n", filename.c_str());
+	#endif
+}
+
+/*-----------------------------------------------------------------------------
+	Prints queue, per-type and per-listener stats to the debug console. A
+	listener registered for several types is only reported once.
+-----------------------------------------------------------------------------*/
+void EventManager::printEventStats() const
+{
+	EventQueueStats qs = threadQueueStats();
+	debugPrintf("EventMgr: %d thread queues pushed %u, dropped %u, coalesced %u, blocked %u, overflowed %u, high water %u\n",
+		mNumThreadLanes, qs.pushed, qs.dropped, qs.coalesced, qs.blocked, qs.overflowed, qs.highWater);
+	#if EVENT_PROFILER
+	mProfiler.printFrameStats();
+	ListenerSet reported;
+	const EventProfiler &profiler = mProfiler;
+	mTypeTable.forEach([&](const EventTypeEntry &e) {
+		profiler.printTypeStats(e.name, e.stats);
+		const ListenerList &list = *e.listeners;
+		ListenerList::const_iterator li, end = list.end();
+		for (li = list.begin(); li != end; ++li) {
+			EventListener *lPtr = li->listener;
+			if (lPtr && reported.insert(lPtr).second) {
+				profiler.printListenerStats(lPtr->name(), lPtr->latency());
+			}
+		}
+	});
+	#endif
 }
 
 EventManager::EventManager() :
 	Singleton<EventManager>(*this),
-	mActiveQueue(0),
-	mThreadEventQueue(new ThreadSafeEventQueue()),
-	mEventSnooper(new EventSnooper())
+	mEventPool(),
+	mTypeTable(),
+	mWildcardEntry(0),
+	mDispatchDepth(0),
+	mReadEpoch(0),
+	mCoalesceMap(),
+	mNumThreadLanes(0),
+	mThreadLaneMutex(),
+	mThreadLaneGen(InterlockedIncrement(&sThreadLaneGen)),
+	mMainThreadId(GetCurrentThreadId()),
+	mThreadCapacity(EVENTMGR_THREAD_QUEUE_CAPACITY),
+	mThreadPolicy(EventOverflow_Block),
+	mThreadDrainBudget(EVENTMGR_THREAD_DRAIN_BUDGET),
+	mThreadDrainBuffer(),
+	mThreadCoalesceMap(),
+	mConcurrentPending(),
+	mDeferredRemovals(),
+	mDeferredMutex(),
+	mTimerWheel(),
+	mTimerBase(HighPerfTimer::queryCounts()),
+	mRecorder(0),
+	mReplayer(0),
+	mRecordBuffer(),
+	mEventSnooper(0)
 {
+	for (int lane = 0; lane < EventPriority_NumLanes; ++lane) {
+		mQueueBudget[lane] = 0;
+	}
+	// the main thread takes lane 0, which is also the shared lane once the others run out
+	threadLane();
+
+	// the wildcard entry must exist before any listener (including the snooper) registers
+	mWildcardEntry = mTypeTable.findOrInsert(EventListener::sWildcardTypeId, EventListener::sWildcardType);
+	mTypeTable.setWildcardEntry(mWildcardEntry);
+	mEventSnooper = new EventSnooper();
 }
 
 EventManager::~EventManager()
 {
-	clearEventQueue(0);
-	clearEventQueue(1);
+	for (int lane = 0; lane < EventPriority_NumLanes; ++lane) {
+		mEventQueues[lane].clear();
+	}
+	mCoalesceMap.clear();
+	mTimerWheel.clear();
+	stopRecording();
+	stopReplay();
+	printEventStats(); // before the listeners go away
 	delete mEventSnooper;
-	delete mThreadEventQueue;
+	for (LONG l = 0; l < mNumThreadLanes; ++l) {
+		delete mThreadLanes[l];
+	}
 	clearListeners();
 	debugPrintf("EventMgr: created %d events, destroyed %d\n", Event::sNumEventsCreated, Event::sNumEventsDestroyed);
 }
@@ -346,8 +1081,8 @@ bool EventSnooper::handleAllEvents(const EventPtr &ePtr)
 	return false;
 }*/
 
-EventSnooper::EventSnooper() :
-	EventListener("EventSnooper")
+EventSnooper::EventSnooper(EventCategoryMask categories) :
+	EventListener("EventSnooper", true) // only logs, so it can run concurrently
 {
 	// here we don't register the specific handler because doing so would cause a duplicate
 	// event notification to be sent to this listener for the same event, one for the generic
@@ -356,9 +1091,9 @@ EventSnooper::EventSnooper() :
 /*	IEventHandlerPtr p1(new EventHandler<EventSnooper>(this, &EventSnooper::handleSpecificEvent));
 	insertEventHandler("EVENT_SPECIFIC", p1);
 */
-	// register the wildcard event with EventManager
+	// register the wildcard event with EventManager, for the categories asked for
 	IEventHandlerPtr p(new EventHandler<EventSnooper>(this, &EventSnooper::handleAllEvents));
-	registerEventHandler(EventListener::sWildcardType, p);
+	registerWildcardHandler(p, categories);
 }
 
 EventSnooper::~EventSnooper()
@@ -1,7 +1,7 @@
 /*----==== EVENTMANAGER.H ====----
 	Author:		Jeffrey Kiah
 	Orig.Date:	07/23/2007
-	Rev.Date:	05/04/2009
+	Rev.Date:	10/17/2026
 
 Event System notes:
 	The event system is central to the engine, it is used for communication between all subsystems.
@@ -21,27 +21,75 @@ Features:
 	* Event Listeners auto-register themselves with the manager when instantiated
 	* Event Handlers auto-register with Listeners
 	* Event Handlers can be prioritized so events are handled in the correct order, else FIFO
+	* Event types can opt in to coalescing (RegisteredEvent::setCoalesceKeyFunc), so a newly raised
+		event replaces a queued one with the same key rather than both being handled
+	* Listeners for each type are kept in a contiguous priority-sorted array, published as an
+		immutable snapshot (read-copy-update), so listeners can be added or removed from inside
+		handlers or from any thread while dispatch reads the arrays without a lock
+	* Event types belong to categories (RegisteredEvent::setCategory) and wildcard listeners can
+		subscribe to a category mask (EventListener::registerWildcardHandler). Each type keeps its
+		own precomputed list of the wildcard listeners that want it, so a wildcard listener costs
+		nothing for events outside its categories
+	* Listeners can subscribe typed member functions (EventListener::subscribe), which are stored
+		as inline delegates in the listener arrays and called without a functor allocation, a
+		virtual call or a handler map lookup
+	* Events can be raised at a time or after a delay (raiseAt/raiseAfter, also from script). They
+		wait in a hierarchical timer wheel that notifyQueued advances each frame, so the cost of
+		pending timers doesn't grow with their number (see EventTimerWheel)
+	* Raised events go in one of three queue lanes by type (RegisteredEvent::setPriority). The
+		realtime lane is always drained each frame, normal and bulk run within the frame's time
+		budget (bulk optionally within its own, see setQueueBudget), so a load spike rolls bulk
+		events over to the next frame instead of delaying input
 	* Handlers can consume events to prevent further propagation
 	* Wildcard listeners see all events, and can handle them via generic or type-specific handlers
 	* Events cannot be fired until their type has been registered
 	* Events types include code-only, code/script, and script-defined
 	* Listeners can be safely registered before corresponding event type is registered (eliminates
 		order of creation issues)
+	* Event types are interned as integer EventTypeIds (see EventTypeId.h), dispatch never hashes
+		strings. The string interfaces remain as thin shims for script and debugging.
+	* Events created with makeEvent and the manager's own empty events are allocated from EventPool,
+		and the event queue is a ring buffer, so high-frequency events don't touch the heap
+	* Listeners that declare themselves concurrent have their queued events batched and handled on
+		the JobSystem's workers in parallel at the end of notifyQueued (see EventListener)
+	* The thread-safe queue is bounded (worker threads raising into a full queue block briefly, or
+		the oldest or superseded events are dropped, by policy) and drained up to a budget each
+		frame, so a burst from a worker spreads over several frames instead of stalling one
+	* Each thread that calls raiseThreadSafe gets its own queue (a lane), found through a thread
+		local pointer, so worker threads never contend with each other. The lanes are merged in
+		timestamp order at the start of notifyQueued.
+	* Request/response events (RequestEvent, see EventFuture.h) let a worker thread ask the main
+		thread a question without blocking either side, the answer comes back through a future that
+		can be polled, waited on or given a continuation
+	* Raised events can be recorded to a memory-mapped log and replayed frame by frame, for
+		deterministic replays when profiling (see EventLog and EventSerialization.h)
+	* Per-type counts, queue depth, rollovers and per-listener handler latency are recorded, and a
+		frame's dispatch timeline can be captured as a Chrome trace (see EventProfiler, which can be
+		compiled out)
 --------------------------------*/
 
 #pragma once
 
 #include <string>
 #include <list>
+#include <vector>
 #include <hash_map>
 #include "EventListener.h"
 #include "Event.h"
+#include "EventTypeId.h"
+#include "EventTypeTable.h"
+#include "EventPool.h"
+#include "EventProfiler.h"
+#include "EventLog.h"
+#include "EventTimerWheel.h"
+#include "BoundedEventQueue.h"
+#include "../Utility/RingQueue.h"
 #include "../Utility/Typedefs.h"
 #include "../Utility/Singleton.h"
 
 using std::string;
 using std::list;
-using std::pair;
+using std::vector;
 using stdext::hash_map;
 
 ///// DEFINITIONS /////
@@ -50,8 +98,11 @@ using stdext::hash_map;
 #define events		EventManager::instance()
 #define eventMgr	EventManager::instance()
 
-template<typename T> class ConcurrentQueue;
-typedef ConcurrentQueue<EventPtr>	ThreadSafeEventQueue;
+#define EVENTMGR_BUDGET_CHECK_INTERVAL	16	// notifyQueued reads the clock once per this many events
+
+#define EVENTMGR_THREAD_QUEUE_CAPACITY	4096	// raiseThreadSafe blocks a worker thread beyond this many of its events waiting
+#define EVENTMGR_THREAD_DRAIN_BUDGET	1024	// most thread-safe events dispatched per notifyQueued, 0 for all
+#define EVENTMGR_MAX_THREAD_LANES		32		// threads with their own queue, later threads share the main thread's
 
 ///// STRUCTURES /////
 
@@ -60,57 +111,232 @@ class EventSnooper;
 /*=============================================================================
 class EventManager
 	The central manager for the event system. Has an event queue that keeps
-	raised events to be processed each frame. Event registration and listener
-	maps are kept separately so that listeners may be registered for events
-	types event before they have been registered.
+	raised events to be processed each frame. Event registration and listeners
+	share one entry per type in the EventTypeTable, but an entry can exist
+	without a registration so that listeners may be registered for event
+	types before they have been registered.
 =============================================================================*/
 class EventManager : public Singleton<EventManager> {
 	private:
 		///// DEFINITIONS /////
 
-		typedef pair<EventListener*, uint>			ListenerListValue;	// pairs the listener pointer with priority
-		typedef list<ListenerListValue>				ListenerList;		// stores listeners along with their priority
-		typedef pair<string, ListenerList>			EventTypeMapValue;	// value pair of the event type map
-		typedef hash_map<string, ListenerList>		EventTypeMap;		// hash_map to store lists of event listeners
-		typedef pair<EventTypeMap::iterator, bool>	EventTypeMapResult;	// result of inserting elements into the event type map
-		typedef pair<string, RegEventPtr>			RegEventMapValue;	// value pair of the event registration map
-		typedef hash_map<string, RegEventPtr>		RegEventMap;		// hash_map to store lists of event registrations
-		typedef pair<RegEventMap::iterator, bool>	RegEventMapResult;	// result of inserting elements into event registration map
-		typedef list<EventPtr>						EventQueue;
+		typedef RingQueue<EventPtr>	EventQueue;
+
+		typedef hash_map<uint64, uint>					CoalesceKeyMap;	// coalesce key to queue sequence or buffer index
+		typedef hash_map<EventTypeId, CoalesceKeyMap>	CoalesceMap;	// by type id, so keys of different types never mix
 
 		// add a type returned by listeners for consumed vs. not consumed (allowing further notifications of the event)
 		// so a high priority listener may choose to consume an event before others are notified
 
 		///// VARIABLES /////
 
-		RegEventMap		mRegEventMap;		// maps registration types to event types
-		EventTypeMap	mEventTypeMap;		// maps listeners to their event types
-		EventQueue		mEventQueue[2];		// double-buffered list of events that have been raised
-		uint			mActiveQueue;		// the active event queue is written to while the inactive queue is being processed
+		EventPool			mEventPool;			// must be first so it outlives everything below that holds pooled events
+		EventTypeTable		mTypeTable;			// registrations and listeners for each event type, indexed by EventTypeId
+		EventTypeEntry *	mWildcardEntry;		// wildcard listeners, kept aside so dispatch never has to look them up
+		EventQueue			mEventQueues[EventPriority_NumLanes];	// raised events, one queue per priority lane.
+												// Events raised while processing go on the back and wait for
+												// the next frame, as do any left over when time runs out
+		ulong				mQueueBudget[EventPriority_NumLanes];	// per lane cap in ms, 0 for only maxMillis
+
+		EventSnooper		*mEventSnooper;		// built-in wildcard event listener
+
+		CoalesceMap			mCoalesceMap;		// queued events of coalesced types, by key, a sequence in the
+												// type's lane
+
+		// Thread-safe queue lanes, one per raising thread. Lane 0 belongs to the main thread and is
+		// shared by any threads past EVENTMGR_MAX_THREAD_LANES (the queues take multiple producers,
+		// so sharing is safe, just not contention free). Lanes are only added, never removed, so
+		// the main thread reads them without the lock.
+		ThreadSafeEventQueue	*mThreadLanes[EVENTMGR_MAX_THREAD_LANES];
+		volatile LONG			mNumThreadLanes;	// published after the lane is stored
+		mutex					mThreadLaneMutex;	// taken once per thread, when its lane is created
+		LONG					mThreadLaneGen;		// tells thread local lane pointers from a previous manager apart
+		DWORD					mMainThreadId;		// consumer of every lane
+		uint					mThreadCapacity;	// capacity and policy for each lane
+		EventOverflowPolicy		mThreadPolicy;
+		uint					mThreadDrainBudget;	// most thread events dispatched per notifyQueued, 0 for all
+		vector<EventPtr>		mThreadDrainBuffer;	// events drained from the lanes this frame, in time order
+		CoalesceMap				mThreadCoalesceMap;	// latest drained event index for each coalesced key
+
+		// Listener lists are read-copy-update snapshots (see EventTypeTable), read only by the main
+		// thread. mReadEpoch is odd while the main thread is reading them, so a thread removing a
+		// listener can wait until the main thread is done with the old list before it returns.
+		uint				mDispatchDepth;		// nesting depth of read sections on the main thread
+		volatile LONG		mReadEpoch;			// incremented entering and leaving the outermost read section
+
+		vector<EventListener*>	mConcurrentPending;		// concurrent listeners with a non-empty batch this frame
+		vector<std::pair<string, EventListener*> >	mDeferredRemovals;	// removeListener calls made from concurrent batches
+		mutex					mDeferredMutex;			// guards mDeferredRemovals while the batches run
 
-		EventSnooper	*mEventSnooper;		// built-in wildcard event listener
+		EventTimerWheel		mTimerWheel;		// events scheduled by raiseAt and raiseAfter, in 1ms ticks
+		__int64				mTimerBase;			// HighPerfTimer counts at tick 0
 
-		ThreadSafeEventQueue	*mThreadEventQueue;	// thread-safe event queue, used for inter-thread events
+		ifEventProfiler(EventProfiler mProfiler;)		// frame stats and trace capture, see EventProfiler.h
+
+		EventRecorder *			mRecorder;			// non-null while recording raised events to a log
+		EventReplayer *			mReplayer;			// non-null while replaying a log
+		vector<char>			mRecordBuffer;		// scratch for serializing one event
 
 		///// FUNCTIONS /////
 
 		/*---------------------------------------------------------------------
 			Cleanup for when manager is destroyed or being reset
 		---------------------------------------------------------------------*/
-		void	clearListeners() { mEventTypeMap.clear(); }
+		void	clearListeners() {
+					mTypeTable.clearListeners();
+					mTypeTable.reclaim();
+				}
 
 		/*---------------------------------------------------------------------
-			Purge event queue (usually done each frame, called by notifyQueued)
+			Brackets main thread code that holds on to listener snapshots.
+			Nests, only the outermost pair changes mReadEpoch. Leaving the
+			outermost section frees the retired snapshots.
 		---------------------------------------------------------------------*/
-		void	clearEventQueue(uint queueToClear) {
-					_ASSERTE(queueToClear == 0 || queueToClear == 1);
-					mEventQueue[queueToClear].clear();
+		void	beginRead() {
+					if (mDispatchDepth++ == 0) InterlockedIncrement(&mReadEpoch);
+				}
+		void	endRead() {
+					if (--mDispatchDepth == 0) {
+						InterlockedIncrement(&mReadEpoch);
+						if (mTypeTable.hasRetired()) mTypeTable.reclaim();
+					}
 				}
 
 		/*---------------------------------------------------------------------
-			Notifies listeners of a single event raised or triggered
+			Called off the main thread after publishing a removal, returns once
+			the main thread can no longer be calling into the removed listener
+		---------------------------------------------------------------------*/
+		void	waitForReaders() const;
+
+		/*---------------------------------------------------------------------
+			Stamps a raised event and adds it to the queue, or replaces the
+			queued event with the same key for coalesced event types
+		---------------------------------------------------------------------*/
+		void	queueEvent(const EventPtr &ePtr, const EventTypeEntry &entry);
+
+		/*---------------------------------------------------------------------
+			Dispatches up to numToProcess events from the front of one lane,
+			stopping once the deadline (in timer counts, 0 for none) passes.
+			Returns the number processed.
+		---------------------------------------------------------------------*/
+		uint	notifyQueueLane(EventQueue &queue, uint numToProcess, __int64 deadline);
+
+		/*---------------------------------------------------------------------
+			Returns the calling thread's lane, creating it on the thread's
+			first raiseThreadSafe
+		---------------------------------------------------------------------*/
+		ThreadSafeEventQueue &	threadLane();
+
+		/*---------------------------------------------------------------------
+			Drains every lane into mThreadDrainBuffer, merging them in
+			timestamp order. The budget is shared out in rounds between the
+			lanes that still have events, unused shares go to the rest.
+		---------------------------------------------------------------------*/
+		void	drainThreadLanes();
+
+		/*---------------------------------------------------------------------
+			Dispatches everything drained from the thread-safe queue, keeping
+			only the latest event per key for coalesced event types
+		---------------------------------------------------------------------*/
+		void	notifyThreadEvents();
+
+		/*---------------------------------------------------------------------
+			Serializes an event into the log being recorded. Events of types
+			that aren't serializable are skipped.
+		---------------------------------------------------------------------*/
+		void	recordEvent(const EventPtr &ePtr, const EventTypeEntry &entry, EventLogRecordKind kind);
+
+		/*---------------------------------------------------------------------
+			Feeds the next recorded frame from the log being replayed into the
+			queues, stops the replay at the end of the log
+		---------------------------------------------------------------------*/
+		void	replayFrame();
+
+		/*---------------------------------------------------------------------
+			Notifies listeners of a single event raised or triggered, the
+			caller passes in the type entry it has already looked up. When
+			deferConcurrent is true, concurrent listeners get the event added
+			to their batch instead of being called.
+		---------------------------------------------------------------------*/
+		void	notifyListeners(const EventPtr &ePtr, const EventTypeEntry &entry, bool deferConcurrent);
+
+		/*---------------------------------------------------------------------
+			Calls the listener's typed delegate if it subscribed with one, its
+			registered handler if it has one, or its handle function otherwise
+		---------------------------------------------------------------------*/
+		static bool	invokeListener(const ListenerListValue &slot, const EventPtr &ePtr) {
+						if (slot.delegate.isBound()) return slot.delegate(*ePtr);
+						if (slot.handler) return (*slot.handler)(ePtr);
+						return slot.listener->handle(ePtr);
+					}
+
+		/*---------------------------------------------------------------------
+			Calls the listener's handler, timing it when the profiler is
+			compiled in. Returns true if the event was consumed.
+		---------------------------------------------------------------------*/
+		bool	callListener(const ListenerListValue &slot, const EventPtr &ePtr, const EventTypeEntry &entry) {
+					#if EVENT_PROFILER
+					uint64 start = EventProfiler::now();
+					bool consumed = invokeListener(slot, ePtr);
+					uint64 end = EventProfiler::now();
+					slot.listener->mLatency.add(end - start);
+					if (mProfiler.capturing()) mProfiler.addSpan(slot.listener->name(), entry.name, start, end);
+					return consumed;
+					#else
+					return invokeListener(slot, ePtr);
+					#endif
+				}
+
+		/*---------------------------------------------------------------------
+			Adds an event to a concurrent listener's batch for this frame
+		---------------------------------------------------------------------*/
+		void	deferToConcurrent(const ListenerListValue &slot, const EventPtr &ePtr) {
+					EventListener *lPtr = slot.listener;
+					if (lPtr->mConcurrentBatch.empty()) mConcurrentPending.push_back(lPtr);
+					lPtr->mConcurrentBatch.push_back(EventListener::ConcurrentBatchItem(ePtr, slot.delegate, slot.handler));
+				}
+
+		/*---------------------------------------------------------------------
+			Runs every pending concurrent batch as a job and waits for them
+			to finish, or runs them in turn if there is no JobSystem
+		---------------------------------------------------------------------*/
+		void	dispatchConcurrent();
+
+		/*---------------------------------------------------------------------
+			Drops events of one type (or all, for the wildcard) from a
+			listener's pending batch, used when the listener is removed
 		---------------------------------------------------------------------*/
-		void	notifyListeners(const EventPtr &ePtr) const;
+		void	purgeConcurrent(EventListener *lPtr, const EventTypeEntry &entry);
+
+		/*---------------------------------------------------------------------
+			Job function, handles one listener's batch in order
+		---------------------------------------------------------------------*/
+		static void	runConcurrentBatch(void *param);
+
+		/*---------------------------------------------------------------------
+			Coalesce key function for the thread-safe queue, gives events of
+			coalesced types the same key as the main queue uses
+		---------------------------------------------------------------------*/
+		static bool	threadCoalesceKey(const EventPtr &ePtr, uint64 &outGroup, uint64 &outKey);
+
+		/*---------------------------------------------------------------------
+			Converts HighPerfTimer counts to timer wheel ticks. Expire times
+			round up so a scheduled event is never raised early.
+		---------------------------------------------------------------------*/
+		uint64	countsToTick(__int64 counts, bool roundUp) const;
+
+		/*---------------------------------------------------------------------
+			Queues every scheduled event that has come due
+		---------------------------------------------------------------------*/
+		void	expireTimers();
+
+		/*---------------------------------------------------------------------
+			Returns the type entry only if the event type has been registered
+		---------------------------------------------------------------------*/
+		EventTypeEntry *	findRegistered(EventTypeId eventTypeId) const {
+								EventTypeEntry *e = mTypeTable.find(eventTypeId);
+								return (e && e->regPtr) ? e : 0;
+							}
 
 	public:
 		/*---------------------------------------------------------------------
@@ -121,9 +347,36 @@ class EventManager : public Singleton<EventManager> {
 		/*---------------------------------------------------------------------
 			Add a no-data event to the queue, queue is processed each frame.
 			This cannot be used to trigger events where the registered type
-			specifies "EventData_NotEmpty".
+			specifies "EventData_NotEmpty". The string version is a shim that
+			hashes the type name.
 		---------------------------------------------------------------------*/
-		void	raise(const string &eventType);
+		void	raise(EventTypeId eventTypeId);
+		void	raise(const string &eventType) { raise(hashEventType(eventType)); }
+
+		/*---------------------------------------------------------------------
+			Raises the event at a time in HighPerfTimer counts, the same clock
+			as Event::time. It is queued by the first notifyQueued at or after
+			that time (to 1ms resolution) and handled like any raised event.
+			Returns an id for cancelTimer, or 0 if the event can't be raised.
+		---------------------------------------------------------------------*/
+		EventTimerId	raiseAt(const EventPtr &ePtr, __int64 timeCounts);
+		EventTimerId	raiseAt(EventTypeId eventTypeId, __int64 timeCounts);
+
+		/*---------------------------------------------------------------------
+			Raises the event delayMillis from now, see raiseAt
+		---------------------------------------------------------------------*/
+		EventTimerId	raiseAfter(const EventPtr &ePtr, ulong delayMillis);
+		EventTimerId	raiseAfter(EventTypeId eventTypeId, ulong delayMillis);
+		EventTimerId	raiseAfter(const string &eventType, ulong delayMillis) {
+							return raiseAfter(hashEventType(eventType), delayMillis);
+						}
+
+		/*---------------------------------------------------------------------
+			Cancels a scheduled event that hasn't been raised yet, returns
+			false if it already has or the id is unknown
+		---------------------------------------------------------------------*/
+		bool	cancelTimer(EventTimerId timerId) { return mTimerWheel.cancel(timerId); }
+		uint	numPendingTimers() const { return mTimerWheel.numPending(); }
 
 		/*---------------------------------------------------------------------
 			Invoke listeners immediately, does not queue the event
@@ -135,13 +388,31 @@ class EventManager : public Singleton<EventManager> {
 			This cannot be used to trigger events where the registered type
 			specifies "EventData_NotEmpty".
 		---------------------------------------------------------------------*/
-		void	trigger(const string &eventType);
+		void	trigger(EventTypeId eventTypeId);
+		void	trigger(const string &eventType) { trigger(hashEventType(eventType)); }
 
 		/*---------------------------------------------------------------------
-			Run through the queue and notify listeners, then purge the queue
+			Run through the queue lanes and notify listeners, highest priority
+			first. The realtime lane is always drained. For the others, if
+			maxMillis > 0 the time is checked every
+			EVENTMGR_BUDGET_CHECK_INTERVAL events, and whatever is left stays
+			at the front of its lane for next frame.
 		---------------------------------------------------------------------*/
 		void	notifyQueued(ulong maxMillis);
 
+		/*---------------------------------------------------------------------
+			Caps the time one lane may take in notifyQueued, on top of the
+			maxMillis passed to it, so for example bulk events can be held
+			to a couple of ms even in a frame with time to spare. 0, the
+			default, leaves the lane limited only by maxMillis. The realtime
+			lane can't have a budget.
+		---------------------------------------------------------------------*/
+		void	setQueueBudget(EventPriority lane, ulong maxMillis) {
+					_ASSERTE(lane != EventPriority_Realtime && lane < EventPriority_NumLanes);
+					if (lane != EventPriority_Realtime) mQueueBudget[lane] = maxMillis;
+				}
+		uint	numQueued(EventPriority lane) const { return mEventQueues[lane].size(); }
+
 		/*---------------------------------------------------------------------
 			Registers an event type so that it may be triggered or raised. The
 			RegisteredEvent implementation will determine if the event can be
@@ -153,37 +424,106 @@ class EventManager : public Singleton<EventManager> {
 		/*---------------------------------------------------------------------
 			Returns a shared ptr to RegisteredEvent metadata for an event type
 		---------------------------------------------------------------------*/
-		RegEventPtr getRegEventPtr(const string &eventType) const {
-					RegEventMap::const_iterator ri = mRegEventMap.find(eventType);
-					if (ri != mRegEventMap.end()) return RegEventPtr(ri->second);
-					return RegEventPtr(); // return a null internal pointer if not found
-				}
+		RegEventPtr getRegEventPtr(EventTypeId eventTypeId) const {
+						EventTypeEntry *e = mTypeTable.find(eventTypeId);
+						if (e) return e->regPtr;
+						return RegEventPtr(); // return a null internal pointer if not found
+					}
+		RegEventPtr getRegEventPtr(const string &eventType) const { return getRegEventPtr(hashEventType(eventType)); }
 
 		/*---------------------------------------------------------------------
 			Returns true if event type has already been registered in the
 			RegisteredEvent table (doesn't care about listener table)
 		---------------------------------------------------------------------*/
-		bool	isEventTypeRegistered(const string &eventType) const { return (mRegEventMap.find(eventType) != mRegEventMap.end()); }
+		bool	isEventTypeRegistered(EventTypeId eventTypeId) const { return (findRegistered(eventTypeId) != 0); }
+		bool	isEventTypeRegistered(const string &eventType) const { return isEventTypeRegistered(hashEventType(eventType)); }
 		
 		/*---------------------------------------------------------------------
 			Returns true if added, false if already exists, with priority
 			(1 is highest priority, 0 is no priority or FIFO order).
-			If event type does not exist it is added. An O(n) operation since
-			it traverses the existing list for duplicates.
+			If event type does not exist it is added. Safe from any thread and
+			from inside a handler, except a concurrent listener's (refused,
+			see inConcurrentBatch): a new listener list is published, and a
+			dispatch already in progress finishes with the old one, so the
+			listener won't see the event currently being handled. If a bound
+			delegate is passed it is called instead of the listener's handle
+			function, as is a handler. For the wildcard type, categories is
+			the mask of event categories the listener is called for.
 		---------------------------------------------------------------------*/
-		bool	registerListener(const string &eventType, EventListener *lPtr, uint priority = 0);
+		bool	registerListener(const string &eventType, EventListener *lPtr, uint priority = 0,
+								 const EventDelegate &delegate = EventDelegate(),
+								 const shared_ptr<IEventHandler> &handler = shared_ptr<IEventHandler>(),
+								 EventCategoryMask categories = EventCategory_All);
 		
 		/*---------------------------------------------------------------------
-			Removes a listener from an event type, if event type has no
-			more listeners it is removed
+			Removes a listener from an event type. Safe from any thread and
+			from inside a handler. The listener is not called again once this
+			returns. Off the main thread, that means waiting for the main
+			thread to finish dispatching if it is. From a concurrent
+			listener's batch the removal is deferred until the batches have
+			joined instead (see inConcurrentBatch), until then the listener
+			may still be called and must not be destroyed.
 		---------------------------------------------------------------------*/
 		bool	removeListener(const string &eventType, EventListener *lPtr);
 
+		/*---------------------------------------------------------------------
+			True on a thread that is running a concurrent listener's batch,
+			where listeners can't be registered and removal is deferred
+		---------------------------------------------------------------------*/
+		static bool	inConcurrentBatch();
+
 		/*---------------------------------------------------------------------
 			Multithread safe raise methods
 		---------------------------------------------------------------------*/
 		void	raiseThreadSafe(const EventPtr &ePtr);
-		void	raiseThreadSafe(const string &eventType);
+		void	raiseThreadSafe(EventTypeId eventTypeId);
+		void	raiseThreadSafe(const string &eventType) { raiseThreadSafe(hashEventType(eventType)); }
+
+		/*---------------------------------------------------------------------
+			Sets the capacity (0 for unbounded) and overflow policy of each
+			thread's queue, and how many thread events are dispatched per
+			notifyQueued (0 for all). Call before worker threads start raising.
+		---------------------------------------------------------------------*/
+		void	setThreadQueueLimits(uint capacity, EventOverflowPolicy policy, uint drainBudget);
+
+		/*---------------------------------------------------------------------
+			Dropped, coalesced and blocked counts of the thread-safe queues,
+			summed over all lanes (highWater is the highest of any lane)
+		---------------------------------------------------------------------*/
+		EventQueueStats	threadQueueStats() const;
+
+		/*---------------------------------------------------------------------
+			Writes the dispatch timeline of the next notifyQueued call to a
+			file in Chrome trace JSON format. Does nothing if the profiler is
+			compiled out (EVENT_PROFILER 0).
+		---------------------------------------------------------------------*/
+		void	captureEventTrace(const string &filename);
+
+		/*---------------------------------------------------------------------
+			Prints queue, per-type and per-listener stats to the debug console.
+			Also done when the manager is destroyed.
+		---------------------------------------------------------------------*/
+		void	printEventStats() const;
+
+		/*---------------------------------------------------------------------
+			Records every raised event (including thread-safe raises) to a
+			memory-mapped log file, with a marker each frame. Only event types
+			registered as serializable are recorded, see
+			RegisteredEvent::setReadEventFunc. Can't record during a replay.
+		---------------------------------------------------------------------*/
+		bool	startRecording(const string &filename);
+		void	stopRecording();
+		bool	isRecording() const { return (mRecorder != 0); }
+
+		/*---------------------------------------------------------------------
+			Replays a recorded log, one recorded frame per notifyQueued call,
+			until the end of the log. While replaying, events raised live
+			(including thread-safe raises) are dropped, so listeners see
+			exactly the recorded stream. Triggered events are unaffected.
+		---------------------------------------------------------------------*/
+		bool	startReplay(const string &filename);
+		void	stopReplay();
+		bool	isReplaying() const { return (mReplayer != 0); }
 
 		// Constructor / Destructor
 		explicit EventManager();
@@ -195,7 +535,9 @@ class EventSnooper
 	This listener uses the wildcard to receive all events. The return value of
 	handleAllEvents is irrelevant in this case, and listener priority is unique
 	to the wildcard listener list. Wildcard listeners are always processed
-	before the specific listeners for each event.
+	before the specific listeners for each event. The snooper is a concurrent
+	listener, so queued events are logged from a worker thread. It can be
+	limited to some event categories, it isn't called for the others at all.
 =============================================================================*/
 class EventSnooper : public EventListener {
 	private:
@@ -203,6 +545,6 @@ class EventSnooper : public EventListener {
 		bool	handleAllEvents(const EventPtr &ePtr);
 
 	public:
-		explicit EventSnooper();
+		explicit EventSnooper(EventCategoryMask categories = EventCategory_All);
 		virtual ~EventSnooper();
 };
\ No newline at end of file
@@ -0,0 +1,60 @@
+/*----==== EVENTPOOL.CPP ====----
+	Author:		Jeff Kiah
+	Orig.Date:	10/17/2026
+	Rev.Date:	10/17/2026
+--------------------------------*/
+
+#include "EventPool.h"
+
+////////// class EventPool //////////
+
+FixedBlockPool **EventPool::sPools = 0;
+
+/*-----------------------------------------------------------------------------
+	Prints in-use and total block counts for each size class
+-----------------------------------------------------------------------------*/
+void EventPool::printStats()
+{
+	if (!sPools) return;
+	for (uint c = 0; c < EVENTPOOL_NUM_SIZE_CLASSES; ++c) {
+		if (!sPools[c]) continue;
+		debugPrintf("EventPool: %u byte blocks, %u in use, %u total\n",
+			sPools[c]->blockSize(), sPools[c]->blocksInUse(), sPools[c]->blocksTotal());
+	}
+}
+
+// Constructor / destructor
+EventPool::EventPool()
+{
+	_ASSERTE(!sPools && "Only one EventPool can exist");
+	sPools = new FixedBlockPool*[EVENTPOOL_NUM_SIZE_CLASSES];
+	for (uint c = 0; c < EVENTPOOL_NUM_SIZE_CLASSES; ++c) {
+		size_t blockSize = 1 << (EVENTPOOL_MIN_BLOCK_SHIFT + c);
+		sPools[c] = new FixedBlockPool(blockSize, EVENTPOOL_CHUNK_SIZE / blockSize);
+	}
+}
+
+/*-----------------------------------------------------------------------------
+	If something is still holding an event (it outlived EventManager) its pool
+	is left alive, along with the set the event's allocator points to, so the
+	late release doesn't write to freed memory. The leak will show up in the
+	CRT leak report, which is what we want. The set is detached either way,
+	so another EventPool can be created.
+-----------------------------------------------------------------------------*/
+EventPool::~EventPool()
+{
+	printStats();
+	bool leaked = false;
+	for (uint c = 0; c < EVENTPOOL_NUM_SIZE_CLASSES; ++c) {
+		if (sPools[c]->blocksInUse() == 0) {
+			delete sPools[c];
+			sPools[c] = 0;
+		} else {
+			debugPrintf("EventPool: %u events still alive in %u byte class, pool leaked\n",
+				sPools[c]->blocksInUse(), sPools[c]->blockSize());
+			leaked = true;
+		}
+	}
+	if (!leaked) delete [] sPools;
+	sPools = 0;
+}
@@ -0,0 +1,196 @@
+/*----==== EVENTPOOL.H ====----
+	Author:		Jeff Kiah
+	Orig.Date:	10/17/2026
+	Rev.Date:	10/17/2026
+------------------------------*/
+
+#pragma once
+
+#include <memory>
+#include <new>
+#include <crtdbg.h>
+#include <boost/noncopyable.hpp>
+#include "../Utility/FixedBlockPool.h"
+#include "../Utility/Typedefs.h"
+
+using std::shared_ptr;
+
+///// DEFINITIONS /////
+
+#define EVENTPOOL_MIN_BLOCK_SHIFT	5		// smallest size class is 32 bytes
+#define EVENTPOOL_NUM_SIZE_CLASSES	5		// 32, 64, 128, 256, 512
+#define EVENTPOOL_MAX_BLOCK_SIZE	(1 << (EVENTPOOL_MIN_BLOCK_SHIFT + EVENTPOOL_NUM_SIZE_CLASSES - 1))
+#define EVENTPOOL_CHUNK_SIZE		65536	// bytes added to a size class each time it runs dry
+
+///// STRUCTURES /////
+
+/*=============================================================================
+class EventPool
+	Power of 2 size classes of FixedBlockPool that back EventPoolAllocator.
+	Events and their shared_ptr control blocks are allocated together in one
+	block (see makeEvent), and go back to the free list when the last EventPtr
+	is released, which for queued events is when notifyQueued pops them. After
+	warm-up a frame of events costs no trips to the heap. Requests bigger
+	than the largest class fall through to operator new.
+	The current set of pools is static so the allocator needs no instance.
+	EventManager holds the one EventPool object as its first member, which
+	creates the pools before anything else in the event system and frees
+	them last. Each allocator remembers the set it was made with, so an
+	event that outlives its EventManager is freed to its own pool, and a
+	new EventPool can be created meanwhile. allocate and deallocate are
+	thread-safe.
+=============================================================================*/
+class EventPool : private boost::noncopyable {
+	private:
+		///// VARIABLES /////
+		static FixedBlockPool **	sPools;	// current set, one per size class, null without an EventPool
+
+		///// FUNCTIONS /////
+		/*---------------------------------------------------------------------
+			Returns the size class index for an allocation size, size must be
+			no bigger than EVENTPOOL_MAX_BLOCK_SIZE
+		---------------------------------------------------------------------*/
+		static uint	sizeClass(size_t size) {
+						uint c = 0;
+						size_t blockSize = 1 << EVENTPOOL_MIN_BLOCK_SHIFT;
+						while (blockSize < size) { blockSize <<= 1; ++c; }
+						return c;
+					}
+
+	public:
+		/*---------------------------------------------------------------------
+			The pool set new allocators use, null if there is no EventPool
+		---------------------------------------------------------------------*/
+		static FixedBlockPool **	currentPools() { return sPools; }
+
+		/*---------------------------------------------------------------------
+			Allocate and deallocate must be given the same size and pool set
+		---------------------------------------------------------------------*/
+		static void *	allocate(size_t size, FixedBlockPool **pools) {
+							if (size > EVENTPOOL_MAX_BLOCK_SIZE) return ::operator new(size);
+							_ASSERTE(pools && "EventPool used before EventManager was created");
+							return pools[sizeClass(size)]->allocate();
+						}
+		static void		deallocate(void *p, size_t size, FixedBlockPool **pools) {
+							if (size > EVENTPOOL_MAX_BLOCK_SIZE) { ::operator delete(p); return; }
+							pools[sizeClass(size)]->deallocate(p);
+						}
+
+		/*---------------------------------------------------------------------
+			Prints in-use and total block counts for each size class
+		---------------------------------------------------------------------*/
+		static void		printStats();
+
+		// Constructor / destructor
+		explicit EventPool();
+		~EventPool();
+};
+
+/*=============================================================================
+class EventPoolAllocator
+	Standard allocator over EventPool. Meant for std::allocate_shared, which
+	rebinds it to its combined control block + object type, but works with
+	node-based containers of events too. An allocator holds the pool set that
+	was current when it was made, and the control block keeps a copy, so
+	the event is always freed to the pool it came from. Instances with the
+	same pool set are interchangeable.
+=============================================================================*/
+template <typename T>
+class EventPoolAllocator {
+	template <typename U> friend class EventPoolAllocator;
+	private:
+		///// VARIABLES /////
+		FixedBlockPool **	mPools;
+
+	public:
+		///// DEFINITIONS /////
+		typedef T			value_type;
+		typedef T *			pointer;
+		typedef const T *	const_pointer;
+		typedef T &			reference;
+		typedef const T &	const_reference;
+		typedef size_t		size_type;
+		typedef ptrdiff_t	difference_type;
+
+		template <typename U>
+		struct rebind { typedef EventPoolAllocator<U> other; };
+
+		///// FUNCTIONS /////
+		pointer			address(reference r) const			{ return &r; }
+		const_pointer	address(const_reference r) const	{ return &r; }
+
+		pointer			allocate(size_type n, const void * = 0) {
+							void *p = EventPool::allocate(n * sizeof(T), mPools);
+							if (!p) throw std::bad_alloc();
+							return static_cast<pointer>(p);
+						}
+		void			deallocate(pointer p, size_type n) {
+							EventPool::deallocate(p, n * sizeof(T), mPools);
+						}
+
+		void			construct(pointer p, const T &val)	{ ::new(static_cast<void*>(p)) T(val); }
+		void			destroy(pointer p)					{ p->~T(); }
+
+		size_type		max_size() const { return static_cast<size_type>(-1) / sizeof(T); }
+
+		template <typename U>
+		bool			operator==(const EventPoolAllocator<U> &a) const { return (mPools == a.mPools); }
+		template <typename U>
+		bool			operator!=(const EventPoolAllocator<U> &a) const { return (mPools != a.mPools); }
+
+		// Constructors
+		EventPoolAllocator() : mPools(EventPool::currentPools()) {}
+		EventPoolAllocator(const EventPoolAllocator &a) : mPools(a.mPools) {}
+		template <typename U>
+		EventPoolAllocator(const EventPoolAllocator<U> &a) : mPools(a.mPools) {}
+};
+
+///// FUNCTIONS /////
+
+/*---------------------------------------------------------------------
+	makeEvent creates an event in pooled memory, use it in place of
+	EventPtr(new T(...)) for any event fired at high frequency. The object
+	and reference count share one block so it's a single pool allocation.
+	Overloaded for up to 6 constructor arguments.
+---------------------------------------------------------------------*/
+template <typename T>
+inline shared_ptr<T> makeEvent()
+{
+	return std::allocate_shared<T>(EventPoolAllocator<T>());
+}
+
+template <typename T, typename A1>
+inline shared_ptr<T> makeEvent(const A1 &a1)
+{
+	return std::allocate_shared<T>(EventPoolAllocator<T>(), a1);
+}
+
+template <typename T, typename A1, typename A2>
+inline shared_ptr<T> makeEvent(const A1 &a1, const A2 &a2)
+{
+	return std::allocate_shared<T>(EventPoolAllocator<T>(), a1, a2);
+}
+
+template <typename T, typename A1, typename A2, typename A3>
+inline shared_ptr<T> makeEvent(const A1 &a1, const A2 &a2, const A3 &a3)
+{
+	return std::allocate_shared<T>(EventPoolAllocator<T>(), a1, a2, a3);
+}
+
+template <typename T, typename A1, typename A2, typename A3, typename A4>
+inline shared_ptr<T> makeEvent(const A1 &a1, const A2 &a2, const A3 &a3, const A4 &a4)
+{
+	return std::allocate_shared<T>(EventPoolAllocator<T>(), a1, a2, a3, a4);
+}
+
+template <typename T, typename A1, typename A2, typename A3, typename A4, typename A5>
+inline shared_ptr<T> makeEvent(const A1 &a1, const A2 &a2, const A3 &a3, const A4 &a4, const A5 &a5)
+{
+	return std::allocate_shared<T>(EventPoolAllocator<T>(), a1, a2, a3, a4, a5);
+}
+
+template <typename T, typename A1, typename A2, typename A3, typename A4, typename A5, typename A6>
+inline shared_ptr<T> makeEvent(const A1 &a1, const A2 &a2, const A3 &a3, const A4 &a4, const A5 &a5, const A6 &a6)
+{
+	return std::allocate_shared<T>(EventPoolAllocator<T>(), a1, a2, a3, a4, a5, a6);
+}
@@ -0,0 +1,237 @@
+/*----==== EVENTPROFILER.CPP ====----
+	Author:		Jeff Kiah
+	Orig.Date:	10/17/2026
+	Rev.Date:	10/17/2026
+-----------------------------------*/
+
+#include "EventProfiler.h"
+
+#if EVENT_PROFILER
+
+#include <fstream>
+#include "../HighPerfTimer.h"
+
+using std::ofstream;
+
+///// FUNCTIONS /////
+
+/*-----------------------------------------------------------------------------
+	Writes a string as a JSON string literal. Names are identifiers in practice
+	so only quotes, backslashes and control characters need handling.
+-----------------------------------------------------------------------------*/
+static void writeJsonString(ofstream &out, const string &s)
+{
+	out << '"';
+	string::const_iterator ci, end = s.end();
+	for (ci = s.begin(); ci != end; ++ci) {
+		char c = *ci;
+		if (c == '"' || c == '\\') {
+			out << '\\' << c;
+		} else if (static_cast<uchar>(c) < 0x20) {
+			out << ' ';
+		} else {
+			out << c;
+		}
+	}
+	out << '"';
+}
+
+////////// struct LatencyHistogram //////////
+
+/*-----------------------------------------------------------------------------
+	Returns the upper bound in cycles of the bucket holding the given fraction
+	(0-1) of samples, so percentile(0.99) is a p99 estimate
+-----------------------------------------------------------------------------*/
+uint64 LatencyHistogram::percentile(double fraction) const
+{
+	if (count == 0) return 0;
+	uint64 target = static_cast<uint64>(fraction * static_cast<double>(count));
+	if (target >= count) target = count - 1;
+	uint64 seen = 0;
+	for (uint b = 0; b < EVENTPROF_HISTOGRAM_BUCKETS; ++b) {
+		seen += buckets[b];
+		if (seen > target) {
+			return (b == EVENTPROF_HISTOGRAM_BUCKETS - 1) ? maxCycles : (2ULL << b);
+		}
+	}
+	return maxCycles;
+}
+
+////////// class EventProfiler //////////
+
+/*-----------------------------------------------------------------------------
+	Estimates the TSC rate against QPC from the time the profiler was created
+	until now
+-----------------------------------------------------------------------------*/
+double EventProfiler::cyclesPerMicrosecond() const
+{
+	__int64 qpcElapsed = HighPerfTimer::queryCounts() - mCalibQpc;
+	uint64 tscElapsed = now() - mCalibTsc;
+	if (qpcElapsed <= 0) return 1000.0; // no time has passed, any guess will do
+	double us = static_cast<double>(qpcElapsed) * 1000000.0 / static_cast<double>(HighPerfTimer::timerFreq());
+	return static_cast<double>(tscElapsed) / us;
+}
+
+/*-----------------------------------------------------------------------------
+	Called at the start of notifyQueued with the number of queued events.
+	Starts recording if a capture was armed.
+-----------------------------------------------------------------------------*/
+void EventProfiler::beginFrame(uint queueDepth)
+{
+	++mFrames;
+	mTotalQueueDepth += queueDepth;
+	if (queueDepth > mMaxQueueDepth) mMaxQueueDepth = queueDepth;
+	mFrameQueueDepth = queueDepth;
+	mFrameThreadDrain = 0;
+
+	if (!mCapturePath.empty()) {
+		mCapturing = true;
+		mSpans.clear();
+		mFrameStart = now();
+	}
+}
+
+/*-----------------------------------------------------------------------------
+	Called at the end of notifyQueued. Writes the trace if this frame was
+	captured.
+-----------------------------------------------------------------------------*/
+void EventProfiler::endFrame(uint rolledOver)
+{
+	if (rolledOver > 0) {
+		++mRolloverFrames;
+		mRolloverEvents += rolledOver;
+	}
+	if (mCapturing) {
+		uint64 frameEnd = now();
+		if (writeChromeTrace(frameEnd)) {
+			debugPrintf("EventProfiler: wrote %u spans to \"%s\"\n", mSpans.size(), mCapturePath.c_str());
+		} else {
+			debugPrintf("EventProfiler: failed to write trace file \"%s\"\n", mCapturePath.c_str());
+		}
+		mCapturing = false;
+		mCapturePath.clear();
+		vector<TraceSpan>().swap(mSpans); // captures are rare, give the memory back
+	}
+}
+
+/*-----------------------------------------------------------------------------
+	Records a span in the frame being captured, only call when capturing() is
+	true
+-----------------------------------------------------------------------------*/
+void EventProfiler::addSpan(const string &name, const string &eventType, uint64 start, uint64 end,
+							DWORD threadId)
+{
+	_ASSERTE(mCapturing);
+	if (mSpans.size() >= EVENTPROF_MAX_TRACE_SPANS) return;
+	mSpans.push_back(TraceSpan());
+	TraceSpan &s = mSpans.back();
+	s.name = name;
+	s.eventType = eventType;
+	s.start = start;
+	s.end = end;
+	s.threadId = threadId;
+}
+
+/*-----------------------------------------------------------------------------
+	Arms a capture of the next notifyQueued call, written to filename when the
+	frame ends
+-----------------------------------------------------------------------------*/
+void EventProfiler::captureNextFrame(const string &filename)
+{
+	_ASSERTE(!filename.empty());
+	if (mCapturing) {
+		debugPrintf("EventProfiler: capture already in progress, \"%s\" ignored\n", filename.c_str());
+		return;
+	}
+	mCapturePath = filename;
+}
+
+/*-----------------------------------------------------------------------------
+	Writes the captured frame as Chrome trace JSON, returns false if the file
+	can't be written. Each handler call is a complete ("X") event on the
+	thread it ran on, and the frame itself is an enclosing span on the main
+	thread carrying the queue depth.
+-----------------------------------------------------------------------------*/
+bool EventProfiler::writeChromeTrace(uint64 frameEnd) const
+{
+	ofstream out;
+	out.open(mCapturePath.c_str(), std::ios::out | std::ios::trunc);
+	if (!out.is_open()) return false;
+
+	double cyclesPerUs = cyclesPerMicrosecond();
+	DWORD mainThreadId = GetCurrentThreadId();
+	out.setf(std::ios::fixed);
+	out.precision(3);
+
+	out << "{\"traceEvents\":[\n";
+	out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << mainThreadId
+		<< ",\"args\":{\"name\":\"main\"}},\n";
+	out << "{\"name\":\"notifyQueued\",\"cat\":\"frame\",\"ph\":\"X\",\"ts\":0.000,\"dur\":"
+		<< static_cast<double>(frameEnd - mFrameStart) / cyclesPerUs
+		<< ",\"pid\":1,\"tid\":" << mainThreadId
+		<< ",\"args\":{\"queueDepth\":" << mFrameQueueDepth
+		<< ",\"threadDrained\":" << mFrameThreadDrain << "}},\n";
+	out << "{\"name\":\"queue\",\"ph\":\"C\",\"ts\":0.000,\"pid\":1,\"args\":{\"depth\":"
+		<< mFrameQueueDepth << "}}";
+
+	vector<TraceSpan>::const_iterator si, end = mSpans.end();
+	for (si = mSpans.begin(); si != end; ++si) {
+		out << ",\n{\"name\":";
+		writeJsonString(out, si->name);
+		out << ",\"cat\":\"" << (si->eventType.empty() ? "batch" : "listener") << "\",\"ph\":\"X\",\"ts\":"
+			<< static_cast<double>(static_cast<int64>(si->start - mFrameStart)) / cyclesPerUs
+			<< ",\"dur\":" << static_cast<double>(si->end - si->start) / cyclesPerUs
+			<< ",\"pid\":1,\"tid\":" << si->threadId;
+		if (!si->eventType.empty()) {
+			out << ",\"args\":{\"event\":";
+			writeJsonString(out, si->eventType);
+			out << '}';
+		}
+		out << '}';
+	}
+	out << "\n],\"displayTimeUnit\":\"ns\"}\n";
+	out.close();
+	return !out.fail();
+}
+
+/*-----------------------------------------------------------------------------
+	Prints frame stats, and the type and listener stats passed in
+-----------------------------------------------------------------------------*/
+void EventProfiler::printFrameStats() const
+{
+	debugPrintf("EventProfiler: %I64u frames, queue depth avg %.1f max %u, thread drain max %u\n",
+		mFrames, (mFrames > 0) ? static_cast<double>(mTotalQueueDepth) / mFrames : 0.0,
+		mMaxQueueDepth, mMaxThreadDrain);
+	debugPrintf("EventProfiler: %I64u frames rolled over %I64u events\n", mRolloverFrames, mRolloverEvents);
+}
+
+void EventProfiler::printTypeStats(const string &eventType, const EventTypeStats &stats) const
+{
+	if (stats.dispatched == 0 && stats.coalesced == 0) return;
+	debugPrintf("EventProfiler: \"%s\" raised %I64u, thread %I64u, triggered %I64u, coalesced %I64u, dispatched %I64u, avg %.2f us\n",
+		eventType.c_str(), stats.raised, stats.threadRaised, stats.triggered, stats.coalesced, stats.dispatched,
+		static_cast<double>(stats.dispatchCycles) / stats.dispatched / cyclesPerMicrosecond());
+}
+
+void EventProfiler::printListenerStats(const string &listenerName, const LatencyHistogram &hist) const
+{
+	if (hist.count == 0) return;
+	double cyclesPerUs = cyclesPerMicrosecond();
+	debugPrintf("EventProfiler: listener \"%s\" %I64u calls, avg %.2f us, p50 %.2f us, p99 %.2f us, max %.2f us\n",
+		listenerName.c_str(), hist.count,
+		static_cast<double>(hist.totalCycles) / hist.count / cyclesPerUs,
+		static_cast<double>(hist.percentile(0.5)) / cyclesPerUs,
+		static_cast<double>(hist.percentile(0.99)) / cyclesPerUs,
+		static_cast<double>(hist.maxCycles) / cyclesPerUs);
+}
+
+// Constructor
+EventProfiler::EventProfiler() :
+	mFrames(0), mRolloverFrames(0), mRolloverEvents(0),
+	mMaxQueueDepth(0), mMaxThreadDrain(0), mTotalQueueDepth(0),
+	mCapturePath(), mCapturing(false), mSpans(),
+	mFrameStart(0), mFrameQueueDepth(0), mFrameThreadDrain(0),
+	mCalibTsc(now()), mCalibQpc(HighPerfTimer::queryCounts())
+{}
+
+#endif	// EVENT_PROFILER
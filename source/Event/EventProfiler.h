@@ -0,0 +1,209 @@
+/*----==== EVENTPROFILER.H ====----
+	Author:		Jeff Kiah
+	Orig.Date:	10/17/2026
+	Rev.Date:	10/17/2026
+---------------------------------*/
+
+#pragma once
+
+///// DEFINITIONS /////
+
+// Set EVENT_PROFILER to 0 in the project settings to compile out all event instrumentation,
+// including the extra members in EventTypeEntry and EventListener
+#ifndef EVENT_PROFILER
+#define EVENT_PROFILER	1
+#endif
+
+#if EVENT_PROFILER
+	#define ifEventProfiler(...)	__VA_ARGS__
+#else
+	#define ifEventProfiler(...)
+#endif
+
+#if EVENT_PROFILER
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN	// defined in project settings
+#endif
+
+#include <Windows.h>
+#include <intrin.h>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <boost/noncopyable.hpp>
+#include "../Utility/Typedefs.h"
+
+using std::string;
+using std::vector;
+
+#define EVENTPROF_HISTOGRAM_BUCKETS		32		// log2 buckets of CPU cycles, the last collects everything larger
+#define EVENTPROF_MAX_TRACE_SPANS		65536	// a captured frame stops recording spans past this
+
+///// STRUCTURES /////
+
+/*=============================================================================
+struct LatencyHistogram
+	Handler latency in CPU cycles, bucketed by power of 2. Bucket b holds
+	calls that took [2^b, 2^(b+1)) cycles. Adding a sample is a bit scan and
+	a few increments.
+=============================================================================*/
+struct LatencyHistogram {
+	uint	buckets[EVENTPROF_HISTOGRAM_BUCKETS];
+	uint64	count;
+	uint64	totalCycles;
+	uint64	maxCycles;
+
+	void	add(uint64 cycles) {
+				ulong b = EVENTPROF_HISTOGRAM_BUCKETS - 1;
+				if (cycles < (1ULL << (EVENTPROF_HISTOGRAM_BUCKETS - 1))) {
+					_BitScanReverse(&b, static_cast<ulong>(cycles) | 1);
+				}
+				++buckets[b];
+				++count;
+				totalCycles += cycles;
+				if (cycles > maxCycles) maxCycles = cycles;
+			}
+
+	/*---------------------------------------------------------------------
+		Returns the upper bound in cycles of the bucket holding the given
+		fraction (0-1) of samples, so percentile(0.99) is a p99 estimate
+	---------------------------------------------------------------------*/
+	uint64	percentile(double fraction) const;
+
+	LatencyHistogram() { reset(); }
+	void	reset() { memset(this, 0, sizeof(LatencyHistogram)); }
+};
+
+/*=============================================================================
+struct EventTypeStats
+	Counters kept in each EventTypeEntry. Only the main thread touches them,
+	events from the thread-safe queue are counted when they are drained.
+=============================================================================*/
+struct EventTypeStats {
+	uint64	raised;			// queued with raise
+	uint64	threadRaised;	// drained from the thread-safe queue
+	uint64	triggered;		// dispatched immediately with trigger
+	uint64	coalesced;		// replaced by a later event with the same coalesce key
+	uint64	dispatched;		// passed to notifyListeners
+	uint64	dispatchCycles;	// total cycles spent in notifyListeners for the type
+
+	EventTypeStats() :
+		raised(0), threadRaised(0), triggered(0), coalesced(0), dispatched(0), dispatchCycles(0)
+	{}
+};
+
+/*=============================================================================
+struct TraceSpan
+	One timed section for the Chrome trace, in CPU cycles. Names are copied
+	because a listener may be destroyed before the trace is written.
+=============================================================================*/
+struct TraceSpan {
+	string	name;
+	string	eventType;		// empty for spans that aren't a single handler call
+	uint64	start;
+	uint64	end;
+	DWORD	threadId;
+};
+
+/*=============================================================================
+class EventProfiler
+	Frame level statistics for the event manager (queue depth, rollovers) and
+	capture of a single frame's dispatch timeline, written out in the Chrome
+	trace event format (load it in chrome://tracing or Perfetto). Per-type and
+	per-listener numbers live in EventTypeEntry and EventListener so recording
+	them doesn't need a lookup, EventManager gathers them for the report.
+	Timing uses the CPU timestamp counter, which is converted to microseconds
+	against QueryPerformanceCounter only when the trace is written. Assumes an
+	invariant TSC, which holds for any CPU this engine cares about.
+	**NOTE**
+	Not thread-safe. Spans from worker threads are handed to the profiler by
+	the main thread after the workers have joined.
+=============================================================================*/
+class EventProfiler : private boost::noncopyable {
+	private:
+		///// VARIABLES /////
+		// frame stats
+		uint64		mFrames;
+		uint64		mRolloverFrames;	// frames that left queued events for the next frame
+		uint64		mRolloverEvents;	// total events left over, counted once per frame they were left
+		uint		mMaxQueueDepth;
+		uint		mMaxThreadDrain;	// most events drained from the thread-safe queue in a frame
+		uint64		mTotalQueueDepth;	// for the average
+
+		// trace capture
+		string				mCapturePath;		// non-empty when a capture is armed or in progress
+		bool				mCapturing;			// the current frame is being recorded
+		vector<TraceSpan>	mSpans;
+		uint64				mFrameStart;
+		uint				mFrameQueueDepth;
+		uint				mFrameThreadDrain;
+
+		// timestamp calibration
+		uint64		mCalibTsc;
+		__int64		mCalibQpc;
+
+		///// FUNCTIONS /////
+		/*---------------------------------------------------------------------
+			Estimates the TSC rate against QPC from the time the profiler was
+			created until now
+		---------------------------------------------------------------------*/
+		double	cyclesPerMicrosecond() const;
+
+		/*---------------------------------------------------------------------
+			Writes the captured frame as Chrome trace JSON, returns false if
+			the file can't be written
+		---------------------------------------------------------------------*/
+		bool	writeChromeTrace(uint64 frameEnd) const;
+
+	public:
+		static uint64	now() { return __rdtsc(); }
+
+		bool	capturing() const { return mCapturing; }
+
+		/*---------------------------------------------------------------------
+			Called at the start of notifyQueued with the number of queued
+			events. Starts recording if a capture was armed.
+		---------------------------------------------------------------------*/
+		void	beginFrame(uint queueDepth);
+
+		/*---------------------------------------------------------------------
+			Called with the number of events drained from the thread-safe
+			queue this frame
+		---------------------------------------------------------------------*/
+		void	threadDrained(uint count) {
+					mFrameThreadDrain = count;
+					if (count > mMaxThreadDrain) mMaxThreadDrain = count;
+				}
+
+		/*---------------------------------------------------------------------
+			Called at the end of notifyQueued. Writes the trace if this frame
+			was captured.
+		---------------------------------------------------------------------*/
+		void	endFrame(uint rolledOver);
+
+		/*---------------------------------------------------------------------
+			Records a span in the frame being captured, only call when
+			capturing() is true
+		---------------------------------------------------------------------*/
+		void	addSpan(const string &name, const string &eventType, uint64 start, uint64 end,
+						DWORD threadId = GetCurrentThreadId());
+
+		/*---------------------------------------------------------------------
+			Arms a capture of the next notifyQueued call, written to filename
+			when the frame ends
+		---------------------------------------------------------------------*/
+		void	captureNextFrame(const string &filename);
+
+		/*---------------------------------------------------------------------
+			Prints frame stats, and the type and listener stats passed in
+		---------------------------------------------------------------------*/
+		void	printFrameStats() const;
+		void	printTypeStats(const string &eventType, const EventTypeStats &stats) const;
+		void	printListenerStats(const string &listenerName, const LatencyHistogram &hist) const;
+
+		// Constructor
+		explicit EventProfiler();
+};
+
+#endif	// EVENT_PROFILER
@@ -0,0 +1,135 @@
+/*----==== EVENTSERIALIZATION.H ====----
+	Author:		Jeff Kiah
+	Orig.Date:	10/17/2026
+	Rev.Date:	10/17/2026
+--------------------------------------*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <streambuf>
+#include <iostream>
+#include "Event.h"
+#include "EventPool.h"
+#include "../Utility/Typedefs.h"
+
+using std::string;
+using std::vector;
+using std::ostream;
+using std::istream;
+
+/*=============================================================================
+	Binary serialization helpers for Event::serialize and deserialize. Values
+	are written in native byte order and layout, strings and vectors are
+	prefixed with a uint count. Streams must be opened in binary mode. This is
+	meant for recording and replaying sessions on the same build, not as an
+	interchange format, so there is no versioning below the log header.
+=============================================================================*/
+
+///// FUNCTIONS /////
+
+/*---------------------------------------------------------------------
+	Plain value types only (ints, floats, enums, and structs of those
+	like Vector3f), they are copied byte for byte
+---------------------------------------------------------------------*/
+template <typename T>
+inline void writeBinary(ostream &out, const T &val)
+{
+	out.write(reinterpret_cast<const char *>(&val), sizeof(T));
+}
+
+template <typename T>
+inline void readBinary(istream &in, T &val)
+{
+	in.read(reinterpret_cast<char *>(&val), sizeof(T));
+}
+
+inline void writeBinary(ostream &out, const string &str)
+{
+	uint len = static_cast<uint>(str.size());
+	writeBinary(out, len);
+	if (len > 0) out.write(str.data(), len);
+}
+
+inline void readBinary(istream &in, string &str)
+{
+	uint len = 0;
+	readBinary(in, len);
+	str.resize(len);
+	if (len > 0) in.read(&str[0], len);
+}
+
+/*---------------------------------------------------------------------
+	Vectors of plain value types, written as one block
+---------------------------------------------------------------------*/
+template <typename T>
+inline void writeBinary(ostream &out, const vector<T> &v)
+{
+	uint count = static_cast<uint>(v.size());
+	writeBinary(out, count);
+	if (count > 0) out.write(reinterpret_cast<const char *>(&v[0]), count * sizeof(T));
+}
+
+template <typename T>
+inline void readBinary(istream &in, vector<T> &v)
+{
+	uint count = 0;
+	readBinary(in, count);
+	v.resize(count);
+	if (count > 0) in.read(reinterpret_cast<char *>(&v[0]), count * sizeof(T));
+}
+
+/*---------------------------------------------------------------------
+	Default RegisteredEvent::ReadEventFunc for code-defined events.
+	Creates a T in pooled memory with its default constructor and calls
+	deserialize on it. Register it with
+		regPtr->setReadEventFunc(&deserializeEvent<T>);
+---------------------------------------------------------------------*/
+template <typename T>
+EventPtr deserializeEvent(istream &in)
+{
+	shared_ptr<T> ePtr(makeEvent<T>());
+	ePtr->deserialize(in);
+	return ePtr;
+}
+
+///// STRUCTURES /////
+
+/*=============================================================================
+class VectorStreamBuf
+	Output stream buffer that appends to a vector<char>, so events can be
+	serialized into a reused scratch buffer without the allocations of a
+	stringstream. Wrap it in an ostream.
+=============================================================================*/
+class VectorStreamBuf : public std::streambuf {
+	private:
+		vector<char> &	mBuffer;
+
+	protected:
+		virtual int_type		overflow(int_type c) {
+									if (!traits_type::eq_int_type(c, traits_type::eof())) {
+										mBuffer.push_back(traits_type::to_char_type(c));
+									}
+									return traits_type::not_eof(c);
+								}
+		virtual std::streamsize	xsputn(const char *s, std::streamsize n) {
+									mBuffer.insert(mBuffer.end(), s, s + n);
+									return n;
+								}
+	public:
+		explicit VectorStreamBuf(vector<char> &buffer) : mBuffer(buffer) {}
+};
+
+/*=============================================================================
+class MemoryStreamBuf
+	Input stream buffer over a block of memory that is not owned, such as a
+	record in a memory-mapped log. Wrap it in an istream.
+=============================================================================*/
+class MemoryStreamBuf : public std::streambuf {
+	public:
+		explicit MemoryStreamBuf(const char *data, size_t size) {
+			char *p = const_cast<char *>(data); // only ever read through the get area
+			setg(p, p, p + size);
+		}
+};
@@ -0,0 +1,147 @@
+/*----==== EVENTTIMERWHEEL.CPP ====----
+	Author:		Jeff Kiah
+	Orig.Date:	10/17/2026
+	Rev.Date:	10/17/2026
+-------------------------------------*/
+
+#include "EventTimerWheel.h"
+
+////////// class EventTimerWheel //////////
+
+/*-----------------------------------------------------------------------------
+	Files the node in the slot for its expire tick, relative to mNextTick.
+	Overdue timers go in the slot for mNextTick. Timers further off than the
+	top level spans are filed at the end of it, and refiled when cascaded.
+-----------------------------------------------------------------------------*/
+void EventTimerWheel::link(uint n)
+{
+	TimerNode &node = mNodes[n];
+	uint64 expire = (node.expireTick > mNextTick) ? node.expireTick : mNextTick;
+	uint64 delta = expire - mNextTick;
+	if (delta > EVENTTIMER_MAX_DELTA) {
+		delta = EVENTTIMER_MAX_DELTA;
+		expire = mNextTick + delta;
+	}
+	uint level = 0;
+	while (level < EVENTTIMER_LEVELS - 1 && delta >= (1ULL << ((level + 1) * EVENTTIMER_SLOT_BITS))) {
+		++level;
+	}
+	uint slot = level * EVENTTIMER_SLOTS +
+				(static_cast<uint>(expire >> (level * EVENTTIMER_SLOT_BITS)) & EVENTTIMER_SLOT_MASK);
+
+	node.slot = slot;
+	node.prev = EVENTTIMER_NIL;
+	node.next = mSlots[slot];
+	if (node.next != EVENTTIMER_NIL) mNodes[node.next].prev = n;
+	mSlots[slot] = n;
+}
+
+void EventTimerWheel::unlink(uint n)
+{
+	TimerNode &node = mNodes[n];
+	_ASSERTE(node.slot != EVENTTIMER_NIL);
+	if (node.prev != EVENTTIMER_NIL) {
+		mNodes[node.prev].next = node.next;
+	} else {
+		mSlots[node.slot] = node.next;
+	}
+	if (node.next != EVENTTIMER_NIL) mNodes[node.next].prev = node.prev;
+	node.slot = EVENTTIMER_NIL;
+}
+
+void EventTimerWheel::freeNode(uint n)
+{
+	TimerNode &node = mNodes[n];
+	node.ePtr.reset();
+	++node.generation;
+	if (node.generation == 0) node.generation = 1; // keep ids non-zero
+	node.next = mFreeHead;
+	mFreeHead = n;
+	--mNumPending;
+}
+
+/*-----------------------------------------------------------------------------
+	Refiles every node in a slot of a higher level, which moves them down at
+	least one level. Returns the slot index.
+-----------------------------------------------------------------------------*/
+uint EventTimerWheel::cascade(uint level)
+{
+	uint idx = static_cast<uint>(mNextTick >> (level * EVENTTIMER_SLOT_BITS)) & EVENTTIMER_SLOT_MASK;
+	uint slot = level * EVENTTIMER_SLOTS + idx;
+	uint n = mSlots[slot];
+	mSlots[slot] = EVENTTIMER_NIL;
+	while (n != EVENTTIMER_NIL) {
+		uint next = mNodes[n].next;
+		link(n);
+		n = next;
+	}
+	return idx;
+}
+
+/*-----------------------------------------------------------------------------
+	Schedules an event to expire on the given tick, returns the id to cancel it
+	with. A tick that has already passed expires on the next advance.
+-----------------------------------------------------------------------------*/
+EventTimerId EventTimerWheel::schedule(const EventPtr &ePtr, uint64 expireTick)
+{
+	_ASSERTE(ePtr);
+	uint n = mFreeHead;
+	if (n != EVENTTIMER_NIL) {
+		mFreeHead = mNodes[n].next;
+	} else {
+		n = static_cast<uint>(mNodes.size());
+		_ASSERTE(n != EVENTTIMER_NIL && "Timer wheel is full");
+		mNodes.push_back(TimerNode());
+		mNodes[n].generation = 1;
+	}
+	TimerNode &node = mNodes[n];
+	node.ePtr = ePtr;
+	node.expireTick = expireTick;
+	link(n);
+	++mNumPending;
+	return (static_cast<uint64>(node.generation) << 32) | n;
+}
+
+/*-----------------------------------------------------------------------------
+	Removes a pending timer, returns false if the id has already expired or
+	been cancelled
+-----------------------------------------------------------------------------*/
+bool EventTimerWheel::cancel(EventTimerId id)
+{
+	uint n = static_cast<uint>(id);
+	uint generation = static_cast<uint>(id >> 32);
+	if (n >= mNodes.size() || mNodes[n].generation != generation || mNodes[n].slot == EVENTTIMER_NIL) {
+		return false;
+	}
+	unlink(n);
+	freeNode(n);
+	return true;
+}
+
+/*-----------------------------------------------------------------------------
+	Drops every pending timer
+-----------------------------------------------------------------------------*/
+void EventTimerWheel::clear()
+{
+	for (uint s = 0; s < EVENTTIMER_LEVELS * EVENTTIMER_SLOTS; ++s) {
+		uint n = mSlots[s];
+		mSlots[s] = EVENTTIMER_NIL;
+		while (n != EVENTTIMER_NIL) {
+			uint next = mNodes[n].next;
+			mNodes[n].slot = EVENTTIMER_NIL;
+			freeNode(n);
+			n = next;
+		}
+	}
+	_ASSERTE(mNumPending == 0);
+}
+
+// Constructor
+EventTimerWheel::EventTimerWheel(uint64 startTick) :
+	mNodes(), mFreeHead(EVENTTIMER_NIL),
+	mNextTick(startTick), mNumPending(0)
+{
+	for (uint s = 0; s < EVENTTIMER_LEVELS * EVENTTIMER_SLOTS; ++s) {
+		mSlots[s] = EVENTTIMER_NIL;
+	}
+}
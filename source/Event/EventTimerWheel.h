@@ -0,0 +1,138 @@
+/*----==== EVENTTIMERWHEEL.H ====----
+	Author:		Jeff Kiah
+	Orig.Date:	10/17/2026
+	Rev.Date:	10/17/2026
+-----------------------------------*/
+
+#pragma once
+
+#include <vector>
+#include <boost/noncopyable.hpp>
+#include "Event.h"
+#include "../Utility/Typedefs.h"
+
+using std::vector;
+
+///// DEFINITIONS /////
+
+#define EVENTTIMER_LEVELS		4
+#define EVENTTIMER_SLOT_BITS	8
+#define EVENTTIMER_SLOTS		(1 << EVENTTIMER_SLOT_BITS)
+#define EVENTTIMER_SLOT_MASK	(EVENTTIMER_SLOTS - 1)
+#define EVENTTIMER_MAX_DELTA	((1ULL << (EVENTTIMER_LEVELS * EVENTTIMER_SLOT_BITS)) - 1)	// ~49 days of 1ms ticks
+#define EVENTTIMER_NIL			0xFFFFFFFF
+
+typedef uint64 EventTimerId;	// 0 is never a valid id
+
+///// STRUCTURES /////
+
+/*=============================================================================
+class EventTimerWheel
+	Holds events scheduled to be raised at a later tick, in a hierarchical
+	timing wheel. Level 0 has a slot for each of the next 256 ticks, and each
+	level above covers 256 times the span of the one below it, so a timer is
+	filed by how far off it is in a couple of shifts. Scheduling and cancelling
+	are O(1), and advancing one tick only touches the level 0 slot for that
+	tick, plus one slot of the level above every 256 ticks when it is
+	cascaded down. Pending timers that aren't due are never looked at, so the
+	cost per frame doesn't depend on how many there are.
+	Timers are nodes in one vector linked into their slot by index, and freed
+	nodes are reused, so there is no allocation once the vector has grown to
+	the working size. Ids carry a generation count so a stale id can't cancel
+	a node that has since been reused. The wheel doesn't know what a tick is,
+	EventManager uses milliseconds. Timers due on the same tick expire in no
+	particular order. Not thread-safe.
+=============================================================================*/
+class EventTimerWheel : private boost::noncopyable {
+	private:
+		///// STRUCTURES /////
+		struct TimerNode {
+			EventPtr	ePtr;
+			uint64		expireTick;
+			uint		prev, next;		// links within the slot, next also links the free list
+			uint		slot;			// slot holding the node, EVENTTIMER_NIL when free
+			uint		generation;		// bumped each time the node is freed
+		};
+
+		///// VARIABLES /////
+		vector<TimerNode>	mNodes;
+		uint				mFreeHead;		// first free node, EVENTTIMER_NIL if none
+		uint				mSlots[EVENTTIMER_LEVELS * EVENTTIMER_SLOTS];	// first node in each slot
+		uint64				mNextTick;		// the next tick to be expired
+		uint				mNumPending;
+
+		///// FUNCTIONS /////
+		/*---------------------------------------------------------------------
+			Files the node in the slot for its expire tick, relative to
+			mNextTick. Overdue timers go in the slot for mNextTick.
+		---------------------------------------------------------------------*/
+		void	link(uint n);
+		void	unlink(uint n);
+		void	freeNode(uint n);
+
+		/*---------------------------------------------------------------------
+			Refiles every node in a slot of a higher level, which moves them
+			down at least one level. Returns the slot index.
+		---------------------------------------------------------------------*/
+		uint	cascade(uint level);
+
+	public:
+		uint	numPending() const	{ return mNumPending; }
+		uint64	nextTick() const	{ return mNextTick; }
+
+		/*---------------------------------------------------------------------
+			Schedules an event to expire on the given tick, returns the id
+			to cancel it with. A tick that has already passed expires on the
+			next advance.
+		---------------------------------------------------------------------*/
+		EventTimerId	schedule(const EventPtr &ePtr, uint64 expireTick);
+
+		/*---------------------------------------------------------------------
+			Removes a pending timer, returns false if the id has already
+			expired or been cancelled
+		---------------------------------------------------------------------*/
+		bool	cancel(EventTimerId id);
+
+		/*---------------------------------------------------------------------
+			Expires every tick up to and including nowTick, calling
+			expired(const EventPtr &) for each timer that was due. The slot is
+			unlinked before the calls, so scheduling or cancelling from the
+			callback is safe.
+		---------------------------------------------------------------------*/
+		template <typename Func>
+		void	advance(uint64 nowTick, Func expired) {
+					if (mNumPending == 0) { // nothing to expire, just catch up
+						if (nowTick >= mNextTick) mNextTick = nowTick + 1;
+						return;
+					}
+					EventPtr ePtr;
+					while (mNextTick <= nowTick && mNumPending > 0) {
+						uint idx = static_cast<uint>(mNextTick) & EVENTTIMER_SLOT_MASK;
+						if (idx == 0) { // wrapped level 0, bring the next span down
+							for (uint level = 1; level < EVENTTIMER_LEVELS && cascade(level) == 0; ++level) {}
+						}
+						uint n = mSlots[idx];
+						mSlots[idx] = EVENTTIMER_NIL;
+						++mNextTick; // timers scheduled from the callback are filed after this tick
+						while (n != EVENTTIMER_NIL) {
+							TimerNode &node = mNodes[n];
+							uint next = node.next;
+							ePtr.swap(node.ePtr);
+							node.slot = EVENTTIMER_NIL;
+							freeNode(n);
+							expired(ePtr);
+							ePtr.reset();
+							n = next;
+						}
+					}
+					if (mNextTick <= nowTick) mNextTick = nowTick + 1;
+				}
+
+		/*---------------------------------------------------------------------
+			Drops every pending timer
+		---------------------------------------------------------------------*/
+		void	clear();
+
+		// Constructor
+		explicit EventTimerWheel(uint64 startTick = 0);
+};
@@ -0,0 +1,70 @@
+/*----==== EVENTTYPEID.H ====----
+	Author:		Jeff Kiah
+	Orig.Date:	10/17/2026
+	Rev.Date:	10/17/2026
+--------------------------------*/
+
+#pragma once
+
+#include <string>
+#include "../Utility/Typedefs.h"
+
+using std::string;
+
+///// DEFINITIONS /////
+
+/*=============================================================================
+	EventTypeId is the interned integer form of an event type string. It is a
+	32-bit FNV-1a hash of the type name, so it can be computed at compile time
+	from a string literal with EVENT_TYPE_ID("NAME"), or at run time from any
+	string with hashEventType() (both produce the same value). EventManager
+	and EventListener key all of their dispatch tables on this value, the
+	string names are only kept around for debugging and for script.
+=============================================================================*/
+typedef uint	EventTypeId;
+
+#define FNV1A_OFFSET_BASIS	2166136261u
+#define FNV1A_PRIME			16777619u
+
+/*---------------------------------------------------------------------
+	Compile-time hash of a string literal. The array size is part of the
+	type, so the template unrolls into a constant expression that the
+	optimizer folds away. Don't call this directly, use EVENT_TYPE_ID.
+---------------------------------------------------------------------*/
+template <size_t N, size_t I>
+struct EventTypeHash {
+	__forceinline static EventTypeId hash(const char (&str)[N]) {
+		return (EventTypeHash<N, I-1>::hash(str) ^ static_cast<uchar>(str[I-1])) * FNV1A_PRIME;
+	}
+};
+
+template <size_t N>
+struct EventTypeHash<N, 0> {
+	__forceinline static EventTypeId hash(const char (&)[N]) {
+		return FNV1A_OFFSET_BASIS;
+	}
+};
+
+// sizeof(str)-1 leaves off the null terminator
+#define EVENT_TYPE_ID(str)	(EventTypeHash<sizeof(str), sizeof(str)-1>::hash(str))
+
+///// FUNCTIONS /////
+
+/*---------------------------------------------------------------------
+	Run-time hash of an event type name, used by the string shims in
+	EventManager and for types registered from script
+---------------------------------------------------------------------*/
+inline EventTypeId hashEventType(const char *str)
+{
+	EventTypeId h = FNV1A_OFFSET_BASIS;
+	while (*str) {
+		h = (h ^ static_cast<uchar>(*str)) * FNV1A_PRIME;
+		++str;
+	}
+	return h;
+}
+
+inline EventTypeId hashEventType(const string &str)
+{
+	return hashEventType(str.c_str());
+}
@@ -0,0 +1,310 @@
+/*----==== EVENTTYPETABLE.CPP ====----
+	Author:		Jeff Kiah
+	Orig.Date:	10/17/2026
+	Rev.Date:	10/17/2026
+-------------------------------------*/
+
+#include <algorithm>
+#include "EventTypeTable.h"
+
+///// FUNCTIONS /////
+
+/*-----------------------------------------------------------------------------
+	Sort key for listener priority, 0 means no priority and goes last
+-----------------------------------------------------------------------------*/
+static inline uint priorityKey(uint priority)
+{
+	return (priority == 0) ? 0xFFFFFFFF : priority;
+}
+
+/*-----------------------------------------------------------------------------
+	Orders listener entries by priority key, ignoring the listener pointer
+-----------------------------------------------------------------------------*/
+struct ListenerPriorityLess {
+	bool operator()(const ListenerListValue &a, const ListenerListValue &b) const {
+		return priorityKey(a.priority) < priorityKey(b.priority);
+	}
+};
+
+////////// class EventTypeTable //////////
+
+/*-----------------------------------------------------------------------------
+	Publishes a new slot array of double the size with all entries reinserted.
+	The old array stays readable, find may be probing it on another thread.
+-----------------------------------------------------------------------------*/
+void EventTypeTable::grow()
+{
+	SlotArray *oldSa = mSlots;
+	SlotArray *sa = new SlotArray();
+	sa->slots.resize(oldSa->slots.size() * 2, (EventTypeEntry*)0);
+	sa->mask = static_cast<uint>(sa->slots.size()) - 1;
+
+	vector<EventTypeEntry*>::const_iterator si, end = oldSa->slots.end();
+	for (si = oldSa->slots.begin(); si != end; ++si) {
+		if (*si) {
+			uint i = (*si)->id & sa->mask;
+			while (sa->slots[i]) { i = (i + 1) & sa->mask; }
+			sa->slots[i] = *si;
+		}
+	}
+	InterlockedExchangePointer(reinterpret_cast<PVOID volatile *>(&mSlots), sa);
+	mOldSlots.push_back(oldSa);
+	debugPrintf("EventTypeTable: grown to %u slots\n", sa->slots.size());
+}
+
+/*-----------------------------------------------------------------------------
+	Publishes a new listener list for an entry, in either its listeners or its
+	wildcards, and retires the old one
+-----------------------------------------------------------------------------*/
+void EventTypeTable::publish(EventTypeEntry &entry, ListenerList * volatile &slot, ListenerList *list)
+{
+	ListenerList *oldList = slot;
+	InterlockedExchangePointer(reinterpret_cast<PVOID volatile *>(&slot), list);
+	RetiredList r = { &entry, oldList, (&slot == &entry.wildcards) };
+	mRetired.push_back(r);
+	InterlockedExchange(&mNumRetired, static_cast<LONG>(mRetired.size()));
+}
+
+/*-----------------------------------------------------------------------------
+	Builds the wildcard listeners whose mask includes the entry's category,
+	in the wildcard list's priority order
+-----------------------------------------------------------------------------*/
+static ListenerList * filterWildcards(const ListenerList &wildcardList, EventCategoryMask category)
+{
+	ListenerList *list = new ListenerList();
+	ListenerList::const_iterator li, end = wildcardList.end();
+	for (li = wildcardList.begin(); li != end; ++li) {
+		if (li->listener && (li->categories & category) != 0) list->push_back(*li);
+	}
+	return list;
+}
+
+/*-----------------------------------------------------------------------------
+	Publishes a new wildcards list for an entry, filtered by its category.
+	Skips the publish when nothing would change, which is the common case
+	for a wildcard listener with a narrow mask.
+-----------------------------------------------------------------------------*/
+void EventTypeTable::rebuildWildcards(EventTypeEntry &entry)
+{
+	if (!mWildcardEntry || &entry == mWildcardEntry) return;
+	ListenerList *list = filterWildcards(*mWildcardEntry->listeners, entry.category);
+	const ListenerList &current = *entry.wildcards;
+	bool same = (list->size() == current.size());
+	for (size_t l = 0; same && l < list->size(); ++l) {
+		same = ((*list)[l].listener == current[l].listener);
+	}
+	if (same) {
+		delete list;
+	} else {
+		publish(entry, entry.wildcards, list);
+	}
+}
+
+/*-----------------------------------------------------------------------------
+	Rebuilds the wildcards list of every entry
+-----------------------------------------------------------------------------*/
+void EventTypeTable::rebuildAllWildcards()
+{
+	const vector<EventTypeEntry*> &slots = mSlots->slots;
+	vector<EventTypeEntry*>::const_iterator si, end = slots.end();
+	for (si = slots.begin(); si != end; ++si) {
+		if (*si) rebuildWildcards(**si);
+	}
+}
+
+/*-----------------------------------------------------------------------------
+	Returns the existing entry for an id, or creates one. Asserts if the id
+	exists under a different name (a hash collision), in which case the
+	existing entry is still returned.
+-----------------------------------------------------------------------------*/
+EventTypeEntry * EventTypeTable::findOrInsert(EventTypeId id, const string &name)
+{
+	mutex::scoped_lock lock(mWriteMutex);
+	EventTypeEntry *e = find(id);
+	if (e) {
+		_ASSERTE(e->name == name && "EventTypeId collision, rename one of the event types");
+		if (e->name != name) {
+			debugPrintf("EventTypeTable: id collision between \"%s\" and \"%s\"\n", e->name.c_str(), name.c_str());
+		}
+		return e;
+	}
+	// keep load factor under 1/2 so probe sequences stay short
+	if ((mCount + 1) * 2 > mSlots->slots.size()) grow();
+
+	e = new EventTypeEntry(id, name);
+	rebuildWildcards(*e);
+	SlotArray &sa = *mSlots;
+	uint i = id & sa.mask;
+	while (sa.slots[i]) { i = (i + 1) & sa.mask; }
+	// the entry is complete before a reader can see it
+	InterlockedExchangePointer(reinterpret_cast<PVOID volatile *>(&sa.slots[i]), e);
+	++mCount;
+	return e;
+}
+
+/*-----------------------------------------------------------------------------
+	Publishes a copy of the entry's listener list with a listener inserted in
+	priority order with a binary search. Priority 1 is highest, and 0 (no
+	priority) sorts after all others. Equal priorities keep FIFO order, since
+	the upper bound puts the new one after them. Returns false if the
+	listener is already in the list.
+-----------------------------------------------------------------------------*/
+bool EventTypeTable::addListener(EventTypeEntry &entry, EventListener *lPtr, uint priority,
+								 const EventDelegate &delegate, const shared_ptr<IEventHandler> &handler,
+								 EventCategoryMask categories)
+{
+	mutex::scoped_lock lock(mWriteMutex);
+	if (!entry.listenerSet.insert(lPtr).second) return false;
+
+	const ListenerList &current = *entry.listeners;
+	ListenerList *list = new ListenerList();
+	list->reserve(current.size() + 1);
+	ListenerList::const_iterator li, end = current.end();
+	for (li = current.begin(); li != end; ++li) {
+		if (li->listener) list->push_back(*li);
+	}
+	ListenerListValue v(lPtr, priority, delegate, handler, categories);
+	list->insert(std::upper_bound(list->begin(), list->end(), v, ListenerPriorityLess()), v);
+	publish(entry, entry.listeners, list);
+	if (&entry == mWildcardEntry) rebuildAllWildcards();
+	return true;
+}
+
+/*-----------------------------------------------------------------------------
+	Publishes a copy of the entry's listener list without a listener, and
+	nulls its slot in the current and retired lists so that a dispatch still
+	iterating one of them skips it. For a wildcard listener that is also every
+	entry's current and retired wildcards lists. Other entries' listeners
+	lists are left alone, the listener may still be registered for their
+	types. Returns false if the listener isn't in the list.
+-----------------------------------------------------------------------------*/
+bool EventTypeTable::removeListener(EventTypeEntry &entry, EventListener *lPtr)
+{
+	mutex::scoped_lock lock(mWriteMutex);
+	if (entry.listenerSet.erase(lPtr) == 0) return false;
+
+	ListenerList *oldList = entry.listeners;
+	ListenerList *list = new ListenerList();
+	list->reserve(oldList->size());
+	ListenerList::iterator li, end = oldList->end();
+	for (li = oldList->begin(); li != end; ++li) {
+		if (li->listener == lPtr) {
+			li->listener = 0;
+		} else if (li->listener) {
+			list->push_back(*li);
+		}
+	}
+	bool wildcard = (&entry == mWildcardEntry);
+	vector<RetiredList>::const_iterator ri, rEnd = mRetired.end();
+	for (ri = mRetired.begin(); ri != rEnd; ++ri) {
+		// a wildcards list only holds wildcard registrations, a listeners list only the entry's own
+		if (ri->wildcards ? !wildcard : (ri->entry != &entry)) continue;
+		for (li = ri->list->begin(), end = ri->list->end(); li != end; ++li) {
+			if (li->listener == lPtr) li->listener = 0;
+		}
+	}
+	publish(entry, entry.listeners, list);
+	if (wildcard) {
+		const vector<EventTypeEntry*> &slots = mSlots->slots;
+		vector<EventTypeEntry*>::const_iterator si, sEnd = slots.end();
+		for (si = slots.begin(); si != sEnd; ++si) {
+			if (!*si) continue;
+			ListenerList &wl = *(*si)->wildcards;
+			for (li = wl.begin(), end = wl.end(); li != end; ++li) {
+				if (li->listener == lPtr) li->listener = 0;
+			}
+		}
+		rebuildAllWildcards();
+	}
+	return true;
+}
+
+/*-----------------------------------------------------------------------------
+	Sets the entry whose listeners are the wildcard listeners
+-----------------------------------------------------------------------------*/
+void EventTypeTable::setWildcardEntry(EventTypeEntry *entry)
+{
+	mutex::scoped_lock lock(mWriteMutex);
+	_ASSERTE(!mWildcardEntry && entry && entry->listenerSet.empty());
+	mWildcardEntry = entry;
+}
+
+/*-----------------------------------------------------------------------------
+	Sets an entry's category and rebuilds its wildcards list
+-----------------------------------------------------------------------------*/
+void EventTypeTable::setCategory(EventTypeEntry &entry, EventCategoryMask category)
+{
+	mutex::scoped_lock lock(mWriteMutex);
+	if (entry.category == category) return;
+	entry.category = category;
+	rebuildWildcards(entry);
+}
+
+/*-----------------------------------------------------------------------------
+	Frees retired listener lists. Only call from the main thread when it isn't
+	dispatching, it is the only reader of the lists.
+-----------------------------------------------------------------------------*/
+void EventTypeTable::reclaim()
+{
+	vector<RetiredList> retired;
+	{
+		mutex::scoped_lock lock(mWriteMutex);
+		retired.swap(mRetired);
+		InterlockedExchange(&mNumRetired, 0);
+	}
+	vector<RetiredList>::const_iterator ri, end = retired.end();
+	for (ri = retired.begin(); ri != end; ++ri) {
+		delete ri->list;
+	}
+}
+
+/*-----------------------------------------------------------------------------
+	Clears listener lists from all entries, registrations are kept
+-----------------------------------------------------------------------------*/
+void EventTypeTable::clearListeners()
+{
+	mutex::scoped_lock lock(mWriteMutex);
+	const vector<EventTypeEntry*> &slots = mSlots->slots;
+	vector<EventTypeEntry*>::const_iterator si, end = slots.end();
+	for (si = slots.begin(); si != end; ++si) {
+		if (!*si) continue;
+		if (!(*si)->listenerSet.empty()) {
+			(*si)->listenerSet.clear();
+			publish(**si, (*si)->listeners, new ListenerList());
+		}
+		if (!(*si)->wildcards->empty()) {
+			publish(**si, (*si)->wildcards, new ListenerList());
+		}
+	}
+}
+
+// Constructor / destructor
+EventTypeTable::EventTypeTable(uint initialSize) :
+	mSlots(new SlotArray()),
+	mWildcardEntry(0),
+	mOldSlots(),
+	mRetired(),
+	mNumRetired(0),
+	mCount(0),
+	mWriteMutex()
+{
+	// round up to a power of 2
+	uint size = 16;
+	while (size < initialSize) size <<= 1;
+	mSlots->slots.resize(size, (EventTypeEntry*)0);
+	mSlots->mask = size - 1;
+}
+
+EventTypeTable::~EventTypeTable()
+{
+	reclaim();
+	vector<EventTypeEntry*>::iterator si, end = mSlots->slots.end();
+	for (si = mSlots->slots.begin(); si != end; ++si) {
+		delete *si;
+		*si = 0;
+	}
+	delete mSlots;
+	for (vector<SlotArray*>::const_iterator oi = mOldSlots.begin(); oi != mOldSlots.end(); ++oi) {
+		delete *oi;
+	}
+}
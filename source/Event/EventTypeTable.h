@@ -0,0 +1,242 @@
+/*----==== EVENTTYPETABLE.H ====----
+	Author:		Jeff Kiah
+	Orig.Date:	10/17/2026
+	Rev.Date:	10/17/2026
+-----------------------------------*/
+
+#pragma once
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN	// defined in project settings
+#endif
+
+#include <Windows.h>
+#include <string>
+#include <vector>
+#include <memory>
+#include <hash_set>
+#include <boost/noncopyable.hpp>
+#include <boost/thread/mutex.hpp>
+#include "Event.h"
+#include "EventTypeId.h"
+#include "EventDelegate.h"
+#include "EventProfiler.h"
+#include "../Utility/Typedefs.h"
+
+using std::string;
+using std::vector;
+using std::shared_ptr;
+using stdext::hash_set;
+using boost::mutex;
+
+///// DEFINITIONS /////
+
+class EventListener;
+class IEventHandler;
+
+///// STRUCTURES /////
+
+/*=============================================================================
+struct ListenerListValue
+	One listener registered for an event type. If the listener subscribed
+	with a typed handler, the delegate is called directly, if it registered a
+	functor handler that is called, so dispatch never has to look in the
+	listener's handler map. The listener's handle function is the fallback.
+	A null listener is a slot removed after the list was published, see
+	EventTypeTable.
+=============================================================================*/
+struct ListenerListValue {
+	EventListener *				listener;
+	uint						priority;
+	EventDelegate				delegate;	// unbound for handlers registered through registerEventHandler
+	shared_ptr<IEventHandler>	handler;	// the handler registered through registerEventHandler, or null
+	EventCategoryMask			categories;	// for wildcard listeners, the categories they want
+
+	explicit ListenerListValue(EventListener *_listener, uint _priority, const EventDelegate &_delegate,
+							   const shared_ptr<IEventHandler> &_handler, EventCategoryMask _categories) :
+		listener(_listener), priority(_priority), delegate(_delegate), handler(_handler),
+		categories(_categories)
+	{}
+};
+
+typedef vector<ListenerListValue>	ListenerList;		// stores listeners along with their priority
+typedef hash_set<EventListener*>	ListenerSet;		// membership of a ListenerList, for duplicate checks
+
+/*=============================================================================
+struct EventTypeEntry
+	Everything EventManager knows about one event type, so a single lookup by
+	EventTypeId gets both the registration and the listeners. An entry is
+	created by whichever comes first, registerEventType or registerListener,
+	so regPtr is null until the type is actually registered.
+	The listener lists are immutable snapshots, dispatch reads the pointer
+	once and iterates without a lock. Only EventTypeTable changes them, by
+	publishing a new copy. wildcards is the wildcard listener list filtered
+	down to the ones whose category mask includes the type's category, kept
+	up to date by the table, so dispatch never tests a category.
+=============================================================================*/
+struct EventTypeEntry {
+	EventTypeId				id;
+	string					name;			// original type string, for debugging and collision checks
+	RegEventPtr				regPtr;			// registration metadata, null if not registered yet
+	EventCategoryMask		category;		// from the registration, General until registered
+	ListenerList * volatile	listeners;	// published snapshot, never null, in priority order then FIFO
+	ListenerList * volatile	wildcards;	// published snapshot of the wildcard listeners for the category
+	ListenerSet				listenerSet;	// every listener in the current snapshot, only touched by writers
+	ifEventProfiler(mutable EventTypeStats stats;)	// counted by EventManager, mutable since dispatch has a const entry
+
+	explicit EventTypeEntry(EventTypeId _id, const string &_name) :
+		id(_id), name(_name), regPtr(), category(EventCategory_General),
+		listeners(new ListenerList()), wildcards(new ListenerList()), listenerSet()
+	{}
+	~EventTypeEntry() { delete listeners; delete wildcards; }
+};
+
+/*=============================================================================
+class EventTypeTable
+	A flat open-addressed table of EventTypeEntry pointers indexed by the low
+	bits of EventTypeId, with linear probing. The id is already a good hash so
+	a lookup is a mask and usually a single compare. Entries are never removed
+	(the set of event types is small and bounded) so there is no tombstone
+	handling, and entry pointers stay valid for the life of the table, which
+	lets callers hang on to an entry instead of looking it up again.
+	**Read-copy-update**
+	Readers never lock. Writers (findOrInsert and the listener functions)
+	take mWriteMutex, so they can be called from any thread:
+	* The slot array is published by pointer. Growing builds a new array and
+	  swaps the pointer, the old array is kept until the table is destroyed
+	  since find is also called from worker threads, and it is smaller than
+	  the live array anyway. A new entry is fully built before its slot is set.
+	* Listener lists are copied, changed and published in place of the old
+	  list, which is retired rather than freed since the main thread may be
+	  iterating it. A removed listener's slot is also nulled in the retired
+	  lists of its entry, so a dispatch already in progress skips it.
+	  Listener lists are only read by the main thread, so EventManager calls
+	  reclaim when it is outside of dispatch to free the retired lists.
+	* Every change to the wildcard entry's list, and every category change,
+	  rebuilds the filtered wildcards lists the same way. Wildcard listeners
+	  and categories change rarely, dispatch happens constantly.
+=============================================================================*/
+class EventTypeTable : private boost::noncopyable {
+	private:
+		///// STRUCTURES /////
+		struct SlotArray {
+			uint					mask;	// slots.size() - 1
+			vector<EventTypeEntry*>	slots;	// size is always a power of 2, null is an empty slot
+		};
+		struct RetiredList {
+			EventTypeEntry *		entry;
+			ListenerList *			list;
+			bool					wildcards;	// was the entry's wildcards list rather than its listeners
+		};
+
+		///// VARIABLES /////
+		SlotArray * volatile	mSlots;		// published slot array
+		EventTypeEntry *		mWildcardEntry;	// listeners filtered into every other entry's wildcards
+		vector<SlotArray*>		mOldSlots;	// replaced by grow, freed with the table
+		vector<RetiredList>		mRetired;	// replaced listener lists waiting for reclaim
+		volatile LONG			mNumRetired;
+		uint					mCount;		// number of occupied slots
+		mutex					mWriteMutex;
+
+		///// FUNCTIONS /////
+		/*---------------------------------------------------------------------
+			Publishes a new slot array of double the size with all entries
+			reinserted. Called with the write lock held.
+		---------------------------------------------------------------------*/
+		void	grow();
+
+		/*---------------------------------------------------------------------
+			Publishes a new listener list for an entry and retires the old one.
+			Called with the write lock held.
+		---------------------------------------------------------------------*/
+		void	publish(EventTypeEntry &entry, ListenerList * volatile &slot, ListenerList *list);
+
+		/*---------------------------------------------------------------------
+			Publishes a new wildcards list for an entry, filtered by its
+			category. Called with the write lock held.
+		---------------------------------------------------------------------*/
+		void	rebuildWildcards(EventTypeEntry &entry);
+
+		/*---------------------------------------------------------------------
+			Rebuilds the wildcards list of every entry
+		---------------------------------------------------------------------*/
+		void	rebuildAllWildcards();
+
+	public:
+		/*---------------------------------------------------------------------
+			Returns the entry for an id, or null if the id has never been
+			seen. Lock free, safe from any thread.
+		---------------------------------------------------------------------*/
+		EventTypeEntry *	find(EventTypeId id) const {
+								const SlotArray &sa = *mSlots;
+								uint i = id & sa.mask;
+								for (;;) {
+									EventTypeEntry *e = sa.slots[i];
+									if (!e || e->id == id) return e;
+									i = (i + 1) & sa.mask;
+								}
+							}
+
+		/*---------------------------------------------------------------------
+			Returns the existing entry for an id, or creates one. Asserts if
+			the id exists under a different name (a hash collision), in which
+			case the existing entry is still returned.
+		---------------------------------------------------------------------*/
+		EventTypeEntry *	findOrInsert(EventTypeId id, const string &name);
+
+		/*---------------------------------------------------------------------
+			Sets the entry whose listeners are the wildcard listeners. Call
+			once, before any listener is added to it.
+		---------------------------------------------------------------------*/
+		void				setWildcardEntry(EventTypeEntry *entry);
+
+		/*---------------------------------------------------------------------
+			Sets an entry's category and rebuilds its wildcards list
+		---------------------------------------------------------------------*/
+		void				setCategory(EventTypeEntry &entry, EventCategoryMask category);
+
+		/*---------------------------------------------------------------------
+			Publishes the entry's listener list with a listener added in
+			priority order. Returns false if the listener is already in it.
+			categories only matters for the wildcard entry.
+		---------------------------------------------------------------------*/
+		bool				addListener(EventTypeEntry &entry, EventListener *lPtr, uint priority,
+										const EventDelegate &delegate, const shared_ptr<IEventHandler> &handler,
+										EventCategoryMask categories);
+
+		/*---------------------------------------------------------------------
+			Publishes the entry's listener list without a listener. Returns
+			false if the listener isn't in it.
+		---------------------------------------------------------------------*/
+		bool				removeListener(EventTypeEntry &entry, EventListener *lPtr);
+
+		/*---------------------------------------------------------------------
+			Frees retired listener lists. Only call from the main thread when
+			it isn't dispatching.
+		---------------------------------------------------------------------*/
+		void				reclaim();
+		bool				hasRetired() const { return (mNumRetired != 0); }
+
+		uint				size() const { return mCount; }
+
+		/*---------------------------------------------------------------------
+			Calls func(EventTypeEntry &) on every entry, in no particular order
+		---------------------------------------------------------------------*/
+		template <typename Func>
+		void				forEach(Func func) const {
+								const vector<EventTypeEntry*> &slots = mSlots->slots;
+								vector<EventTypeEntry*>::const_iterator si, end = slots.end();
+								for (si = slots.begin(); si != end; ++si) {
+									if (*si) func(**si);
+								}
+							}
+
+		/*---------------------------------------------------------------------
+			Clears listener lists from all entries, registrations are kept
+		---------------------------------------------------------------------*/
+		void				clearListeners();
+
+		// Constructor / destructor
+		explicit EventTypeTable(uint initialSize = 256);
+		~EventTypeTable();
+};
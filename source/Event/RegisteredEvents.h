@@ -1,7 +1,7 @@
 /*----==== REGISTEREDEVENT.H ====----
 	Author: Jeffrey Kiah
 	Orig.Date: 05/07/2009
-	Rev.Date:  05/07/2009
+	Rev.Date:  10/17/2026
 -----------------------------------*/
 
 #pragma once
@@ -20,12 +20,12 @@ class CodeOnlyEvent : public RegisteredEvent {
 			Should never even be called, scripting manager can check return of
 			scriptAllowed() to check whether or not to call this
 		---------------------------------------------------------------------*/
-		virtual bool triggerEventFromScript(const string &eventType, const AnyVars &eventData) const {
+		virtual bool triggerEventFromScript(const string &eventType, const ScriptVars &eventData) const {
 			_ASSERTE(false && "Tried to trigger code-only event from script"); // in a debug build will halt execution
 			// add message to release build logging
 			return false; // in release mode, just don't do anything
 		}
-		virtual bool raiseEventFromScript(const string &eventType, const AnyVars &eventData) const {
+		virtual bool raiseEventFromScript(const string &eventType, const ScriptVars &eventData, ulong delayMillis) const {
 			_ASSERTE(false && "Tried to raise code-only event from script");
 			// add message to release build logging
 			return false;
@@ -50,28 +50,36 @@ template <typename TEventType>
 class ScriptCallableCodeEvent : public RegisteredEvent {
 	public:
 		/*---------------------------------------------------------------------
-			Creates the event using the event's AnyVars constructor to pass in
+			Creates the event using the event's ScriptVars constructor to pass in
 			event data. This implies that all script callable code-defined
-			event types must implement an AnyVars constructor. Then, calls
+			event types must implement a ScriptVars constructor. Then, calls
 			EventManager::trigger.
 		---------------------------------------------------------------------*/
-		virtual bool triggerEventFromScript(const string &eventType, const AnyVars &eventData) const {
-			if (isEmpty()) { // handle empty events as a special case, avoid calling the AnyVars constructor
+		virtual bool triggerEventFromScript(const string &eventType, const ScriptVars &eventData) const {
+			if (isEmpty()) { // handle empty events as a special case, avoid calling the ScriptVars constructor
 				events.trigger(eventType);
 				return true;
-			} else { // for all non-empty events, call the AnyVars constructor
-				EventPtr ePtr(new TEventType(eventData)); // use the event type's AnyVars constructor
+			} else { // for all non-empty events, call the ScriptVars constructor
+				EventPtr ePtr(new TEventType(eventData)); // use the event type's ScriptVars constructor
 				events.trigger(ePtr);
 				return true;
 			}
 		}
-		virtual bool raiseEventFromScript(const string &eventType, const AnyVars &eventData) const {
+		virtual bool raiseEventFromScript(const string &eventType, const ScriptVars &eventData, ulong delayMillis) const {
 			if (isEmpty()) {
-				events.raise(eventType);
+				if (delayMillis > 0) {
+					events.raiseAfter(eventType, delayMillis);
+				} else {
+					events.raise(eventType);
+				}
 				return true;
 			} else {
 				EventPtr ePtr(new TEventType(eventData));
-				events.raise(ePtr);
+				if (delayMillis > 0) {
+					events.raiseAfter(ePtr, delayMillis);
+				} else {
+					events.raise(ePtr);
+				}
 				return true;
 			}
 		}
@@ -97,23 +105,30 @@ class ScriptDefinedEvent : public RegisteredEvent {
 			Creates a ScriptEvent, passing any data through the srcData
 			parameter. Then, calls EventManager::trigger.
 		---------------------------------------------------------------------*/
-		virtual bool triggerEventFromScript(const string &eventType, const AnyVars &eventData) const {
+		virtual bool triggerEventFromScript(const string &eventType, const ScriptVars &eventData) const {
 			EventPtr ePtr(new ScriptEvent(eventType, eventData));
 			events.trigger(ePtr);
 			return true;
 		}
-		virtual bool raiseEventFromScript(const string &eventType, const AnyVars &eventData) const {
+		virtual bool raiseEventFromScript(const string &eventType, const ScriptVars &eventData, ulong delayMillis) const {
 			EventPtr ePtr(new ScriptEvent(eventType, eventData));
-			events.raise(ePtr);
+			if (delayMillis > 0) {
+				events.raiseAfter(ePtr, delayMillis);
+			} else {
+				events.raise(ePtr);
+			}
 			return true;
 		}
 
 		/*---------------------------------------------------------------------
 			Construct this object as a script-only event. Script-defined events
 			are never considered empty, but they can choose to pass no data.
+			They are in the Scripting category.
 		---------------------------------------------------------------------*/
 		explicit ScriptDefinedEvent() :
 			RegisteredEvent(EventSource_ScriptOnly, EventDataType_NotEmpty)
-		{}
+		{
+			setCategory(EventCategory_Scripting);
+		}
 		virtual ~ScriptDefinedEvent() {}
 };
\ No newline at end of file
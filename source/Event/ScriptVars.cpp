@@ -0,0 +1,225 @@
+/*----==== SCRIPTVARS.CPP ====----
+	Author:		Jeff Kiah
+	Orig.Date:	10/17/2026
+	Rev.Date:	10/17/2026
+--------------------------------*/
+
+#include "ScriptVars.h"
+#include <cctype>
+#include <cstring>
+#include <hash_map>
+#include <boost/thread/shared_mutex.hpp>
+#include <boost/thread/locks.hpp>
+
+using stdext::hash_map;
+using boost::shared_mutex;
+using boost::shared_lock;
+using boost::unique_lock;
+
+///// VARIABLES /////
+
+namespace {
+	// lower case name to the name as first interned, hash_map nodes don't
+	// move, so the spelled name's buffer is stable
+	typedef hash_map<string, string>	InternMap;
+
+	/*-------------------------------------------------------------------------
+		The table and its lock are function statics so keys can be interned
+		from other statics' initializers
+	-------------------------------------------------------------------------*/
+	InternMap &internNames()
+	{
+		static InternMap sNames;
+		return sNames;
+	}
+
+	shared_mutex &internMutex()
+	{
+		static shared_mutex sMutex;
+		return sMutex;
+	}
+
+	string lowerName(const char *name)
+	{
+		string lower(name);
+		for (string::iterator c = lower.begin(); c != lower.end(); ++c) {
+			*c = static_cast<char>(tolower(static_cast<uchar>(*c)));
+		}
+		return lower;
+	}
+}
+
+////////// struct ScriptVarKey //////////
+
+uint ScriptVarKey::hashName(const char *name)
+{
+	uint id = 2166136261U;
+	for (const char *c = name; *c != '\0'; ++c) {
+		id ^= static_cast<uint>(tolower(static_cast<uchar>(*c)));
+		id *= 16777619U;
+	}
+	return (id == 0) ? 1 : id; // 0 is the index key
+}
+
+/*-----------------------------------------------------------------------------
+	Returns the key for a name, adding it to the intern table the first time
+	it is seen. The table is keyed by the lower case name itself, so names
+	whose hashes collide are still different keys. Thread-safe, but takes a
+	lock.
+-----------------------------------------------------------------------------*/
+ScriptVarKey ScriptVarKey::intern(const char *name)
+{
+	_ASSERTE(name && name[0] != '\0');
+	string lower(lowerName(name));
+
+	unique_lock<shared_mutex> lock(internMutex());
+	InternMap &names = internNames();
+	InternMap::iterator i = names.find(lower);
+	if (i == names.end()) {
+		i = names.insert(InternMap::value_type(lower, string(name))).first;
+	}
+	ScriptVarKey k = { hashName(name), i->second.c_str() };
+	return k;
+}
+
+/*-----------------------------------------------------------------------------
+	For keys from script data. Returns the interned key if the name has been
+	interned, otherwise a key holding its own copy of the name, so script
+	tables with arbitrary keys don't grow the table.
+-----------------------------------------------------------------------------*/
+ScriptVarKey ScriptVarKey::fromScript(const char *name)
+{
+	_ASSERTE(name);
+	string lower(lowerName(name));
+	{
+		shared_lock<shared_mutex> lock(internMutex());
+		const InternMap &names = internNames();
+		InternMap::const_iterator i = names.find(lower);
+		if (i != names.end()) {
+			ScriptVarKey k = { hashName(name), i->second.c_str() };
+			return k;
+		}
+	}
+	shared_ptr<const string> ownName(std::make_shared<string>(name));
+	ScriptVarKey k = { hashName(name), ownName->c_str(), ownName };
+	return k;
+}
+
+////////// class ScriptValue //////////
+
+ScriptValue::ScriptValue(const string &val) :
+	mType(ScriptValue_String),
+	mRef(std::make_shared<string>(val))
+{
+	mNum.i = 0;
+}
+
+ScriptValue::ScriptValue(const char *val) :
+	mType(ScriptValue_String),
+	mRef(std::make_shared<string>(val))
+{
+	mNum.i = 0;
+}
+
+ScriptValue::ScriptValue(const ScriptVars &val) :
+	mType(ScriptValue_Vars),
+	mRef(std::make_shared<ScriptVars>(val))
+{
+	mNum.i = 0;
+}
+
+ScriptValue::ScriptValue(const any &val) :
+	mType(ScriptValue_Object),
+	mRef(std::make_shared<any>(val))
+{
+	mNum.i = 0;
+}
+
+////////// class ScriptVars //////////
+
+/*-----------------------------------------------------------------------------
+	Returns the value for a key, or 0 if it isn't in the list
+-----------------------------------------------------------------------------*/
+const ScriptValue * ScriptVars::find(const ScriptVarKey &key) const
+{
+	for (const_iterator i = begin(), e = end(); i != e; ++i) {
+		if (i->key == key) return &i->value;
+	}
+	return 0;
+}
+
+void ScriptVars::push_back(const ScriptVarKey &key, const ScriptValue &value)
+{
+	if (mSize < SCRIPTVARS_INLINE_SIZE) {
+		mInline[mSize].key = key;
+		mInline[mSize].value = value;
+	} else {
+		if (mSize == SCRIPTVARS_INLINE_SIZE) { // spill, move the inline entries out first
+			mHeap.reserve(SCRIPTVARS_INLINE_SIZE * 2);
+			mHeap.assign(mInline, mInline + SCRIPTVARS_INLINE_SIZE);
+			for (uint e = 0; e < SCRIPTVARS_INLINE_SIZE; ++e) {
+				mInline[e].value = ScriptValue(); // let go of any shared data
+			}
+		}
+		ScriptVar v = { key, value };
+		mHeap.push_back(v);
+	}
+	++mSize;
+}
+
+/*-----------------------------------------------------------------------------
+	Empties the list, keeping the heap capacity
+-----------------------------------------------------------------------------*/
+void ScriptVars::clear()
+{
+	uint numInline = (mSize < SCRIPTVARS_INLINE_SIZE) ? mSize : SCRIPTVARS_INLINE_SIZE;
+	for (uint e = 0; e < numInline; ++e) {
+		mInline[e].value = ScriptValue();
+	}
+	mHeap.clear();
+	mSize = 0;
+}
+
+////////// class IScriptDataWriter //////////
+
+/*-----------------------------------------------------------------------------
+	Writes every entry of a ScriptVars, recursing into nested ones. Object
+	values can't be written generically and are skipped.
+-----------------------------------------------------------------------------*/
+void IScriptDataWriter::write(const ScriptVars &vars)
+{
+	for (ScriptVars::const_iterator i = vars.begin(), e = vars.end(); i != e; ++i) {
+		const ScriptValue &v = i->value;
+		switch (v.type()) {
+			case ScriptValue_Int:		setInt(i->key, v.asInt()); break;
+			case ScriptValue_Float:		setFloat(i->key, v.asFloat()); break;
+			case ScriptValue_Bool:		setBool(i->key, v.asBool()); break;
+			case ScriptValue_String:	setString(i->key, v.asString()); break;
+			case ScriptValue_Vars:
+				beginTable(i->key);
+				write(v.asVars());
+				endTable();
+				break;
+			default:
+				break;
+		}
+	}
+}
+
+////////// class ScriptVarsWriter //////////
+
+void ScriptVarsWriter::beginTable(const ScriptVarKey &key)
+{
+	mOpen.push_back(OpenTable());
+	mOpen.back().key = key;
+}
+
+void ScriptVarsWriter::endTable()
+{
+	_ASSERTE(!mOpen.empty());
+	OpenTable &t = mOpen.back();
+	ScriptValue table(t.vars);
+	ScriptVarKey key = t.key;
+	mOpen.pop_back();
+	current().push_back(key, table);
+}
@@ -0,0 +1,265 @@
+/*----==== SCRIPTVARS.H ====----
+	Author:		Jeff Kiah
+	Orig.Date:	10/17/2026
+	Rev.Date:	10/17/2026
+------------------------------*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstring>
+#include <boost/any.hpp>
+#include "../Utility/Typedefs.h"
+
+using std::string;
+using std::vector;
+using std::shared_ptr;
+using boost::any;
+
+///// DEFINITIONS /////
+
+#define SCRIPTVARS_INLINE_SIZE	4	// entries stored in the ScriptVars itself before spilling to the heap
+
+class ScriptVars;
+
+///// STRUCTURES /////
+
+/*=============================================================================
+struct ScriptVarKey
+	A script data key, matched case-insensitively so "actorid" from script
+	matches "actorID" in code, the same as the _stricmp the events used to
+	do. Keys that code declares are interned: name points into the intern
+	table (spelled as it was first interned) and is valid for the life of
+	the program, and two interned keys are equal only if they are the same
+	entry, a pointer compare. Keys read from script that aren't in the table
+	(see fromScript) hold their own copy of the name instead, so arbitrary
+	script keys never grow the table. Those compare by name, with the id, a
+	case-insensitive hash of the name, checked first to skip most of the
+	string compares. Id 0 is the array element key, an entry with it becomes
+	the next 1-based index of a Lua table.
+	Intern keys once into statics and compare those, rather than interning
+	in a hot path:
+		static const ScriptVarKey sActorIDKey(ScriptVarKey::intern("actorID"));
+=============================================================================*/
+struct ScriptVarKey {
+	uint					id;
+	const char *			name;
+	shared_ptr<const string>	ownName;	// set for keys that aren't interned, name points into it
+
+	bool	isIndex() const		{ return (id == 0); }
+	bool	isInterned() const	{ return !ownName; }
+	bool	operator==(const ScriptVarKey &k) const {
+				if (name == k.name) return true;
+				if (id != k.id || id == 0 || (isInterned() && k.isInterned())) return false;
+				return (_stricmp(name, k.name) == 0);
+			}
+	bool	operator!=(const ScriptVarKey &k) const { return !(*this == k); }
+
+	/*---------------------------------------------------------------------
+		Returns the key for a name, adding it to the intern table the
+		first time it is seen. For the fixed key sets that code declares.
+		Thread-safe, but takes a lock.
+	---------------------------------------------------------------------*/
+	static ScriptVarKey	intern(const char *name);
+	static ScriptVarKey	intern(const string &name) { return intern(name.c_str()); }
+
+	/*---------------------------------------------------------------------
+		For keys from script data. Returns the interned key if the name has
+		been interned, otherwise a key holding its own copy of the name.
+		Never adds to the table, and only takes a shared (reader) lock.
+	---------------------------------------------------------------------*/
+	static ScriptVarKey	fromScript(const char *name);
+
+	static ScriptVarKey	index() { ScriptVarKey k = { 0, "" }; return k; }
+
+	/*---------------------------------------------------------------------
+		Case-insensitive FNV-1a hash of the name, never 0
+	---------------------------------------------------------------------*/
+	static uint			hashName(const char *name);
+};
+
+/*=============================================================================
+	Types a ScriptValue can hold
+=============================================================================*/
+enum ScriptValueType : uchar {
+	ScriptValue_Nil = 0,
+	ScriptValue_Int,
+	ScriptValue_Float,
+	ScriptValue_Bool,
+	ScriptValue_String,		// shared, immutable
+	ScriptValue_Vars,		// nested ScriptVars, shared, immutable
+	ScriptValue_Object		// anything else (a LuaObject for script-defined events), shared, immutable
+};
+
+/*=============================================================================
+class ScriptValue
+	Inline variant for script data. Numbers and bools are stored in place, so
+	they never allocate. Strings, nested tables and objects are held by shared
+	pointer and treated as immutable, so copying a value (or a whole
+	ScriptVars) never deep copies. Getters return false on a type mismatch
+	instead of throwing, except that an int can be read as a float.
+=============================================================================*/
+class ScriptValue {
+	private:
+		///// VARIABLES /////
+		ScriptValueType	mType;
+		union {
+			int		i;
+			float	f;
+			bool	b;
+		} mNum;
+		shared_ptr<const void>	mRef;	// string, ScriptVars or any, by mType
+
+	public:
+		ScriptValueType	type() const	{ return mType; }
+		bool			isNil() const	{ return (mType == ScriptValue_Nil); }
+
+		bool	get(int &out) const		{ if (mType != ScriptValue_Int) return false; out = mNum.i; return true; }
+		bool	get(bool &out) const	{ if (mType != ScriptValue_Bool) return false; out = mNum.b; return true; }
+		bool	get(float &out) const	{
+					if (mType == ScriptValue_Float) { out = mNum.f; return true; }
+					if (mType == ScriptValue_Int) { out = static_cast<float>(mNum.i); return true; }
+					return false;
+				}
+
+		// Unchecked, only call after checking type()
+		int					asInt() const		{ return mNum.i; }
+		float				asFloat() const		{ return mNum.f; }
+		bool				asBool() const		{ return mNum.b; }
+		const string &		asString() const	{ return *static_cast<const string *>(mRef.get()); }
+		const ScriptVars &	asVars() const		{ return *static_cast<const ScriptVars *>(mRef.get()); }
+		const any &			asObject() const	{ return *static_cast<const any *>(mRef.get()); }
+
+		// Constructors
+		ScriptValue() : mType(ScriptValue_Nil) { mNum.i = 0; }
+		ScriptValue(int val) : mType(ScriptValue_Int) { mNum.i = val; }
+		ScriptValue(float val) : mType(ScriptValue_Float) { mNum.f = val; }
+		ScriptValue(bool val) : mType(ScriptValue_Bool) { mNum.i = 0; mNum.b = val; }
+		ScriptValue(const string &val);
+		ScriptValue(const char *val);	// otherwise a literal would convert to bool
+		ScriptValue(const ScriptVars &val);
+		/*---------------------------------------------------------------------
+			Explicit, so that no other type ends up here by accident
+		---------------------------------------------------------------------*/
+		explicit ScriptValue(const any &val);
+};
+
+/*=============================================================================
+struct ScriptVar
+	One key/value entry of a ScriptVars
+=============================================================================*/
+struct ScriptVar {
+	ScriptVarKey	key;
+	ScriptValue		value;
+};
+
+/*=============================================================================
+class ScriptVars
+	Flat list of script data entries, replacing the list<pair<string, any>>
+	that events used to carry. The first SCRIPTVARS_INLINE_SIZE entries live
+	in the object itself, after that they move to one heap array. Entries
+	stay in insertion order and are contiguous either way, so iterating is a
+	pointer walk, and find is a linear scan comparing integer keys (lists
+	are short).
+=============================================================================*/
+class ScriptVars {
+	public:
+		///// DEFINITIONS /////
+		typedef const ScriptVar *	const_iterator;
+
+	private:
+		///// VARIABLES /////
+		ScriptVar			mInline[SCRIPTVARS_INLINE_SIZE];
+		vector<ScriptVar>	mHeap;		// all of the entries once there are more than fit inline
+		uint				mSize;
+
+		ScriptVar *			data()			{ return (mSize > SCRIPTVARS_INLINE_SIZE) ? &mHeap[0] : mInline; }
+		const ScriptVar *	data() const	{ return (mSize > SCRIPTVARS_INLINE_SIZE) ? &mHeap[0] : mInline; }
+
+	public:
+		uint				size() const	{ return mSize; }
+		bool				empty() const	{ return (mSize == 0); }
+		const_iterator		begin() const	{ return data(); }
+		const_iterator		end() const		{ return data() + mSize; }
+		const ScriptVar &	front() const	{ _ASSERTE(mSize > 0); return data()[0]; }
+		const ScriptVar &	operator[](uint i) const { _ASSERTE(i < mSize); return data()[i]; }
+
+		/*---------------------------------------------------------------------
+			Returns the value for a key, or 0 if it isn't in the list
+		---------------------------------------------------------------------*/
+		const ScriptValue *	find(const ScriptVarKey &key) const;
+
+		void	push_back(const ScriptVarKey &key, const ScriptValue &value);
+		void	reserve(uint count) { if (count > SCRIPTVARS_INLINE_SIZE) mHeap.reserve(count); }
+
+		/*---------------------------------------------------------------------
+			Empties the list, keeping the heap capacity
+		---------------------------------------------------------------------*/
+		void	clear();
+
+		// Constructor
+		explicit ScriptVars() : mSize(0) {}
+};
+
+/*=============================================================================
+class IScriptDataWriter
+	Receives script data from an event field by field. ScriptableEvents write
+	their native fields to it in writeScriptData, so the Lua handler can set
+	them straight into a Lua table without building a ScriptVars, and
+	ScriptVarsWriter builds a ScriptVars from the same calls when one is
+	actually needed. Index keys (ScriptVarKey::index) append array elements.
+=============================================================================*/
+class IScriptDataWriter {
+	public:
+		virtual void	setInt(const ScriptVarKey &key, int val) = 0;
+		virtual void	setFloat(const ScriptVarKey &key, float val) = 0;
+		virtual void	setBool(const ScriptVarKey &key, bool val) = 0;
+		virtual void	setString(const ScriptVarKey &key, const string &val) = 0;
+		/*---------------------------------------------------------------------
+			Starts a nested table, the sets that follow go into it until the
+			matching endTable
+		---------------------------------------------------------------------*/
+		virtual void	beginTable(const ScriptVarKey &key) = 0;
+		virtual void	endTable() = 0;
+
+		/*---------------------------------------------------------------------
+			Writes every entry of a ScriptVars, recursing into nested ones.
+			Object values can't be written generically and are skipped.
+		---------------------------------------------------------------------*/
+		void			write(const ScriptVars &vars);
+
+		virtual ~IScriptDataWriter() {}
+};
+
+/*=============================================================================
+class ScriptVarsWriter
+	IScriptDataWriter that fills in a ScriptVars. Nested tables are built
+	in their own ScriptVars and added to the parent when they end.
+=============================================================================*/
+class ScriptVarsWriter : public IScriptDataWriter {
+	private:
+		///// STRUCTURES /////
+		struct OpenTable {
+			ScriptVarKey	key;
+			ScriptVars		vars;
+		};
+
+		///// VARIABLES /////
+		ScriptVars &		mRoot;
+		vector<OpenTable>	mOpen;		// nested tables being written, innermost last
+
+		ScriptVars &	current() { return mOpen.empty() ? mRoot : mOpen.back().vars; }
+
+	public:
+		virtual void	setInt(const ScriptVarKey &key, int val)				{ current().push_back(key, ScriptValue(val)); }
+		virtual void	setFloat(const ScriptVarKey &key, float val)			{ current().push_back(key, ScriptValue(val)); }
+		virtual void	setBool(const ScriptVarKey &key, bool val)				{ current().push_back(key, ScriptValue(val)); }
+		virtual void	setString(const ScriptVarKey &key, const string &val)	{ current().push_back(key, ScriptValue(val)); }
+		virtual void	beginTable(const ScriptVarKey &key);
+		virtual void	endTable();
+
+		explicit ScriptVarsWriter(ScriptVars &root) : mRoot(root) {}
+		virtual ~ScriptVarsWriter() { _ASSERTE(mOpen.empty() && "ScriptVarsWriter: unbalanced beginTable"); }
+};
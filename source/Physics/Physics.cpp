@@ -1,15 +1,18 @@
 /*----==== PHYSICS.CPP ====----
 	Author:		Jeff Kiah
 	Orig.Date:	03/02/2010
-	Rev.Date:	03/02/2010
+	Rev.Date:	10/17/2026
 -----------------------------*/
 
 #include "Physics.h"
 #include "PhysicsEvents.h"
 #include "RigidBody.h"
 #include "../Utility/Typedefs.h"
+#include "../Process/JobSystem.h"
 #include "../Event/EventManager.h"
 #include "../Event/RegisteredEvents.h"
+#include "../Event/EventPool.h"
+#include "../Event/EventSerialization.h"
 
 ////////// class PhysicsProcess //////////
 
@@ -28,7 +31,7 @@ void PhysicsProcess::onUpdate(float deltaMillis)
 	}
 	// get interpolation value between previous and next state
 	mAlpha = mAccumulator * mInverseFixedDT;
-	// interpolate and send ActorMoved events using for all active objects in scene
+	// interpolate and send one ActorTransformBatch event for all active objects in scene
 	sendInterpolatedStates(mAlpha);
 }
 
@@ -53,11 +56,23 @@ void PhysicsProcess::onTogglePause()
 
 /*---------------------------------------------------------------------
 	For all active objects in scene, interpolates previous and current
-	state, and raises ActorMoved event
+	state, and raises a single ActorTransformBatch event for all of them.
+	The batch from the previous frame is reused if the event system has
+	released it, so once the arrays have grown to the size of the scene
+	this doesn't allocate.
 ---------------------------------------------------------------------*/
-void PhysicsProcess::sendInterpolatedStates(const float alpha) const
+void PhysicsProcess::sendInterpolatedStates(const float alpha)
 {
 	if (!mScene.mActorList.empty()) {
+		uint numActors = static_cast<uint>(mScene.mActorList.size());
+		if (mBatchPtr && mBatchPtr.unique()) {
+			mBatchPtr->reset();
+			mBatchPtr->reserve(numActors);
+		} else {
+			// first frame, or the last batch is still queued or held by a listener
+			mBatchPtr = makeEvent<ActorTransformBatchEvent>(ActorMovedEvent::System_Physics, numActors);
+		}
+
 		PhysicsScene::PhysicsActorList::const_iterator li = mScene.mActorList.begin();
 		PhysicsScene::PhysicsActorList::const_iterator end = mScene.mActorList.end();
 		while (li != end) {
@@ -65,16 +80,15 @@ void PhysicsProcess::sendInterpolatedStates(const float alpha) const
 			PhysicsActor &actor = *(*li);
 			actor.calcInterpolatedState(alpha);
 			const State *outState = actor.getInterpolatedState();
-			// create and raise the ActorMoved event
+			// add it to the batch
 			if (outState) {
-				EventPtr ePtr(new ActorMovedEvent(	actor.actorID(),
-													outState->position(),
-													outState->orientation(),
-													ActorMovedEvent::System_Physics));
-				events.raise(ePtr);
+				mBatchPtr->push(actor.actorID(), outState->position(), outState->orientation());
 			}
 			++li;
 		}
+		if (!mBatchPtr->empty()) {
+			events.raise(mBatchPtr);
+		}
 	}
 }
 
@@ -91,25 +105,59 @@ PhysicsProcess::PhysicsProcess(const string &name, const float fixedDT,
 	} else if (fixedDT > 0.1f) {
 		debugPrintf("%s: Warning! High fixed timestep, > 0.1 s\n", name.c_str());
 	}
+	// stays on the main thread since it raises events, but only waits on processes touching physics
+	setDataAccess(CProcessData_Physics, CProcessData_Physics);
 	// register event type(s)
-	events.registerEventType(ActorMovedEvent::sEventType,
-							 RegEventPtr(new ScriptCallableCodeEvent<ActorMovedEvent>(EventDataType_NotEmpty)));
+	RegEventPtr movedRegPtr(new ScriptCallableCodeEvent<ActorMovedEvent>(EventDataType_NotEmpty));
+	movedRegPtr->setCoalesceKeyFunc(&ActorMovedEvent::coalesceKey);
+	movedRegPtr->setReadEventFunc(&deserializeEvent<ActorMovedEvent>);
+	movedRegPtr->setCategory(EventCategory_Physics);
+	events.registerEventType(ActorMovedEvent::sEventType, movedRegPtr);
+	RegEventPtr batchRegPtr(new ScriptCallableCodeEvent<ActorTransformBatchEvent>(EventDataType_NotEmpty));
+	batchRegPtr->setReadEventFunc(&deserializeEvent<ActorTransformBatchEvent>);
+	batchRegPtr->setCategory(EventCategory_Physics);
+	events.registerEventType(ActorTransformBatchEvent::sEventType, batchRegPtr);
 }
 
 ////////// class PhysicsScene //////////
 
 /*---------------------------------------------------------------------
-	Integrates all active objects in scene
+	Integrates all active objects in scene. Actors integrate independently
+	of each other, so once there are enough of them they are split over
+	the JobSystem and joined before returning.
 ---------------------------------------------------------------------*/
 void PhysicsScene::update(float t, float dt)
 {
-	if (!mActorList.empty()) {
+	if (mActorList.empty()) return;
+
+	uint numActors = static_cast<uint>(mActorList.size());
+	if (numActors < PHYSICS_JOB_GRAIN * 2 || !JobSystem::exists()) {
 		PhysicsActorList::const_iterator li = mActorList.begin();
 		PhysicsActorList::const_iterator end = mActorList.end();
 		while (li != end) {
 			(*li)->update(t, dt);
 			++li;
 		}
+		return;
+	}
+
+	mUpdateList.clear();
+	PhysicsActorList::const_iterator li, end = mActorList.end();
+	for (li = mActorList.begin(); li != end; ++li) {
+		mUpdateList.push_back(li->get());
+	}
+	UpdateJob job = { &mUpdateList[0], t, dt };
+	jobSys.parallelFor(numActors, PHYSICS_JOB_GRAIN, &PhysicsScene::updateRange, &job);
+}
+
+/*---------------------------------------------------------------------
+	Job function, integrates actors [begin, end) of the update list
+---------------------------------------------------------------------*/
+void PhysicsScene::updateRange(uint begin, uint end, void *param)
+{
+	const UpdateJob &job = *static_cast<const UpdateJob*>(param);
+	for (uint a = begin; a < end; ++a) {
+		job.actors[a]->update(job.t, job.dt);
 	}
 }
 
@@ -141,9 +189,8 @@ PhysicsScene::PhysicsScene()
 /*---------------------------------------------------------------------
 	Some display setting was changed, requiring a reset of the device
 ---------------------------------------------------------------------*/
-bool PhysicsScene::PhysicsSceneListener::handleActorMoved(const EventPtr &ePtr)
+bool PhysicsScene::PhysicsSceneListener::handleActorMoved(const ActorMovedEvent &e)
 {
-	ActorMovedEvent &e = *(static_cast<ActorMovedEvent*>(ePtr.get()));
 	if (e.systemGen != ActorMovedEvent::System_Physics) {
 		debugPrintf("%s: Handled the Actor moved event!\n", name().c_str());
 	} else {
@@ -157,8 +204,7 @@ PhysicsScene::PhysicsSceneListener::PhysicsSceneListener(PhysicsScene &scene) :
 	mScene(scene)
 {
 	// register event handlers
-	IEventHandlerPtr p(new EventHandler<PhysicsSceneListener>(this, &PhysicsSceneListener::handleActorMoved));
-	registerEventHandler(ActorMovedEvent::sEventType, p, 0); // this is a FIFO listener
+	subscribe(this, &PhysicsSceneListener::handleActorMoved); // this is a FIFO listener
 }
 
 ////////// class PhysicsActor //////////
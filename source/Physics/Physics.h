@@ -1,25 +1,32 @@
 /*----==== PHYSICS.H ====----
 	Author:		Jeff Kiah
 	Orig.Date:	03/02/2010
-	Rev.Date:	03/02/2010
+	Rev.Date:	10/17/2026
 ---------------------------*/
 
 #pragma once
 
 #include <list>
+#include <vector>
 #include <memory>
 #include <boost/noncopyable.hpp>
 #include "../Process/ProcessManager.h"
 #include "../Event/EventListener.h"
 
 using std::list;
+using std::vector;
 using std::shared_ptr;
 
 ///// DEFINITIONS /////
 
+#define PHYSICS_JOB_GRAIN	64	// fewest actors integrated per job
+
 class PhysicsScene;
 class PhysicsActor;
+class ActorMovedEvent;
+class ActorTransformBatchEvent;
 typedef shared_ptr<PhysicsActor>	PhysicsActorPtr;
+typedef shared_ptr<ActorTransformBatchEvent>	ActorTransformBatchPtr;
 
 ///// STRUCTURES /////
 
@@ -37,12 +44,14 @@ class PhysicsProcess : public CProcess {
 		
 		PhysicsScene &mScene;	// reference to the PhysicsScene that started this process
 
+		ActorTransformBatchPtr	mBatchPtr;	// last batch raised, reused when the event system is done with it
+
 		///// FUNCTIONS /////
 		/*---------------------------------------------------------------------
 			For all active objects in scene, interpolates previous and current
-			state, and raises ActorMoved event
+			state, and raises a single ActorTransformBatch event
 		---------------------------------------------------------------------*/
-		void sendInterpolatedStates(const float alpha) const;
+		void sendInterpolatedStates(const float alpha);
 
 	public:
 		virtual void onUpdate(float deltaMillis);
@@ -73,15 +82,24 @@ class PhysicsScene : private boost::noncopyable {
 			friend class PhysicsScene;
 			private:
 				PhysicsScene &	mScene;
-				bool handleActorMoved(const EventPtr &ePtr);
+				bool handleActorMoved(const ActorMovedEvent &e);
 			public:
 				explicit PhysicsSceneListener(PhysicsScene &scene);
 		};
 
+		struct UpdateJob {
+			PhysicsActor * const *	actors;
+			float					t, dt;
+		};
+
 		///// VARIABLES /////
 		PhysicsActorList	mActorList;
 		CProcessPtr			mIntegratorProcPtr;	// pointer to the PhysicsProcess
-		
+		vector<PhysicsActor*>	mUpdateList;	// actors copied out of the list for random access by update jobs
+
+		///// FUNCTIONS /////
+		static void	updateRange(uint begin, uint end, void *param);
+
 	public:
 		///// FUNCTIONS /////
 		/*---------------------------------------------------------------------
@@ -1,31 +1,73 @@
 /*----==== PHYSICSEVENTS.CPP ====----
 	Author:		Jeff Kiah
 	Orig.Date:	03/02/2010
-	Rev.Date:	03/02/2010
+	Rev.Date:	10/17/2026
 -----------------------------------*/
 
 #include "PhysicsEvents.h"
+#include "../Event/EventSerialization.h"
+
+///// VARIABLES /////
+
+// Interned once, script data is matched on these rather than by string compare
+static const ScriptVarKey sActorIDKey		= ScriptVarKey::intern("actorID");
+static const ScriptVarKey sNewPositionXKey	= ScriptVarKey::intern("newPositionX");
+static const ScriptVarKey sNewPositionYKey	= ScriptVarKey::intern("newPositionY");
+static const ScriptVarKey sNewPositionZKey	= ScriptVarKey::intern("newPositionZ");
+static const ScriptVarKey sNewRotationWKey	= ScriptVarKey::intern("newRotationW");
+static const ScriptVarKey sNewRotationXKey	= ScriptVarKey::intern("newRotationX");
+static const ScriptVarKey sNewRotationYKey	= ScriptVarKey::intern("newRotationY");
+static const ScriptVarKey sNewRotationZKey	= ScriptVarKey::intern("newRotationZ");
+static const ScriptVarKey sSystemGenKey		= ScriptVarKey::intern("systemGen");
+static const ScriptVarKey sCountKey			= ScriptVarKey::intern("count");
+static const ScriptVarKey sActorsKey		= ScriptVarKey::intern("actors");
+
+///// FUNCTIONS /////
+
+/*---------------------------------------------------------------------
+	Writes one actor's fields, shared by both events
+---------------------------------------------------------------------*/
+static void writeActorFields(IScriptDataWriter &writer, int actorID,
+							 const Vector3f &pos, const Quaternionf &rot)
+{
+	writer.setInt(sActorIDKey, actorID);
+	writer.setFloat(sNewPositionXKey, pos.x);
+	writer.setFloat(sNewPositionYKey, pos.y);
+	writer.setFloat(sNewPositionZKey, pos.z);
+	writer.setFloat(sNewRotationWKey, rot.w);
+	writer.setFloat(sNewRotationXKey, rot.x);
+	writer.setFloat(sNewRotationYKey, rot.y);
+	writer.setFloat(sNewRotationZKey, rot.z);
+}
 
 ////////// class ActorMovedEvent //////////
 
 const string ActorMovedEvent::sEventType("SYS_ACTOR_MOVED");
+const EventTypeId ActorMovedEvent::sEventTypeId(EVENT_TYPE_ID("SYS_ACTOR_MOVED"));
 
 /*---------------------------------------------------------------------
-	This is called to construct script data out of a code-defined event
+	Writes the fields for script handlers of a code-defined event
 ---------------------------------------------------------------------*/
-void ActorMovedEvent::buildScriptData()
+void ActorMovedEvent::writeScriptData(IScriptDataWriter &writer) const
+{
+	writeActorFields(writer, actorID, newPosition, newRotation);
+	writer.setInt(sSystemGenKey, systemGen);
+}
+
+void ActorMovedEvent::serialize(ostream &out) const
 {
-	mScriptData.clear();
-	mScriptData.push_back(AnyVarsValue("actorID", actorID));
-	mScriptData.push_back(AnyVarsValue("newPositionX", newPosition.x));
-	mScriptData.push_back(AnyVarsValue("newPositionY", newPosition.y));
-	mScriptData.push_back(AnyVarsValue("newPositionZ", newPosition.z));
-	mScriptData.push_back(AnyVarsValue("newRotationW", newRotation.w));
-	mScriptData.push_back(AnyVarsValue("newRotationX", newRotation.x));
-	mScriptData.push_back(AnyVarsValue("newRotationY", newRotation.y));
-	mScriptData.push_back(AnyVarsValue("newRotationZ", newRotation.z));
-	mScriptData.push_back(AnyVarsValue("systemGen", systemGen));
-	mScriptDataBuilt = true;
+	writeBinary(out, actorID);
+	writeBinary(out, newPosition);
+	writeBinary(out, newRotation);
+	writeBinary(out, systemGen);
+}
+
+void ActorMovedEvent::deserialize(istream &in)
+{
+	readBinary(in, actorID);
+	readBinary(in, newPosition);
+	readBinary(in, newRotation);
+	readBinary(in, systemGen);
 }
 
 /*---------------------------------------------------------------------
@@ -33,33 +75,102 @@ void ActorMovedEvent::buildScriptData()
 	current values in Engine::mSettings, so if they aren't all supplied
 	by script, the setting will go unchanged.
 ---------------------------------------------------------------------*/
-ActorMovedEvent::ActorMovedEvent(const AnyVars &eventData) :
+ActorMovedEvent::ActorMovedEvent(const ScriptVars &eventData) :
 	ScriptableEvent(eventData),
 	actorID(0), systemGen(System_Scripting)
 {
-	for (AnyVars::const_iterator i = eventData.begin(); i != eventData.end(); ++i) {
-		try {
-			if (_stricmp(i->first.c_str(), "actorID") == 0) {
-				actorID = any_cast<int>(i->second);
-			} else if (_stricmp(i->first.c_str(), "newPositionX") == 0) {
-				newPosition.x = any_cast<float>(i->second);
-			} else if (_stricmp(i->first.c_str(), "newPositionY") == 0) {
-				newPosition.y = any_cast<float>(i->second);
-			} else if (_stricmp(i->first.c_str(), "newPositionZ") == 0) {
-				newPosition.z = any_cast<float>(i->second);
-			} else if (_stricmp(i->first.c_str(), "newRotationW") == 0) {
-				newRotation.w = any_cast<float>(i->second);
-			} else if (_stricmp(i->first.c_str(), "newRotationX") == 0) {
-				newRotation.x = any_cast<float>(i->second);
-			} else if (_stricmp(i->first.c_str(), "newRotationY") == 0) {
-				newRotation.y = any_cast<float>(i->second);
-			} else if (_stricmp(i->first.c_str(), "newRotationZ") == 0) {
-				newRotation.z = any_cast<float>(i->second);
-			}
-			// ignore systemGen property since we already know it's coming from Script
-		} catch (const boost::bad_any_cast &ex) {
-			// nothing happens with a bad datatype in release build, silently ignores
-			debugPrintf("DeviceChangeEvent: bad_any_cast \"%s\"\n", ex.what());
+	for (ScriptVars::const_iterator i = eventData.begin(); i != eventData.end(); ++i) {
+		bool ok = true;
+		if (i->key == sActorIDKey) {
+			ok = i->value.get(actorID);
+		} else if (i->key == sNewPositionXKey) {
+			ok = i->value.get(newPosition.x);
+		} else if (i->key == sNewPositionYKey) {
+			ok = i->value.get(newPosition.y);
+		} else if (i->key == sNewPositionZKey) {
+			ok = i->value.get(newPosition.z);
+		} else if (i->key == sNewRotationWKey) {
+			ok = i->value.get(newRotation.w);
+		} else if (i->key == sNewRotationXKey) {
+			ok = i->value.get(newRotation.x);
+		} else if (i->key == sNewRotationYKey) {
+			ok = i->value.get(newRotation.y);
+		} else if (i->key == sNewRotationZKey) {
+			ok = i->value.get(newRotation.z);
+		}
+		// ignore systemGen property since we already know it's coming from Script
+		if (!ok) { // nothing happens with a bad datatype in release build, silently ignores
+			debugPrintf("ActorMovedEvent: bad type for \"%s\"\n", i->key.name);
 		}
 	}
-}
\ No newline at end of file
+}
+
+////////// class ActorTransformBatchEvent //////////
+
+const string ActorTransformBatchEvent::sEventType("SYS_ACTOR_TRANSFORM_BATCH");
+const EventTypeId ActorTransformBatchEvent::sEventTypeId(EVENT_TYPE_ID("SYS_ACTOR_TRANSFORM_BATCH"));
+
+/*---------------------------------------------------------------------
+	Writes the fields for script handlers of a code-defined event. Each
+	actor is a nested table with an index key, which the Lua handler
+	turns into an array element.
+---------------------------------------------------------------------*/
+void ActorTransformBatchEvent::writeScriptData(IScriptDataWriter &writer) const
+{
+	writer.setInt(sCountKey, static_cast<int>(size()));
+	writer.setInt(sSystemGenKey, static_cast<int>(systemGen));
+
+	const ScriptVarKey index(ScriptVarKey::index());
+	writer.beginTable(sActorsKey);
+	for (uint a = 0; a < size(); ++a) {
+		writer.beginTable(index);
+		writeActorFields(writer, actorIDs[a], positions[a], orientations[a]);
+		writer.endTable();
+	}
+	writer.endTable();
+}
+
+/*---------------------------------------------------------------------
+	The arrays are written as blocks, so serializing a batch is three
+	memcpys regardless of the number of actors
+---------------------------------------------------------------------*/
+void ActorTransformBatchEvent::serialize(ostream &out) const
+{
+	writeBinary(out, systemGen);
+	writeBinary(out, actorIDs);
+	writeBinary(out, positions);
+	writeBinary(out, orientations);
+}
+
+void ActorTransformBatchEvent::deserialize(istream &in)
+{
+	reset();
+	readBinary(in, systemGen);
+	readBinary(in, actorIDs);
+	readBinary(in, positions);
+	readBinary(in, orientations);
+}
+
+/*---------------------------------------------------------------------
+	The script-called constructor reads the "actors" array in the same
+	layout that writeScriptData produces
+---------------------------------------------------------------------*/
+ActorTransformBatchEvent::ActorTransformBatchEvent(const ScriptVars &eventData) :
+	ScriptableEvent(eventData),
+	systemGen(ActorMovedEvent::System_Scripting)
+{
+	const ScriptValue *actors = eventData.find(sActorsKey);
+	// ignore count and systemGen, count comes from the array and we know it's from Script
+	if (!actors) return;
+	if (actors->type() != ScriptValue_Vars) {
+		debugPrintf("ActorTransformBatchEvent: bad type for \"actors\"\n");
+		return;
+	}
+	const ScriptVars &actorList = actors->asVars();
+	reserve(actorList.size());
+	for (ScriptVars::const_iterator ai = actorList.begin(); ai != actorList.end(); ++ai) {
+		if (ai->value.type() != ScriptValue_Vars) continue;
+		ActorMovedEvent actor(ai->value.asVars());
+		push(actor.actorID, actor.newPosition, actor.newRotation);
+	}
+}
@@ -1,15 +1,18 @@
 /*----==== PHYSICSEVENTS.H ====----
 	Author:		Jeff Kiah
 	Orig.Date:	03/02/2010
-	Rev.Date:	03/02/2010
+	Rev.Date:	10/17/2026
 ---------------------------------*/
 
 #pragma once
 
+#include <vector>
 #include "../Event/Event.h"
 #include "../Math/TVector3.h"
 #include "../Math/TQuaternion.h"
 
+using std::vector;
+
 ///// STRUCTURES /////
 
 /*=============================================================================
@@ -34,6 +37,7 @@ class ActorMovedEvent : public ScriptableEvent {
 		///// VARIABLES /////
 		// Static
 		static const string sEventType;
+		static const EventTypeId sEventTypeId;
 
 		// Member
 		int			actorID;
@@ -43,13 +47,24 @@ class ActorMovedEvent : public ScriptableEvent {
 
 		///// FUNCTIONS /////
 		virtual const string & type() const { return sEventType; }
-		virtual void serialize(ostream &out) const {}
-		virtual void deserialize(istream &in) {}
+		virtual EventTypeId typeId() const { return sEventTypeId; }
+		virtual void serialize(ostream &out) const;
+		virtual void deserialize(istream &in);
+
+		/*---------------------------------------------------------------------
+			Writes the fields for script handlers of a code-defined event
+		---------------------------------------------------------------------*/
+		virtual void writeScriptData(IScriptDataWriter &writer) const;
 
 		/*---------------------------------------------------------------------
-			This is called to construct script data out of a code-defined event
+			Coalesce key, only the latest move of an actor by each system needs
+			to be handled. All 32 bits of the actor ID are kept above the
+			systemGen, so no two actors share a key.
 		---------------------------------------------------------------------*/
-		virtual void buildScriptData();
+		static uint64 coalesceKey(const Event &e) {
+			const ActorMovedEvent &me = static_cast<const ActorMovedEvent &>(e);
+			return (static_cast<uint64>(static_cast<uint>(me.actorID)) << 8) | me.systemGen;
+		}
 
 		// Constructors
 		explicit ActorMovedEvent(int _actorID, const Vector3f &_pos,
@@ -62,8 +77,107 @@ class ActorMovedEvent : public ScriptableEvent {
 			current values in Engine::mSettings, so if they aren't all supplied
 			by script, the setting will go unchanged.
 		---------------------------------------------------------------------*/
-		explicit ActorMovedEvent(const AnyVars &eventData);
+		explicit ActorMovedEvent(const ScriptVars &eventData);
+		/*---------------------------------------------------------------------
+			Used by deserializeEvent, the data is filled in by deserialize
+		---------------------------------------------------------------------*/
+		explicit ActorMovedEvent() :
+			ScriptableEvent(),
+			actorID(0), systemGen(System_Scripting)
+		{}
 
 		// Destructor
 		virtual ~ActorMovedEvent() {}
-};
\ No newline at end of file
+};
+
+/*=============================================================================
+class ActorTransformBatchEvent
+	Carries the transforms of many actors at once, laid out as parallel arrays
+	(structure of arrays), so the physics step raises one event per frame for
+	the whole scene instead of one ActorMovedEvent per actor. Element i of
+	actorIDs, positions and orientations describe the same actor. Listeners
+	iterate the arrays directly:
+		const ActorTransformBatchEvent &e = ...;
+		for (uint i = 0; i < e.size(); ++i) { ... e.positions[i] ... }
+	Script data is only written if a Lua handler actually sees the event, in
+	which case it expands to a count, the systemGen, and an "actors" array of
+	tables with the same fields as ActorMovedEvent.
+=============================================================================*/
+class ActorTransformBatchEvent : public ScriptableEvent {
+	public:
+		///// VARIABLES /////
+		// Static
+		static const string sEventType;
+		static const EventTypeId sEventTypeId;
+
+		// Member
+		vector<int>			actorIDs;
+		vector<Vector3f>	positions;
+		vector<Quaternionf>	orientations;
+		ActorMovedEvent::SystemGen	systemGen;
+
+		///// FUNCTIONS /////
+		virtual const string & type() const { return sEventType; }
+		virtual EventTypeId typeId() const { return sEventTypeId; }
+		virtual void serialize(ostream &out) const;
+		virtual void deserialize(istream &in);
+
+		uint	size() const { return static_cast<uint>(actorIDs.size()); }
+		bool	empty() const { return actorIDs.empty(); }
+
+		/*---------------------------------------------------------------------
+			Appends one actor's transform to the batch
+		---------------------------------------------------------------------*/
+		void	push(int _actorID, const Vector3f &_pos, const Quaternionf &_rot) {
+					actorIDs.push_back(_actorID);
+					positions.push_back(_pos);
+					orientations.push_back(_rot);
+				}
+
+		/*---------------------------------------------------------------------
+			Empties the arrays but keeps their capacity, so a batch that is
+			reused each frame stops allocating once it has reached the size of
+			the scene. Also throws away any script data that was built.
+		---------------------------------------------------------------------*/
+		void	reset() {
+					actorIDs.clear();
+					positions.clear();
+					orientations.clear();
+					mScriptData.clear();
+					mScriptDataBuilt = false;
+				}
+
+		void	reserve(uint count) {
+					actorIDs.reserve(count);
+					positions.reserve(count);
+					orientations.reserve(count);
+				}
+
+		/*---------------------------------------------------------------------
+			Writes the fields for script handlers of a code-defined event
+		---------------------------------------------------------------------*/
+		virtual void writeScriptData(IScriptDataWriter &writer) const;
+
+		// Constructors
+		explicit ActorTransformBatchEvent(ActorMovedEvent::SystemGen _systemGen, uint reserveCount = 0) :
+			ScriptableEvent(),
+			systemGen(_systemGen)
+		{
+			reserve(reserveCount);
+		}
+		/*---------------------------------------------------------------------
+			The script-called constructor reads the "actors" array in the same
+			layout that writeScriptData produces
+		---------------------------------------------------------------------*/
+		explicit ActorTransformBatchEvent(const ScriptVars &eventData);
+		/*---------------------------------------------------------------------
+			Used by deserializeEvent, the data is filled in by deserialize
+		---------------------------------------------------------------------*/
+		explicit ActorTransformBatchEvent() :
+			ScriptableEvent(),
+			systemGen(ActorMovedEvent::System_Scripting)
+		{}
+
+		// Destructor
+		virtual ~ActorTransformBatchEvent() {}
+};
@@ -0,0 +1,323 @@
+/*----==== JOBSYSTEM.CPP ====----
+	Author:		Jeff Kiah
+	Orig.Date:	10/17/2026
+	Rev.Date:	10/17/2026
+-------------------------------*/
+
+#include <crtdbg.h>
+#include "JobSystem.h"
+
+///// VARIABLES /////
+
+// Calling thread's worker index, valid while tlsJobSystem is the running job system
+static __declspec(thread) JobSystem *	tlsJobSystem = 0;
+static __declspec(thread) int			tlsWorkerIndex = -1;
+
+////////// class JobSystem::JobDeque //////////
+
+/*-----------------------------------------------------------------------------
+	Owner only. Returns false when full, the caller runs the job itself.
+-----------------------------------------------------------------------------*/
+bool JobSystem::JobDeque::push(const Job &job)
+{
+	LONG b = mBottom;
+	if (b - mTop >= JOBSYS_DEQUE_CAPACITY) return false;
+	mJobs[b & (JOBSYS_DEQUE_CAPACITY-1)] = job;
+	mBottom = b + 1; // release, thieves see the job before the new bottom
+	return true;
+}
+
+/*-----------------------------------------------------------------------------
+	Owner only, takes the newest job. Bottom is lowered before top is read, and
+	the exchange keeps those two from being reordered, so a thief and the owner
+	can only both see the last job, and then they settle it on top.
+-----------------------------------------------------------------------------*/
+bool JobSystem::JobDeque::pop(Job &outJob)
+{
+	LONG b = mBottom - 1;
+	InterlockedExchange(&mBottom, b);
+	LONG t = mTop;
+	if (b - t < 0) {
+		mBottom = t; // was empty, put bottom back
+		return false;
+	}
+	outJob = mJobs[b & (JOBSYS_DEQUE_CAPACITY-1)];
+	if (b != t) return true;
+
+	// the last job, a thief may be taking it too
+	bool won = (InterlockedCompareExchange(&mTop, t + 1, t) == t);
+	mBottom = t + 1;
+	return won;
+}
+
+/*-----------------------------------------------------------------------------
+	Any thread, takes the oldest job. Returns false if empty or if another
+	thread got there first. The slot is copied before claiming it, the owner
+	can't reuse it until top moves past it.
+-----------------------------------------------------------------------------*/
+bool JobSystem::JobDeque::steal(Job &outJob)
+{
+	LONG t = mTop;
+	LONG b = mBottom;
+	if (b - t <= 0) return false;
+	outJob = mJobs[t & (JOBSYS_DEQUE_CAPACITY-1)];
+	return (InterlockedCompareExchange(&mTop, t + 1, t) == t);
+}
+
+////////// class JobSystem //////////
+
+int JobSystem::workerIndex() const
+{
+	return (tlsJobSystem == this) ? tlsWorkerIndex : -1;
+}
+
+void JobSystem::runJob(const Job &job)
+{
+	job.func(job.param);
+	if (job.counter) job.counter->release();
+}
+
+/*-----------------------------------------------------------------------------
+	Finds a job for the calling thread: its own deque first (if it is a
+	worker), then the injected queue, then steals from the others starting
+	after its own index so thieves spread out.
+-----------------------------------------------------------------------------*/
+bool JobSystem::findJob(int index, Job &outJob)
+{
+	if (index >= 0 && mDeques[index]->pop(outJob)) return true;
+
+	if (mNumInjected > 0) {
+		mutex::scoped_lock lock(mInjectMutex);
+		if (!mInjected.empty()) {
+			outJob = mInjected.front();
+			mInjected.pop_front();
+			InterlockedDecrement(&mNumInjected);
+			return true;
+		}
+	}
+
+	uint n = numWorkers();
+	uint start = (index >= 0) ? static_cast<uint>(index) + 1 : 0;
+	for (uint i = 0; i < n; ++i) {
+		uint victim = (start + i) % n;
+		if (static_cast<int>(victim) != index && mDeques[victim]->steal(outJob)) return true;
+	}
+	return false;
+}
+
+bool JobSystem::hasWork() const
+{
+	if (mNumInjected > 0) return true;
+	vector<JobDeque*>::const_iterator di, end = mDeques.end();
+	for (di = mDeques.begin(); di != end; ++di) {
+		if (!(*di)->empty()) return true;
+	}
+	return false;
+}
+
+/*-----------------------------------------------------------------------------
+	The barrier keeps the job's publish from passing the read of mNumSleeping.
+	A worker going to sleep counts itself first and checks for work under the
+	lock after, and the notify takes the lock, so between them one always sees
+	the other.
+-----------------------------------------------------------------------------*/
+void JobSystem::wakeWorker()
+{
+	MemoryBarrier();
+	if (mNumSleeping > 0) {
+		mutex::scoped_lock lock(mSleepMutex);
+		mWakeCond.notify_one();
+	}
+}
+
+/*-----------------------------------------------------------------------------
+	Thread function of workers 1 and up. Spins on stealing for a while after
+	running out of work, since jobs tend to come in bursts within a frame, then
+	sleeps until a job is spawned.
+-----------------------------------------------------------------------------*/
+void JobSystem::workerProc(uint index)
+{
+	tlsJobSystem = this;
+	tlsWorkerIndex = static_cast<int>(index);
+
+	uint idleSpins = 0;
+	for (;;) {
+		Job job;
+		if (findJob(index, job)) {
+			runJob(job);
+			idleSpins = 0;
+		} else if (mShutdown) {
+			break; // only once out of work, so nothing is left in this worker's deque
+		} else if (++idleSpins < JOBSYS_IDLE_SPINS) {
+			YieldProcessor();
+		} else {
+			mutex::scoped_lock lock(mSleepMutex);
+			InterlockedIncrement(&mNumSleeping);
+			if (!mShutdown && !hasWork()) {
+				mWakeCond.wait(lock);
+			}
+			InterlockedDecrement(&mNumSleeping);
+			idleSpins = 0;
+		}
+	}
+	tlsJobSystem = 0;
+	tlsWorkerIndex = -1;
+}
+
+/*-----------------------------------------------------------------------------
+	Queues func(param) to run on any worker. Pass a counter to join it later
+	with wait, or 0 for fire and forget. Safe from any thread, cheapest from a
+	worker.
+-----------------------------------------------------------------------------*/
+void JobSystem::spawn(JobFunc func, void *param, JobCounter *counter)
+{
+	_ASSERTE(func);
+	if (counter) counter->add();
+	Job job = { func, param, counter };
+
+	int index = workerIndex();
+	if (index >= 0) {
+		if (!mDeques[index]->push(job)) {
+			runJob(job); // deque full, the spawner is better off doing it now
+			return;
+		}
+	} else {
+		mutex::scoped_lock lock(mInjectMutex);
+		mInjected.push_back(job);
+		InterlockedIncrement(&mNumInjected);
+	}
+	wakeWorker();
+}
+
+/*-----------------------------------------------------------------------------
+	Runs jobs until the counter reaches zero. A thread outside the pool only
+	steals, the jobs it spawned went on the shared queue. When there's nothing
+	left to take the counter is waiting on jobs already running elsewhere,
+	which are short, so it yields rather than sleeps.
+-----------------------------------------------------------------------------*/
+void JobSystem::wait(JobCounter &counter)
+{
+	int index = workerIndex();
+	while (!counter.done()) {
+		Job job;
+		if (findJob(index, job)) {
+			runJob(job);
+		} else {
+			SwitchToThread();
+		}
+	}
+}
+
+/*-----------------------------------------------------------------------------
+	Runs one waiting job on the calling thread, returns false if there was
+	none
+-----------------------------------------------------------------------------*/
+bool JobSystem::runOneJob()
+{
+	Job job;
+	if (!findJob(workerIndex(), job)) return false;
+	runJob(job);
+	return true;
+}
+
+void JobSystem::runRange(void *param)
+{
+	RangeJob &r = *static_cast<RangeJob*>(param);
+	r.func(r.begin, r.end, r.param);
+}
+
+/*-----------------------------------------------------------------------------
+	Calls func(begin, end, param) over [0, count) in chunks of at least grain,
+	spread over the pool, and returns when all chunks are done. Splits into
+	a few chunks per worker so a slow chunk can be balanced by stealing. The
+	calling thread takes the first chunk itself.
+-----------------------------------------------------------------------------*/
+void JobSystem::parallelFor(uint count, uint grain, JobRangeFunc func, void *param)
+{
+	if (count == 0) return;
+	if (grain == 0) grain = 1;
+	uint numChunks = (count + grain - 1) / grain;
+	uint maxChunks = numWorkers() * 4;
+	if (numChunks > maxChunks) numChunks = maxChunks;
+	if (numChunks <= 1) {
+		func(0, count, param);
+		return;
+	}
+
+	vector<RangeJob> ranges(numChunks);
+	uint chunkSize = count / numChunks;
+	uint remainder = count % numChunks;
+	uint begin = 0;
+	for (uint c = 0; c < numChunks; ++c) {
+		uint size = chunkSize + ((c < remainder) ? 1 : 0);
+		RangeJob r = { func, param, begin, begin + size };
+		ranges[c] = r;
+		begin += size;
+	}
+
+	JobCounter counter;
+	for (uint c = 1; c < numChunks; ++c) {
+		spawn(&JobSystem::runRange, &ranges[c], &counter);
+	}
+	runRange(&ranges[0]);
+	wait(counter);
+}
+
+// Constructor / destructor
+JobSystem::JobSystem(uint numWorkers) :
+	Singleton<JobSystem>(*this),
+	mNumInjected(0),
+	mNumSleeping(0),
+	mShutdown(false)
+{
+	if (numWorkers == 0) {
+		numWorkers = thread::hardware_concurrency();
+		if (numWorkers == 0) numWorkers = 1;
+	}
+	mDeques.reserve(numWorkers);
+	for (uint w = 0; w < numWorkers; ++w) {
+		mDeques.push_back(new JobDeque());
+	}
+	// the deques must all exist before any worker goes looking for work
+	tlsJobSystem = this;
+	tlsWorkerIndex = 0;
+	mThreads.reserve(numWorkers - 1);
+	for (uint w = 1; w < numWorkers; ++w) {
+		mThreads.push_back(new thread(&JobSystem::workerProc, this, w));
+	}
+	debugPrintf("JobSystem: started %u workers\n", numWorkers);
+}
+
+/*-----------------------------------------------------------------------------
+	Runs whatever is left, fire and forget jobs included, then stops the
+	workers
+-----------------------------------------------------------------------------*/
+JobSystem::~JobSystem()
+{
+	Job job;
+	while (findJob(workerIndex(), job)) {
+		runJob(job);
+	}
+	{
+		mutex::scoped_lock lock(mSleepMutex);
+		mShutdown = true;
+		mWakeCond.notify_all();
+	}
+	vector<thread*>::iterator ti, end = mThreads.end();
+	for (ti = mThreads.begin(); ti != end; ++ti) {
+		(*ti)->join();
+		delete *ti;
+	}
+	mThreads.clear();
+
+	vector<JobDeque*>::iterator di, dend = mDeques.end();
+	for (di = mDeques.begin(); di != dend; ++di) {
+		_ASSERTE((*di)->empty());
+		delete *di;
+	}
+	mDeques.clear();
+	if (tlsJobSystem == this) {
+		tlsJobSystem = 0;
+		tlsWorkerIndex = -1;
+	}
+}
@@ -0,0 +1,222 @@
+/*----==== JOBSYSTEM.H ====----
+	Author:		Jeff Kiah
+	Orig.Date:	10/17/2026
+	Rev.Date:	10/17/2026
+-----------------------------*/
+
+#pragma once
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN	// defined in project settings
+#endif
+
+#include <Windows.h>
+#include <deque>
+#include <vector>
+#include <boost/noncopyable.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include "../Utility/Typedefs.h"
+#include "../Utility/Singleton.h"
+
+using std::deque;
+using std::vector;
+using boost::thread;
+using boost::mutex;
+using boost::condition_variable;
+
+///// DEFINITIONS /////
+
+#define jobSys		JobSystem::instance()
+
+#define JOBSYS_DEQUE_CAPACITY	4096	// jobs per worker deque, must be a power of 2. Spawning past this runs the job inline
+#define JOBSYS_IDLE_SPINS		256		// failed steal rounds before an idle worker goes to sleep
+
+typedef void (*JobFunc)(void *param);
+typedef void (*JobRangeFunc)(uint begin, uint end, void *param);
+
+///// STRUCTURES /////
+
+/*=============================================================================
+class JobCounter
+	Counts the jobs spawned against it that haven't finished, wait on it to
+	join them. A counter made with a parent holds one count on the parent
+	while it is non-zero, so waiting on the parent also waits for the child
+	group, however deep. A job that spawns more work into the counter it was
+	spawned with keeps that counter from reaching zero, which is how a job
+	hands off children without its waiter having to know about them.
+	The counter must outlive its jobs, which it does if it is waited on
+	before it goes out of scope.
+=============================================================================*/
+class JobCounter : private boost::noncopyable {
+	friend class JobSystem;
+	private:
+		///// VARIABLES /////
+		volatile LONG	mPending;
+		JobCounter *	mParent;
+
+		///// FUNCTIONS /////
+		/*---------------------------------------------------------------------
+			mParent is read before the count changes, once it reaches zero a
+			waiter may return and the counter go out of scope
+		---------------------------------------------------------------------*/
+		void	add() {
+					JobCounter *parent = mParent;
+					if (InterlockedIncrement(&mPending) == 1 && parent) parent->add();
+				}
+		void	release() {
+					_ASSERTE(mPending > 0);
+					JobCounter *parent = mParent;
+					if (InterlockedDecrement(&mPending) == 0 && parent) parent->release();
+				}
+
+	public:
+		bool	done() const		{ return (mPending == 0); }
+		LONG	pending() const		{ return mPending; }
+
+		explicit JobCounter(JobCounter *parent = 0) : mPending(0), mParent(parent) {}
+		~JobCounter() { _ASSERTE(mPending == 0 && "JobCounter destroyed with jobs outstanding, wait on it first"); }
+};
+
+/*=============================================================================
+class JobSystem
+	A work-stealing scheduler for short, CPU bound jobs. There is one worker
+	per logical processor, the main thread being worker 0, so a process that
+	spawns jobs and waits on them gets the whole machine without
+	oversubscribing it. Each worker owns a deque: it pushes and pops its own
+	jobs at the bottom, newest first for cache locality, and when it runs dry
+	it steals the oldest job from the top of another worker's deque. Pushing
+	and popping your own deque costs no interlocked operations except when
+	taking the last job, which could race a thief.
+	Waiting never blocks while there is work anywhere in the pool. wait runs
+	the waiter's own jobs and steals others' until the counter reaches zero,
+	so jobs may spawn and wait on children of their own without tying up a
+	thread each.
+	Threads outside the pool (ThreadProcess threads for instance) may also
+	spawn and wait. Their jobs go on a shared queue guarded by a lock, and
+	they help by stealing. Jobs must not block on I/O or on another thread,
+	for that a ThreadProcess is still the right tool.
+	The engine creates the job system before the other managers and destroys
+	it after them.
+=============================================================================*/
+class JobSystem : public Singleton<JobSystem> {
+	private:
+		///// DEFINITIONS /////
+		struct Job {
+			JobFunc			func;
+			void *			param;
+			JobCounter *	counter;
+		};
+
+		/*=====================================================================
+		class JobDeque
+			Fixed size Chase-Lev deque. push and pop are for the owning worker
+			only, steal is safe from any thread. Volatile reads and writes are
+			acquire and release under VC++, the interlocked operations are full
+			barriers.
+		=====================================================================*/
+		class JobDeque : private boost::noncopyable {
+			private:
+				volatile LONG	mTop;		// next to steal, only ever incremented
+				volatile LONG	mBottom;	// next free slot, written by the owner
+				Job				mJobs[JOBSYS_DEQUE_CAPACITY];
+
+			public:
+				bool	push(const Job &job);
+				bool	pop(Job &outJob);
+				bool	steal(Job &outJob);
+				bool	empty() const { return (mBottom - mTop <= 0); }
+
+				explicit JobDeque() : mTop(0), mBottom(0) {}
+		};
+
+		struct RangeJob {
+			JobRangeFunc	func;
+			void *			param;
+			uint			begin, end;
+		};
+
+		///// VARIABLES /////
+		vector<JobDeque*>	mDeques;		// one per worker, 0 belongs to the main thread
+		vector<thread*>		mThreads;		// workers 1 and up
+		deque<Job>			mInjected;		// jobs spawned by threads outside the pool
+		mutex				mInjectMutex;
+		volatile LONG		mNumInjected;	// read without the lock to skip it when empty
+		mutex				mSleepMutex;	// sleeping workers wait on mWakeCond under this
+		condition_variable	mWakeCond;
+		volatile LONG		mNumSleeping;
+		volatile bool		mShutdown;
+
+		///// FUNCTIONS /////
+		/*---------------------------------------------------------------------
+			Thread function of workers 1 and up
+		---------------------------------------------------------------------*/
+		void	workerProc(uint index);
+
+		/*---------------------------------------------------------------------
+			Finds a job for the calling thread: its own deque first (if it is a
+			worker), then the injected queue, then steals from the others
+			starting after its own index so thieves spread out.
+		---------------------------------------------------------------------*/
+		bool	findJob(int index, Job &outJob);
+
+		/*---------------------------------------------------------------------
+			Runs the job and releases its counter
+		---------------------------------------------------------------------*/
+		static void	runJob(const Job &job);
+
+		/*---------------------------------------------------------------------
+			True if any deque or the injected queue has a job, racy and only
+			used before going to sleep
+		---------------------------------------------------------------------*/
+		bool	hasWork() const;
+
+		void	wakeWorker();
+
+		static void	runRange(void *param);
+
+		/*---------------------------------------------------------------------
+			Worker index of the calling thread in this pool, -1 if outside it
+		---------------------------------------------------------------------*/
+		int		workerIndex() const;
+
+	public:
+		///// FUNCTIONS /////
+		/*---------------------------------------------------------------------
+			Queues func(param) to run on any worker. Pass a counter to join it
+			later with wait, or 0 for fire and forget (the job must then be
+			done before the job system is destroyed, which waits for it).
+			Safe from any thread, cheapest from a worker.
+		---------------------------------------------------------------------*/
+		void	spawn(JobFunc func, void *param, JobCounter *counter);
+
+		/*---------------------------------------------------------------------
+			Runs jobs until the counter reaches zero. Safe from any thread, but
+			from inside a job only wait on counters of jobs that job spawned.
+		---------------------------------------------------------------------*/
+		void	wait(JobCounter &counter);
+
+		/*---------------------------------------------------------------------
+			Runs one waiting job on the calling thread, returns false if
+			there was none. For threads that help out while waiting on
+			something other than a JobCounter.
+		---------------------------------------------------------------------*/
+		bool	runOneJob();
+
+		/*---------------------------------------------------------------------
+			Calls func(begin, end, param) over [0, count) in chunks of at
+			least grain, spread over the pool, and returns when all chunks are
+			done. Runs inline if there's only one chunk.
+		---------------------------------------------------------------------*/
+		void	parallelFor(uint count, uint grain, JobRangeFunc func, void *param);
+
+		uint	numWorkers() const { return static_cast<uint>(mDeques.size()); }
+
+		/*---------------------------------------------------------------------
+			Pass 0 for one worker per logical processor, counting the calling
+			thread (which must be the main thread) as worker 0
+		---------------------------------------------------------------------*/
+		explicit JobSystem(uint numWorkers = 0);
+		~JobSystem();
+};
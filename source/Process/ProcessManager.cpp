@@ -1,37 +1,489 @@
 /*----==== PROCESSMANAGER.CPP ====----
 	Author:		Jeff Kiah
 	Orig.Date	04/20/2007
-	Rev.Date	06/14/2009
+	Rev.Date	10/17/2026
 ------------------------------------*/
 
 #include "ProcessManager.h"
+#include "../HighPerfTimer.h"
+#include <algorithm>
+#include <functional>
+#include <cctype>
+
+////////// class CProcess //////////
+
+void CProcess::runAfter(const string &procName)
+{
+	mRunAfter.push_back(ProcessManager::makeKey(procName));
+}
+
+void CProcess::runBefore(const string &procName)
+{
+	mRunBefore.push_back(ProcessManager::makeKey(procName));
+}
+
+/*---------------------------------------------------------------------
+	A sleeping process is woken so the next update sees it finished and
+	detaches it
+---------------------------------------------------------------------*/
+void CProcess::finish()
+{
+	joinJobs();
+	mProcessFlags[bitFinished] = true;
+	if (isSleeping() && ProcessManager::exists()) procMgr.wakeProcess(*this);
+	onFinish();
+}
 
 ////////// class ProcessManager //////////
 
-bool ProcessManager::isProcessActive(const string &procName)
+string ProcessManager::makeKey(const string &name)
 {
-	ProcessList::const_iterator i, end = mProcessList.end();
-	for (i = mProcessList.begin(); i != end; ++i) {
-		if (_stricmp((*i)->name().c_str(), procName.c_str()) == 0) return true;
+	string key(name);
+	std::transform(key.begin(), key.end(), key.begin(), ::tolower);
+	return key;
+}
+
+/*---------------------------------------------------------------------
+	Returns the newest attached, unfinished process of the name, or 0.
+	The chain only holds processes of this one name, and finished ones
+	only stay in it until the next update detaches them.
+---------------------------------------------------------------------*/
+CProcess *ProcessManager::findByKey(const string &key) const
+{
+	NameIndex::const_iterator ni = mNameIndex.find(key);
+	if (ni == mNameIndex.end()) return 0;
+	for (CProcess *p = ni->second.first; p; p = p->mNextSameName) {
+		if (!p->isFinished()) return p;
 	}
-	return false;
+	return 0;
+}
+
+bool ProcessManager::isProcessActive(const string &procName) const
+{
+	return (findByKey(makeKey(procName)) != 0);
 }
 
-void ProcessManager::attach(const CProcessPtr &procPtr)
+CProcessPtr ProcessManager::findProcess(const string &procName) const
 {
-	mProcessList.push_back(procPtr);
-	procPtr->setAttached();
+	CProcess *p = findByKey(makeKey(procName));
+	return (p ? *(p->mListPos) : CProcessPtr());
+}
+
+uint ProcessManager::numProcesses(const string &procName) const
+{
+	NameIndex::const_iterator ni = mNameIndex.find(makeKey(procName));
+	return (ni == mNameIndex.end() ? 0 : ni->second.count);
+}
+
+/*---------------------------------------------------------------------
+	Adds the process to the list, applying its queue mode against
+	processes of the same name. Returns false if a Single process was
+	refused because one is already running. Replaced processes are
+	finished here and detached by the next update, their successors
+	(setNextProcess) still start then as usual.
+---------------------------------------------------------------------*/
+bool ProcessManager::attach(const CProcessPtr &procPtr)
+{
+	CProcess &p = *procPtr;
+	_ASSERTE(!p.isAttached() && "Process is already attached!");
+	p.mKey = makeKey(p.name());
+
+	if (p.mQueueMode != CProcess_Queue_Multiple && findByKey(p.mKey)) {
+		if (p.mQueueMode == CProcess_Queue_Single) {
+			debugPrintf("ProcessManager: \"%s\" process not attached, one is already running\n", p.name().c_str());
+			return false;
+		}
+		// CProcess_Queue_Single_Replace
+		CProcess *e = mNameIndex[p.mKey].first;
+		while (e) {
+			CProcess *next = e->mNextSameName;
+			if (!e->isFinished()) e->finish();
+			e = next;
+		}
+	}
+
+	p.mListPos = mProcessList.insert(mProcessList.end(), procPtr);
+	NameEntry &entry = mNameIndex[p.mKey];
+	p.mPrevSameName = 0;
+	p.mNextSameName = entry.first;
+	if (entry.first) entry.first->mPrevSameName = &p;
+	entry.first = &p;
+	++entry.count;
+
+	p.setAttached();
+	return true;
 }
 
 void ProcessManager::detach(const CProcessPtr &procPtr)
 {
-	procPtr->setAttached(false);
-	debugPrintf("ProcessManager: \"%s\" process detached: %i running\n", procPtr->name().c_str(), mProcessList.size()-1);
-	mProcessList.remove(procPtr); // this is expensive - o(n) - and needs to be addressed
+	CProcessPtr keepPtr(procPtr); // procPtr may be the list's own copy, erased below
+	CProcess &p = *keepPtr;
+	p.setAttached(false);
+
+	NameIndex::iterator ni = mNameIndex.find(p.mKey);
+	_ASSERTE(ni != mNameIndex.end());
+	if (p.mPrevSameName) {
+		p.mPrevSameName->mNextSameName = p.mNextSameName;
+	} else {
+		ni->second.first = p.mNextSameName;
+	}
+	if (p.mNextSameName) p.mNextSameName->mPrevSameName = p.mPrevSameName;
+	p.mPrevSameName = p.mNextSameName = 0;
+	if (--ni->second.count == 0) mNameIndex.erase(ni);
+
+	if (p.isSleeping()) {
+		mSleepList.erase(p.mListPos);
+		p.mProcessFlags[CProcess::bitSleeping] = false;
+	} else {
+		mProcessList.erase(p.mListPos);
+	}
+	p.mListPos = ProcessList::iterator();
+	debugPrintf("ProcessManager: \"%s\" process detached: %i running\n", p.name().c_str(), mProcessList.size());
+}
+
+/*---------------------------------------------------------------------
+	Moves the process to the sleep list. Its place in the list is kept
+	by the iterator, which stays valid across the splice.
+---------------------------------------------------------------------*/
+void ProcessManager::sleepProcess(CProcess &p)
+{
+	_ASSERTE(p.isAttached() && !p.mParallel && "only attached, non-parallel processes can sleep");
+	if (p.isSleeping() || !p.isAttached()) return;
+	mSleepList.splice(mSleepList.end(), mProcessList, p.mListPos);
+	p.mProcessFlags[CProcess::bitSleeping] = true;
+	++p.mSleepId;
+}
+
+void ProcessManager::sleepProcessFor(CProcess &p, float millis)
+{
+	sleepProcess(p);
+	if (!p.isSleeping()) return;
+	TimerWait w;
+	w.wakeCounts = HighPerfTimer::queryCounts() +
+		static_cast<__int64>(millis * 0.001f * static_cast<float>(HighPerfTimer::timerFreq()));
+	w.procPtr = *p.mListPos;
+	w.sleepId = p.mSleepId;
+	mTimerWaits.push_back(w);
+	std::push_heap(mTimerWaits.begin(), mTimerWaits.end(), std::greater<TimerWait>());
 }
 
+void ProcessManager::sleepProcessUntilDone(CProcess &p, JobCounter &counter)
+{
+	if (counter.done()) return;
+	sleepProcess(p);
+	if (!p.isSleeping()) return;
+	JobWait w = { &counter, *p.mListPos, p.mSleepId };
+	mJobWaits.push_back(w);
+}
+
+/*---------------------------------------------------------------------
+	Moves the process back to the end of the run list. Waits still
+	pending for it go stale with the sleep id and are dropped when they
+	come up.
+---------------------------------------------------------------------*/
+void ProcessManager::wakeProcess(CProcess &p)
+{
+	if (!p.isSleeping()) return;
+	mProcessList.splice(mProcessList.end(), mSleepList, p.mListPos);
+	p.mProcessFlags[CProcess::bitSleeping] = false;
+	++p.mSleepId;
+}
+
+/*---------------------------------------------------------------------
+	Wakes processes whose time has come or whose jobs are done. A wait
+	whose process is gone, or has been woken since, is dropped.
+---------------------------------------------------------------------*/
+void ProcessManager::wakeWaiting()
+{
+	if (!mTimerWaits.empty()) {
+		__int64 now = HighPerfTimer::queryCounts();
+		while (!mTimerWaits.empty() && mTimerWaits.front().wakeCounts <= now) {
+			std::pop_heap(mTimerWaits.begin(), mTimerWaits.end(), std::greater<TimerWait>());
+			CProcessPtr procPtr(mTimerWaits.back().procPtr.lock());
+			if (procPtr && procPtr->mSleepId == mTimerWaits.back().sleepId) {
+				wakeProcess(*procPtr);
+			}
+			mTimerWaits.pop_back();
+		}
+	}
+
+	uint w = 0;
+	while (w < mJobWaits.size()) {
+		JobWait &wait = mJobWaits[w];
+		CProcessPtr procPtr(wait.procPtr.lock());
+		bool stale = (!procPtr || procPtr->mSleepId != wait.sleepId);
+		if (stale || wait.counter->done()) {
+			if (!stale) wakeProcess(*procPtr);
+			mJobWaits[w] = mJobWaits.back();
+			mJobWaits.pop_back();
+		} else {
+			++w;
+		}
+	}
+}
+
+/*---------------------------------------------------------------------
+	Runs the process with the frame time plus any it missed while
+	deferred, and updates its average cost.
+---------------------------------------------------------------------*/
+void ProcessManager::runProcess(CProcess &p, float deltaMillis)
+{
+	__int64 start = HighPerfTimer::queryCounts();
+	p.update(deltaMillis + p.mDeferredMillis);
+	float cost = HighPerfTimer::secondsSince(start) * 1000.0f;
+
+	p.mDeferredMillis = 0;
+	p.mFramesDeferred = 0;
+	p.mCostMillis += (cost - p.mCostMillis) * PROCMGR_COST_SMOOTHING;
+}
+
+/*---------------------------------------------------------------------
+	Adds the explicit edges of every process in mFrameProcs to mEdges,
+	only those pointing forward in the order if forwardOnly. Edges to
+	processes that aren't running this frame are ignored.
+---------------------------------------------------------------------*/
+void ProcessManager::addExplicitEdges(bool forwardOnly)
+{
+	uint numProcs = static_cast<uint>(mFrameProcs.size());
+	for (uint n = 0; n < numProcs; ++n) {
+		const CProcess &p = *mFrameProcs[n];
+		for (int dir = 0; dir < 2; ++dir) {
+			const vector<string> &names = (dir == 0) ? p.mRunAfter : p.mRunBefore;
+			vector<string>::const_iterator si, send = names.end();
+			for (si = names.begin(); si != send; ++si) {
+				NameIndex::const_iterator ni = mNameIndex.find(*si);
+				if (ni == mNameIndex.end()) continue;
+				for (const CProcess *o = ni->second.first; o; o = o->mNextSameName) {
+					if (o->mFrameIndex < 0 || o == &p) continue;
+					uint other = static_cast<uint>(o->mFrameIndex);
+					ProcessEdge e = { (dir == 0) ? other : n, (dir == 0) ? n : other };
+					if (!forwardOnly || e.from < e.to) mEdges.push_back(e);
+				}
+			}
+		}
+	}
+}
+
+/*---------------------------------------------------------------------
+	Builds mNodes from mFrameProcs and mEdges, with each node's count of
+	dependencies and its successors in one range of mSuccessors
+---------------------------------------------------------------------*/
+void ProcessManager::buildNodes()
+{
+	uint numProcs = static_cast<uint>(mFrameProcs.size());
+	mNodes.resize(numProcs);
+	for (uint n = 0; n < numProcs; ++n) {
+		ProcessNode &node = mNodes[n];
+		node.proc = mFrameProcs[n];
+		node.pending = 0;
+		node.firstSucc = 0;
+		node.numSucc = 0;
+	}
+	vector<ProcessEdge>::const_iterator ei, eend = mEdges.end();
+	for (ei = mEdges.begin(); ei != eend; ++ei) {
+		++mNodes[ei->from].numSucc;
+		++mNodes[ei->to].pending;
+	}
+	uint first = 0;
+	for (uint n = 0; n < numProcs; ++n) {
+		mNodes[n].firstSucc = first;
+		first += mNodes[n].numSucc;
+		mNodes[n].numSucc = 0;
+	}
+	mSuccessors.resize(mEdges.size());
+	for (ei = mEdges.begin(); ei != eend; ++ei) {
+		ProcessNode &from = mNodes[ei->from];
+		mSuccessors[from.firstSucc + from.numSucc++] = ei->to;
+	}
+}
+
+/*---------------------------------------------------------------------
+	Puts mFrameProcs in topological order of the explicit edges, always
+	taking the ready process that comes first in the current order, so
+	without edges nothing moves. Returns false if the edges have a
+	cycle, leaving the order as it was.
+---------------------------------------------------------------------*/
+bool ProcessManager::orderFrameProcesses()
+{
+	mEdges.clear();
+	addExplicitEdges(false);
+	if (mEdges.empty()) return true;
+
+	buildNodes();
+	uint numProcs = static_cast<uint>(mFrameProcs.size());
+	mReady.clear();
+	for (uint n = 0; n < numProcs; ++n) {
+		if (mNodes[n].pending == 0) mReady.push_back(n);
+	}
+	std::make_heap(mReady.begin(), mReady.end(), std::greater<uint>());
+
+	mOrdered.clear();
+	while (!mReady.empty()) {
+		std::pop_heap(mReady.begin(), mReady.end(), std::greater<uint>());
+		uint n = mReady.back();
+		mReady.pop_back();
+		mOrdered.push_back(mFrameProcs[n]);
+
+		const ProcessNode &node = mNodes[n];
+		for (uint s = node.firstSucc; s < node.firstSucc + node.numSucc; ++s) {
+			uint succ = mSuccessors[s];
+			if (--mNodes[succ].pending == 0) {
+				mReady.push_back(succ);
+				std::push_heap(mReady.begin(), mReady.end(), std::greater<uint>());
+			}
+		}
+	}
+	if (mOrdered.size() != numProcs) return false;
+
+	mFrameProcs.swap(mOrdered);
+	for (uint n = 0; n < numProcs; ++n) {
+		mFrameProcs[n]->mFrameIndex = static_cast<int>(n);
+	}
+	return true;
+}
+
+/*---------------------------------------------------------------------
+	Builds the graph and runs it. Going through the processes in order, a
+	process depends on the last one to write anything it reads or writes,
+	and a writer also on every reader since the last write, which is all
+	it takes to keep conflicting processes in order. The main thread runs
+	the processes that aren't parallel as they become ready, and helps
+	with jobs while it has none.
+---------------------------------------------------------------------*/
+void ProcessManager::runGraph()
+{
+	uint numProcs = static_cast<uint>(mFrameProcs.size());
+	mEdges.clear();
+	addExplicitEdges(true);
+
+	mEdgeMark.assign(numProcs, numProcs);
+	int lastWriter[32];
+	for (int b = 0; b < 32; ++b) {
+		lastWriter[b] = -1;
+		mReaders[b].clear();
+	}
+	for (uint n = 0; n < numProcs; ++n) {
+		const CProcess &p = *mFrameProcs[n];
+		CProcessDataMask access = p.mReads | p.mWrites;
+		for (int b = 0; b < 32; ++b) {
+			CProcessDataMask bit = 1U << b;
+			if ((access & bit) == 0) continue;
+			if (lastWriter[b] >= 0) addDataEdge(static_cast<uint>(lastWriter[b]), n);
+			if (p.mWrites & bit) {
+				vector<uint>::const_iterator ri, rend = mReaders[b].end();
+				for (ri = mReaders[b].begin(); ri != rend; ++ri) {
+					addDataEdge(*ri, n);
+				}
+				mReaders[b].clear();
+				lastWriter[b] = static_cast<int>(n);
+			} else {
+				mReaders[b].push_back(n);
+			}
+		}
+	}
+	buildNodes();
+
+	// collect the roots before dispatching any, a dispatched process may release others
+	mReady.clear();
+	for (uint n = 0; n < numProcs; ++n) {
+		if (mNodes[n].pending == 0) mReady.push_back(n);
+	}
+	mMainReady.clear();
+	mNodesLeft = static_cast<LONG>(numProcs);
+	vector<uint>::const_iterator ri, rend = mReady.end();
+	for (ri = mReady.begin(); ri != rend; ++ri) {
+		dispatchNode(*ri);
+	}
+
+	while (mNodesLeft > 0) {
+		uint n = 0;
+		bool found = false;
+		{
+			mutex::scoped_lock lock(mMainReadyMutex);
+			if (!mMainReady.empty()) {
+				n = mMainReady.back();
+				mMainReady.pop_back();
+				found = true;
+			}
+		}
+		if (found) {
+			runNode(n);
+		} else if (!jobSys.runOneJob()) {
+			SwitchToThread();
+		}
+	}
+	jobSys.wait(mGraphJobs); // the last jobs may still be releasing the counter
+}
+
+/*---------------------------------------------------------------------
+	Adds a data dependency edge unless the same one was just added, all
+	edges into a node are added together so that catches every duplicate
+---------------------------------------------------------------------*/
+void ProcessManager::addDataEdge(uint from, uint to)
+{
+	if (mEdgeMark[from] == to) return;
+	mEdgeMark[from] = to;
+	ProcessEdge e = { from, to };
+	mEdges.push_back(e);
+}
+
+/*---------------------------------------------------------------------
+	Hands a process with no dependencies left to a worker if it's
+	parallel, or to the main thread
+---------------------------------------------------------------------*/
+void ProcessManager::dispatchNode(uint index)
+{
+	if (mNodes[index].proc->mParallel) {
+		jobSys.spawn(&ProcessManager::runNodeJob, &mNodes[index], &mGraphJobs);
+	} else {
+		mutex::scoped_lock lock(mMainReadyMutex);
+		mMainReady.push_back(index);
+	}
+}
+
+void ProcessManager::runNodeJob(void *param)
+{
+	ProcessManager &pm = procMgr;
+	pm.runNode(static_cast<uint>(static_cast<ProcessNode*>(param) - &pm.mNodes[0]));
+}
+
+/*---------------------------------------------------------------------
+	Runs one process of the graph, on whichever thread it was given to,
+	then releases its successors
+---------------------------------------------------------------------*/
+void ProcessManager::runNode(uint index)
+{
+	const ProcessNode &node = mNodes[index];
+	CProcess &p = *node.proc;
+	// a process that ran earlier this frame may have finished or paused this one
+	if (!p.isFinished() && p.isActive() && !p.isPaused()) {
+		runProcess(p, mFrameDelta);
+	}
+	for (uint s = node.firstSucc; s < node.firstSucc + node.numSucc; ++s) {
+		uint succ = mSuccessors[s];
+		if (InterlockedDecrement(&mNodes[succ].pending) == 0) dispatchNode(succ);
+	}
+	InterlockedDecrement(&mNodesLeft);
+}
+
+/*---------------------------------------------------------------------
+	Detaches finished processes (attaching their successors), then
+	chooses the processes to run this frame: every AlwaysRun process, and
+	CanDelay processes while their average costs fit in what's left of
+	the budget. AlwaysRun processes count against the budget too, they
+	just can't be deferred. Processes that ran are spliced to the back of
+	the list, which keeps their place for the next pass while the
+	deferred ones move up to the front.
+---------------------------------------------------------------------*/
 void ProcessManager::updateProcesses(float deltaMillis)
 {
+	__int64 frameStart = HighPerfTimer::queryCounts();
+	mFrameProcs.clear();
+	mDelayable.clear();
+	float estimate = 0;
+
+	wakeWaiting();
+
 	ProcessList::iterator i = mProcessList.begin(), end = mProcessList.end();
 
 	while (i != end) {
@@ -46,14 +498,80 @@ void ProcessManager::updateProcesses(float deltaMillis)
 			if (pNext) {	// if the process has a child
 				// erase the reference to the child process residing in the current one
 				p->setNextProcess(CProcessPtr((CProcess *)NULL));
-				attach(pNext);	// and kick off the new process
+				if (!attach(pNext)) {	// and kick off the new process
+					// a Single successor was refused because one of its name is running,
+					// chain it behind the end of that one's chain so it still gets to run
+					CProcess *tail = findByKey(pNext->mKey);
+					while (tail->getNextProcess()) tail = tail->getNextProcess().get();
+					tail->setNextProcess(pNext);
+					debugPrintf("ProcessManager: \"%s\" process chained behind \"%s\"\n", pNext->name().c_str(), tail->name().c_str());
+				}
 			}
 			detach(p);		// then detach the current process
 
 		} else if (p->isActive() && !p->isPaused()) {
-			p->update(deltaMillis);
+			if (p->mRunMode == CProcess_Run_AlwaysRun) {
+				mFrameProcs.push_back(p.get());
+				estimate += p->isInitialized() ? p->mCostMillis : PROCMGR_NEW_PROCESS_COST;
+			} else {
+				mDelayable.push_back(p.get());
+			}
+		}
+	}
+
+	// fill what's left of the budget with the processes that can wait
+	mNumDeferred = 0;
+	vector<CProcess*>::const_iterator di, dend = mDelayable.end();
+	for (di = mDelayable.begin(); di != dend; ++di) {
+		CProcess &p = *(*di);
+		float cost = p.isInitialized() ? p.mCostMillis : PROCMGR_NEW_PROCESS_COST;
+		if (mFrameBudget <= 0 || estimate + cost <= mFrameBudget ||
+			p.mFramesDeferred >= PROCMGR_MAX_DEFERRED_FRAMES)
+		{
+			mFrameProcs.push_back(&p);
+			estimate += cost;
+		} else {
+			p.mDeferredMillis += deltaMillis;
+			++p.mFramesDeferred;
+			++mNumDeferred;
+		}
+	}
+	mDelayable.clear();
+
+	if (!mFrameProcs.empty()) {
+		uint numProcs = static_cast<uint>(mFrameProcs.size());
+		bool anyParallel = false;
+		for (uint n = 0; n < numProcs; ++n) {
+			mFrameProcs[n]->mFrameIndex = static_cast<int>(n);
+			anyParallel = anyParallel || mFrameProcs[n]->mParallel;
+		}
+		if (!orderFrameProcesses()) {
+			debugPrintf("ProcessManager: runAfter/runBefore edges form a cycle, those against list order are ignored\n");
+		}
+
+		mFrameDelta = deltaMillis;
+		if (anyParallel && JobSystem::exists()) {
+			runGraph();
+		} else {
+			for (uint n = 0; n < numProcs; ++n) {
+				CProcess &p = *mFrameProcs[n];
+				// a process that ran earlier this frame may have finished or paused this one
+				if (!p.isFinished() && p.isActive() && !p.isPaused()) {
+					runProcess(p, deltaMillis);
+				}
+			}
+		}
+
+		for (uint n = 0; n < numProcs; ++n) {
+			CProcess &p = *mFrameProcs[n];
+			p.mFrameIndex = -1;
+			// a process that went to sleep is already out of the run list
+			if (p.mRunMode == CProcess_Run_CanDelay && !p.isSleeping()) {
+				mProcessList.splice(mProcessList.end(), mProcessList, p.mListPos);
+			}
 		}
 	}
+	mLastFrameMillis = HighPerfTimer::secondsSince(frameStart) * 1000.0f;
 }
 
 /*---------------------------------------------------------------------
@@ -61,5 +579,23 @@ void ProcessManager::updateProcesses(float deltaMillis)
 ---------------------------------------------------------------------*/
 void ProcessManager::clear()
 {
+	ProcessList::iterator i, end = mProcessList.end();
+	for (i = mProcessList.begin(); i != end; ++i) {
+		CProcess &p = *(*i);
+		p.setAttached(false);
+		p.mPrevSameName = p.mNextSameName = 0;
+		p.mListPos = ProcessList::iterator();
+	}
+	for (i = mSleepList.begin(), end = mSleepList.end(); i != end; ++i) {
+		CProcess &p = *(*i);
+		p.setAttached(false);
+		p.mProcessFlags[CProcess::bitSleeping] = false;
+		p.mPrevSameName = p.mNextSameName = 0;
+		p.mListPos = ProcessList::iterator();
+	}
+	mNameIndex.clear();
 	mProcessList.clear();
+	mSleepList.clear();
+	mTimerWaits.clear();
+	mJobWaits.clear();
 }
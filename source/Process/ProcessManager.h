@@ -1,40 +1,69 @@
 /*----==== PROCESSMANAGER.H ====----
 	Author:		Jeff Kiah
 	Orig.Date:	04/20/2007
-	Rev.Date:	06/14/2009
+	Rev.Date:	10/17/2026
 ----------------------------------*/
 
 #pragma once
 
 #include <string>
 #include <list>
+#include <vector>
 #include <bitset>
+#include <hash_map>
 #include <boost/noncopyable.hpp>
 #include <memory>
 #include "../Utility/Typedefs.h"
 #include "../Utility/Singleton.h"
+#include "JobSystem.h"
 
 using std::string;
 using std::list;
+using std::vector;
 using std::bitset;
 using std::shared_ptr;
+using std::weak_ptr;
+using stdext::hash_map;
 
 ///// DEFINITIONS /////
 
 #define	procMgr		ProcessManager::instance()
 
-// ** NOTE **
-// The settings controlled by these enums are not implemented yet
+#define PROCMGR_DEFAULT_BUDGET		4.0f	// ms per frame for all processes, CanDelay ones wait once it's spent. 0 for no limit
+#define PROCMGR_MAX_DEFERRED_FRAMES	8		// a CanDelay process deferred this many frames in a row runs regardless
+#define PROCMGR_COST_SMOOTHING		0.25f	// weight of the latest run in a process's average cost
+#define PROCMGR_NEW_PROCESS_COST	0.25f	// ms assumed for a process that hasn't run yet
 
 enum CProcessQueueMode : uchar {
-	CProcess_Queue_Multiple = 0,	// will allow multiple processes of same type in the list
-	CProcess_Queue_Single,			// only allow 1 process of type in the list at a time
-	CProcess_Queue_Single_Replace	// upon submission, will end and replace a process of same type
+	CProcess_Queue_Multiple = 0,	// will allow multiple processes of same type (name) in the list
+	CProcess_Queue_Single,			// only allow 1 process of type in the list at a time, attach fails otherwise
+	CProcess_Queue_Single_Replace	// upon submission, will end and replace any process of same type
 };
 
 enum CProcessRunMode : uchar {
 	CProcess_Run_AlwaysRun = 0,		// will run the process every frame regardless of time
-	CProcess_Run_CanDelay			// if max frame time exceeded, will run in a later frame
+	CProcess_Run_CanDelay			// if the frame budget is spent, will run in a later frame
+};
+
+/*---------------------------------------------------------------------
+	Engine data a process reads or writes during update. Processes whose
+	accesses don't conflict (nobody writes what the other reads or writes)
+	may run at the same time, see ProcessManager.
+---------------------------------------------------------------------*/
+typedef uint CProcessDataMask;
+
+enum CProcessData : uint {
+	CProcessData_None		= 0,
+	CProcessData_Scene		= 1 << 0,
+	CProcessData_Physics	= 1 << 1,
+	CProcessData_Animation	= 1 << 2,
+	CProcessData_Audio		= 1 << 3,
+	CProcessData_AI			= 1 << 4,
+	CProcessData_Resources	= 1 << 5,
+	CProcessData_Scripting	= 1 << 6,
+	CProcessData_Render		= 1 << 7,
+	CProcessData_Game		= 1 << 8,	// first bit free for game code
+	CProcessData_All		= 0xFFFFFFFF
 };
 
 class CProcess;
@@ -48,14 +77,36 @@ class CProcess
 =============================================================================*/
 class CProcess : private boost::noncopyable {
 	friend class ConcurrentManager;
+	friend class ProcessManager;	// schedules with the cost and deferral members below
 
 	protected:
 		///// VARIABLES /////
-		bitset<5>			mProcessFlags;
+		bitset<6>			mProcessFlags;
 		CProcessRunMode		mRunMode;
 		CProcessQueueMode	mQueueMode;
 		CProcessPtr			mNext;
 		const string		mName;
+		JobCounter			mJobs;		// jobs spawned by this process and not yet joined
+
+		float				mCostMillis;		// smoothed time spent in update
+		float				mDeferredMillis;	// frame time not yet passed to update while deferred
+		uint				mFramesDeferred;	// frames in a row skipped for lack of budget
+
+		// set by ProcessManager while attached
+		ProcessList::iterator	mListPos;		// position in the process list, for constant time detach
+		string					mKey;			// lower case name, key of the name index
+		CProcess *				mPrevSameName;	// chain of attached processes sharing the name
+		CProcess *				mNextSameName;
+
+		// dependencies, see ProcessManager
+		bool				mParallel;		// may run on a worker thread
+		CProcessDataMask	mReads;
+		CProcessDataMask	mWrites;
+		vector<string>		mRunAfter;		// lower case names of processes to run after
+		vector<string>		mRunBefore;		// and before
+		int					mFrameIndex;	// position in this frame's schedule while updating, else -1
+
+		uint				mSleepId;		// incremented on every sleep and wake, tells stale wake-ups apart
 
 		///// DEFINITIONS /////
 		enum CProcessFlagBits : size_t {
@@ -63,7 +114,8 @@ class CProcess : private boost::noncopyable {
 			bitActive,
 			bitPaused,
 			bitInitialized,
-			bitAttached
+			bitAttached,
+			bitSleeping
 		};
 
 		///// FUNCTIONS /////
@@ -78,6 +130,18 @@ class CProcess : private boost::noncopyable {
 		virtual void	onFinish() = 0;
 		virtual void	onTogglePause() = 0;
 
+		/*---------------------------------------------------------------------
+			Parallel work from within onUpdate. spawnJob queues func(param)
+			on the JobSystem against this process's counter, and joinJobs
+			runs jobs until all of them are done. Join before onUpdate returns
+			if the results are needed this frame, or leave them running over
+			the frame and join in the next update. Jobs outstanding when the
+			process finishes are joined before onFinish is called.
+		---------------------------------------------------------------------*/
+		void	spawnJob(JobFunc func, void *param) { jobSys.spawn(func, param, &mJobs); }
+		void	joinJobs()			{ if (!mJobs.done()) jobSys.wait(mJobs); }
+		bool	jobsDone() const	{ return mJobs.done(); }
+
 	public:
 		/*---------------------------------------------------------------------
 			This function is called to perform the main task of the process. If
@@ -94,7 +158,7 @@ class CProcess : private boost::noncopyable {
 
 		// Getters and setters
 		bool	isFinished() const	{ return mProcessFlags[bitFinished]; }
-		void	finish()			{ mProcessFlags[bitFinished] = true; onFinish(); }
+		void	finish();
 
 		bool	isActive() const	{ return mProcessFlags[bitActive]; }
 		void	setActive(bool b = true) { mProcessFlags[bitActive] = b; }
@@ -108,6 +172,14 @@ class CProcess : private boost::noncopyable {
 		bool	isInitialized() const { return mProcessFlags[bitInitialized]; }
 		void	setInitialized()	{ mProcessFlags[bitInitialized] = true; }
 
+		bool	isSleeping() const	{ return mProcessFlags[bitSleeping]; }
+		uint	sleepId() const		{ return mSleepId; }
+
+		/*---------------------------------------------------------------------
+			The next process is attached when this one finishes. If it is a
+			Single process and one of its name is running then, it is
+			chained behind that one (behind the end of its chain) instead.
+		---------------------------------------------------------------------*/
 		const CProcessPtr & getNextProcess() const { return mNext; }
 		void	setNextProcess(const CProcessPtr &procPtr) {
 			_ASSERTE((procPtr.get() != this) && "Don't chain a process to itself!");
@@ -116,44 +188,248 @@ class CProcess : private boost::noncopyable {
 		
 		const string &	name() const { return mName; }
 
+		/*---------------------------------------------------------------------
+			Dependencies for the parallel update. By default a process runs
+			on the main thread and reads and writes everything, so it keeps
+			its place in the order relative to every other process. A process
+			that declares what it reads and writes only waits for processes
+			it conflicts with, and one made parallel may then run on a worker
+			thread. A parallel process must not attach processes, change
+			other processes' state, or raise events other than with
+			raiseThreadSafe.
+			runAfter and runBefore add explicit edges to every process of the
+			given name, on top of the data dependencies.
+		---------------------------------------------------------------------*/
+		void	setParallel(bool b = true)	{ mParallel = b; }
+		bool	isParallel() const			{ return mParallel; }
+		void	setDataAccess(CProcessDataMask reads, CProcessDataMask writes) {
+					mReads = reads;
+					mWrites = writes;
+				}
+		CProcessDataMask	reads() const	{ return mReads; }
+		CProcessDataMask	writes() const	{ return mWrites; }
+		void	runAfter(const string &procName);
+		void	runBefore(const string &procName);
+
+		CProcessRunMode	runMode() const			{ return mRunMode; }
+		float			costMillis() const		{ return mCostMillis; }
+		uint			framesDeferred() const	{ return mFramesDeferred; }
+
 		// Constructor / destructor
 		explicit CProcess(const string &name,
 						  CProcessRunMode runMode = CProcess_Run_CanDelay,
 						  CProcessQueueMode queueMode = CProcess_Queue_Multiple) :
 			mName(name), mRunMode(runMode), mQueueMode(queueMode),
-			mProcessFlags(0), mNext(CProcessPtr((CProcess *)NULL))
+			mProcessFlags(0), mNext(CProcessPtr((CProcess *)NULL)), mJobs(),
+			mCostMillis(0), mDeferredMillis(0), mFramesDeferred(0),
+			mListPos(), mKey(), mPrevSameName(0), mNextSameName(0),
+			mParallel(false), mReads(CProcessData_All), mWrites(CProcessData_All),
+			mRunAfter(), mRunBefore(), mFrameIndex(-1), mSleepId(0)
 		{
 			mProcessFlags[bitActive] = true;
 		}
-		virtual ~CProcess() {}
+		virtual ~CProcess() { joinJobs(); }
 };
 
 /*=============================================================================
 class ProcessManager
+	Runs attached processes once per frame. AlwaysRun processes run every
+	frame, and count against the frame budget. CanDelay processes share
+	what is left of it: each one runs if its average cost fits, and is
+	deferred to a later frame otherwise, with the frame time it missed
+	added to its next update. Processes that run are moved to the back of
+	the list, so deferred ones are first in line next frame, and one
+	deferred for PROCMGR_MAX_DEFERRED_FRAMES in a row runs whatever the
+	budget. Budget decisions are made before anything runs, from the
+	average costs, with processes that haven't run yet assumed to cost
+	PROCMGR_NEW_PROCESS_COST.
+	The processes chosen for the frame form a dependency graph. They are
+	ordered by their explicit runAfter/runBefore edges, then by list order
+	(AlwaysRun first). Each process depends on the explicit edges and on
+	the processes before it whose declared data access conflicts with its
+	own. If any of them are parallel, the graph runs on the JobSystem:
+	parallel processes run as jobs as soon as their dependencies are done,
+	and the main thread runs the others, helping with jobs in between.
+	Otherwise, or without a JobSystem, they run in order on the main thread.
+	Each process keeps its position in the list, and attached processes
+	are indexed by name (case-insensitive), with the processes sharing a
+	name linked through the processes themselves. Attach, detach and
+	lookup by name don't search the list, and enforcing the queue modes
+	only looks at processes of the same name.
 =============================================================================*/
 class ProcessManager : public Singleton<ProcessManager> {
 	private:
+		///// DEFINITIONS /////
+		struct TimerWait {
+			__int64				wakeCounts;		// HighPerfTimer counts
+			weak_ptr<CProcess>	procPtr;
+			uint				sleepId;
+			bool operator>(const TimerWait &t) const { return (wakeCounts > t.wakeCounts); }
+		};
+
+		struct JobWait {
+			JobCounter *		counter;
+			weak_ptr<CProcess>	procPtr;
+			uint				sleepId;
+		};
+
 		///// VARIABLES /////
 		ProcessList		mProcessList;
+		ProcessList		mSleepList;			// sleeping processes, not looked at until woken
+		vector<TimerWait>	mTimerWaits;	// min-heap on wake time
+		vector<JobWait>		mJobWaits;
+
+		float			mFrameBudget;		// ms for all processes per frame, 0 for no limit
+		float			mLastFrameMillis;	// time spent in the last updateProcesses
+		uint			mNumDeferred;		// CanDelay processes deferred in the last updateProcesses
+		vector<CProcess*>	mDelayable;	// CanDelay processes waiting on the budget this frame
+
+		///// DEFINITIONS /////
+		struct NameEntry {
+			CProcess *	first;	// head of the chain of processes with this name
+			uint		count;
+		};
+		typedef hash_map<string, NameEntry>	NameIndex;
+
+		struct ProcessNode {
+			CProcess *		proc;
+			volatile LONG	pending;	// dependencies not yet run
+			uint			firstSucc;	// range of mSuccessors
+			uint			numSucc;
+		};
+
+		struct ProcessEdge {
+			uint	from, to;
+		};
+
+		///// VARIABLES /////
+		NameIndex		mNameIndex;		// attached processes by lower case name
 
-		// also need a multimap for random searches for processes and detaching
+		// this frame's schedule, kept between frames to reuse the memory
+		vector<CProcess*>		mFrameProcs;	// processes chosen to run, in schedule order
+		vector<ProcessEdge>		mEdges;
+		vector<uint>			mEdgeMark;		// last node each node was linked to, drops duplicate edges
+		vector<ProcessNode>		mNodes;			// parallel to mFrameProcs
+		vector<uint>			mSuccessors;	// node indices, grouped by predecessor
+		vector<uint>			mReaders[32];	// nodes reading each data bit since its last writer
+		vector<uint>			mReady;			// a heap of ready nodes while ordering, the roots when running
+		vector<CProcess*>		mOrdered;		// mFrameProcs reordered by the explicit edges
+		vector<uint>			mMainReady;		// main thread nodes with no dependencies left
+		mutex					mMainReadyMutex;
+		volatile LONG			mNodesLeft;
+		JobCounter				mGraphJobs;
+		float					mFrameDelta;
 
 		///// FUNCTIONS /////
 		void	detach(const CProcessPtr &procPtr);
 
+		/*---------------------------------------------------------------------
+			Wakes processes whose time has come or whose jobs are done
+		---------------------------------------------------------------------*/
+		void	wakeWaiting();
+
+		/*---------------------------------------------------------------------
+			Returns the newest attached, unfinished process of the name, or
+			0. The key must already be lower case.
+		---------------------------------------------------------------------*/
+		CProcess *	findByKey(const string &key) const;
+
+		/*---------------------------------------------------------------------
+			Puts mFrameProcs in topological order of the explicit edges,
+			breaking ties by their current order. Returns false if the edges
+			have a cycle, leaving the order as it was.
+		---------------------------------------------------------------------*/
+		bool	orderFrameProcesses();
+
+		/*---------------------------------------------------------------------
+			Adds the explicit edges of every process in mFrameProcs to
+			mEdges, only those pointing forward in the order if forwardOnly
+		---------------------------------------------------------------------*/
+		void	addExplicitEdges(bool forwardOnly);
+
+		/*---------------------------------------------------------------------
+			Builds the nodes and successor lists from the explicit edges and
+			the data dependencies, then runs the graph
+		---------------------------------------------------------------------*/
+		void	runGraph();
+		void	buildNodes();
+		void	addDataEdge(uint from, uint to);
+		void	runNode(uint index);
+		void	dispatchNode(uint index);
+		static void	runNodeJob(void *param);
+
+		/*---------------------------------------------------------------------
+			Runs the process with the frame time plus any it missed while
+			deferred, and updates its average cost.
+		---------------------------------------------------------------------*/
+		void	runProcess(CProcess &p, float deltaMillis);
+
 	public:
-		bool	isProcessActive(const string &procName);
-		bool	hasProcesses() const	{ return !mProcessList.empty(); }
+		static string	makeKey(const string &name);
+
+		/*---------------------------------------------------------------------
+			True if a process of the name is attached and not finished. The
+			name is not case sensitive.
+		---------------------------------------------------------------------*/
+		bool	isProcessActive(const string &procName) const;
+
+		/*---------------------------------------------------------------------
+			Returns an attached, unfinished process of the name, or an empty
+			pointer. With more than one, returns the last attached.
+		---------------------------------------------------------------------*/
+		CProcessPtr	findProcess(const string &procName) const;
+
+		// attached processes of the name, counting finished ones not yet detached
+		uint	numProcesses(const string &procName) const;
+		bool	hasProcesses() const	{ return !mProcessList.empty() || !mSleepList.empty(); }
+		uint	numSleeping() const		{ return static_cast<uint>(mSleepList.size()); }
 
-		void	attach(const CProcessPtr &procPtr);
+		/*---------------------------------------------------------------------
+			Sleeping processes are moved out of the run list, so they cost
+			nothing per frame until something wakes them. sleepProcess
+			sleeps until wakeProcess, sleepProcessFor until the time has
+			passed, and sleepProcessUntilDone until the counter reaches zero
+			(the counter must outlive the wait). The timed and job waits are
+			checked at the start of updateProcesses and woken processes run
+			that same frame. Whichever wake comes first ends the sleep, the
+			others are then ignored. Finishing a sleeping process wakes it so
+			it can be detached. Main thread only, and not for parallel
+			processes.
+		---------------------------------------------------------------------*/
+		void	sleepProcess(CProcess &p);
+		void	sleepProcessFor(CProcess &p, float millis);
+		void	sleepProcessUntilDone(CProcess &p, JobCounter &counter);
+		void	wakeProcess(CProcess &p);
+
+		/*---------------------------------------------------------------------
+			Adds the process to the list, applying its queue mode against
+			processes of the same name. Returns false if a Single process
+			was refused because one is already running.
+		---------------------------------------------------------------------*/
+		bool	attach(const CProcessPtr &procPtr);
 
+		/*---------------------------------------------------------------------
+			Detaches finished processes (attaching their successors), and
+			runs every AlwaysRun process and as many CanDelay processes as
+			fit in the frame budget, in parallel where their dependencies
+			allow
+		---------------------------------------------------------------------*/
 		void	updateProcesses(float deltaMillis);
 
+		void	setFrameBudget(float millis)	{ mFrameBudget = millis; }
+		float	frameBudget() const				{ return mFrameBudget; }
+		float	lastFrameMillis() const			{ return mLastFrameMillis; }
+		uint	numDeferred() const				{ return mNumDeferred; }
+
 		/*---------------------------------------------------------------------
 			destroys all processes in the list
 		---------------------------------------------------------------------*/
 		void	clear();
 
-		explicit ProcessManager() : Singleton<ProcessManager>(*this) {}
+		explicit ProcessManager() :
+			Singleton<ProcessManager>(*this),
+			mFrameBudget(PROCMGR_DEFAULT_BUDGET), mLastFrameMillis(0), mNumDeferred(0),
+			mNameIndex(), mNodesLeft(0), mGraphJobs(), mFrameDelta(0)
+		{}
 		~ProcessManager() {}
 };
\ No newline at end of file
@@ -0,0 +1,158 @@
+/*----==== RESUMABLEPROCESS.CPP ====----
+	Author:		Jeff Kiah
+	Orig.Date:	10/17/2026
+	Rev.Date:	10/17/2026
+--------------------------------------*/
+
+#include "ResumableProcess.h"
+#include "../Resource/ResourceProcess.h"
+#include <algorithm>
+#include <cctype>
+
+////////// class ResumableProcess //////////
+
+bool ResumableProcess::awaitMillis(float millis)
+{
+	mWakeEvent.reset();
+	if (millis <= 0) return false;
+	procMgr.sleepProcessFor(*this, millis);
+	return isSleeping();
+}
+
+/*---------------------------------------------------------------------
+	Without an AwaitListener nothing would wake the process, so it
+	yields for a frame instead and the caller polls as before
+---------------------------------------------------------------------*/
+bool ResumableProcess::awaitEvent(const string &eventType)
+{
+	mWakeEvent.reset();
+	if (!AwaitListener::exists()) return true;
+	procMgr.sleepProcess(*this);
+	if (!isSleeping()) return false;
+	AwaitListener::instance().addEventWaiter(eventType, *this);
+	return true;
+}
+
+bool ResumableProcess::awaitResource(const string &resPath)
+{
+	mWakeEvent.reset();
+	if (!AwaitListener::exists()) return true;
+	procMgr.sleepProcess(*this);
+	if (!isSleeping()) return false;
+	AwaitListener::instance().addResourceWaiter(resPath, *this);
+	return true;
+}
+
+bool ResumableProcess::awaitJobs(JobCounter &counter)
+{
+	mWakeEvent.reset();
+	if (counter.done()) return false;
+	procMgr.sleepProcessUntilDone(*this, counter);
+	return isSleeping();
+}
+
+////////// class AwaitListener //////////
+
+string AwaitListener::makeResourceKey(const string &resPath)
+{
+	string key(resPath);
+	std::replace(key.begin(), key.end(), '\\', '/');
+	std::transform(key.begin(), key.end(), key.begin(), ::tolower);
+	return key;
+}
+
+/*---------------------------------------------------------------------
+	Waits from earlier sleeps are left in the list until their event
+	comes, unless the list would grow, then they are purged first
+---------------------------------------------------------------------*/
+void AwaitListener::addWaiter(WaiterList &waiters, ResumableProcess &p)
+{
+	if (waiters.size() == waiters.capacity()) {
+		uint w = 0;
+		while (w < waiters.size()) {
+			CProcessPtr procPtr(waiters[w].procPtr.lock());
+			if (!procPtr || procPtr->sleepId() != waiters[w].sleepId) {
+				waiters[w] = waiters.back();
+				waiters.pop_back();
+			} else {
+				++w;
+			}
+		}
+	}
+	Waiter waiter;
+	waiter.procPtr = p.selfPtr();
+	waiter.sleepId = p.sleepId();
+	waiters.push_back(waiter);
+}
+
+/*---------------------------------------------------------------------
+	Wakes every process still asleep in the wait it was added for, and
+	empties the list keeping its capacity for the next waits
+---------------------------------------------------------------------*/
+void AwaitListener::wakeWaiters(WaiterList &waiters, const EventPtr &ePtr)
+{
+	WaiterList::const_iterator wi, end = waiters.end();
+	for (wi = waiters.begin(); wi != end; ++wi) {
+		CProcessPtr procPtr(wi->procPtr.lock());
+		if (procPtr && procPtr->isSleeping() && procPtr->sleepId() == wi->sleepId) {
+			static_cast<ResumableProcess*>(procPtr.get())->mWakeEvent = ePtr;
+			procMgr.wakeProcess(*procPtr);
+		}
+	}
+	waiters.clear();
+}
+
+void AwaitListener::addEventWaiter(const string &eventType, ResumableProcess &p)
+{
+	EventTypeId typeId = hashEventType(eventType);
+	EventWaiterMap::iterator wi = mEventWaiters.find(typeId);
+	if (wi == mEventWaiters.end()) {
+		if (!registerEventHandler(eventType, mHandler)) {
+			debugPrintf("AwaitListener: failed to register \"%s\", process \"%s\" will only wake on its own\n",
+						eventType.c_str(), p.name().c_str());
+		}
+		wi = mEventWaiters.insert(EventWaiterMap::value_type(typeId, WaiterList())).first;
+	}
+	addWaiter(wi->second, p);
+}
+
+void AwaitListener::addResourceWaiter(const string &resPath, ResumableProcess &p)
+{
+	addWaiter(mResourceWaiters[makeResourceKey(resPath)], p);
+}
+
+bool AwaitListener::handleEvent(const EventPtr &ePtr)
+{
+	EventWaiterMap::iterator wi = mEventWaiters.find(ePtr->typeId());
+	if (wi != mEventWaiters.end()) wakeWaiters(wi->second, ePtr);
+	return false; // allow event to propagate
+}
+
+/*---------------------------------------------------------------------
+	Wakes the waiters on the resource, and those awaiting the event
+	type itself
+---------------------------------------------------------------------*/
+bool AwaitListener::handleAsyncLoadDone(const EventPtr &ePtr)
+{
+	const AsyncLoadDoneEvent &e = *(static_cast<AsyncLoadDoneEvent*>(ePtr.get()));
+	ResourceWaiterMap::iterator wi = mResourceWaiters.find(makeResourceKey(e.mSourceName + '/' + e.mResName));
+	if (wi != mResourceWaiters.end()) {
+		wakeWaiters(wi->second, ePtr);
+		mResourceWaiters.erase(wi); // resources are usually loaded once, don't keep the entry
+	}
+	return handleEvent(ePtr);
+}
+
+/*---------------------------------------------------------------------
+	Registered after the ResCacheManager's listener, which has priority,
+	so the loaded resource is staged by the time the waiters try again
+---------------------------------------------------------------------*/
+AwaitListener::AwaitListener() :
+	EventListener("AwaitListener"),
+	Singleton<AwaitListener>(*this),
+	mHandler(new EventHandler<AwaitListener>(this, &AwaitListener::handleEvent))
+{
+	IEventHandlerPtr p(new EventHandler<AwaitListener>(this, &AwaitListener::handleAsyncLoadDone));
+	registerEventHandler(AsyncLoadDoneEvent::sEventType, p);
+	mEventWaiters.insert(EventWaiterMap::value_type(AsyncLoadDoneEvent::sEventTypeId, WaiterList()));
+}
@@ -0,0 +1,178 @@
+/*----==== RESUMABLEPROCESS.H ====----
+	Author:		Jeff Kiah
+	Orig.Date:	10/17/2026
+	Rev.Date:	10/17/2026
+------------------------------------*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <hash_map>
+#include <memory>
+#include "ProcessManager.h"
+#include "../Event/EventListener.h"
+#include "../Utility/Singleton.h"
+
+using std::string;
+using std::vector;
+using std::weak_ptr;
+using stdext::hash_map;
+
+///// DEFINITIONS /////
+
+/*---------------------------------------------------------------------
+	Use these in ResumableProcess::onResume. PROC_BEGIN starts the
+	body, PROC_END ends it and finishes the process. PROC_AWAIT calls
+	one of the await functions and, if it suspended the process,
+	returns, picking up right after it the next time onResume is
+	called. Each PROC_AWAIT or PROC_YIELD in a body needs its own label,
+	a positive integer constant (__LINE__ doesn't work under Edit and
+	Continue). Locals don't survive a suspend, so keep state in members,
+	and don't declare locals with initializers between the labels.
+---------------------------------------------------------------------*/
+#define PROC_BEGIN()			switch (resumePoint()) { case 0:
+#define PROC_AWAIT(label, await) \
+	do { setResumePoint(label); if (await) return; case label:; } while (0)
+#define PROC_YIELD(label)		PROC_AWAIT(label, true)
+#define PROC_END()				} finish()
+
+///// STRUCTURES /////
+
+/*=============================================================================
+class ResumableProcess
+	A process written as a sequence of steps that waits for things to
+	happen in between, rather than checking every frame whether they have.
+	While waiting the process is asleep in the ProcessManager and costs
+	nothing, it is woken when what it awaits happens:
+		awaitMillis		- the time has passed
+		awaitEvent		- an event of the type is handled
+		awaitResource	- the resource has finished loading (or failed to)
+		awaitJobs		- the JobCounter has reached zero
+	Each returns true if the process was suspended, false if there was
+	nothing to wait for, and is meant to be passed to PROC_AWAIT:
+
+		void onResume(float deltaMillis) {
+			PROC_BEGIN();
+			while ((mResult = mHandle.tryLoad<Texture_D3D9>(mPath)) == ResLoadResult_Waiting) {
+				PROC_AWAIT(1, awaitResource(mPath));
+			}
+			...
+			PROC_END();
+		}
+
+	A wake is a hint, not a promise, so check the condition again after it
+	as above. Finishing the process while it's asleep wakes it to be
+	detached. Resumable processes run on the main thread, they can't be
+	parallel.
+=============================================================================*/
+class ResumableProcess : public CProcess {
+	friend class AwaitListener;
+	private:
+		///// VARIABLES /////
+		int			mResumePoint;	// label to continue from, 0 to start from the top
+		EventPtr	mWakeEvent;		// the event that ended the last awaitEvent or awaitResource
+
+	protected:
+		///// FUNCTIONS /////
+		int		resumePoint() const			{ return mResumePoint; }
+		void	setResumePoint(int label)	{ mResumePoint = label; }
+
+		/*---------------------------------------------------------------------
+			The process body, called instead of onUpdate with the same
+			deltaMillis. Time spent asleep is not included in it.
+		---------------------------------------------------------------------*/
+		virtual void	onResume(float deltaMillis) = 0;
+
+		/*---------------------------------------------------------------------
+			Await functions, see above. awaitEvent and awaitResource only
+			yield for a frame if there is no AwaitListener. The JobCounter
+			passed to awaitJobs must outlive the wait, awaitJobs() waits on
+			the process's own spawned jobs.
+		---------------------------------------------------------------------*/
+		bool	awaitMillis(float millis);
+		bool	awaitEvent(const string &eventType);
+		bool	awaitResource(const string &resPath);
+		bool	awaitJobs(JobCounter &counter);
+		bool	awaitJobs()					{ return awaitJobs(mJobs); }
+
+		/*---------------------------------------------------------------------
+			The event that woke the process from awaitEvent or awaitResource,
+			empty if it was woken some other way
+		---------------------------------------------------------------------*/
+		const EventPtr &	wakeEvent() const { return mWakeEvent; }
+
+		virtual void	onUpdate(float deltaMillis) { onResume(deltaMillis); }
+		virtual void	onInitialize() {}
+		virtual void	onFinish() {}
+		virtual void	onTogglePause() {}
+
+	private:
+		/*---------------------------------------------------------------------
+			The list's pointer to this process, for the waits to hold weakly
+		---------------------------------------------------------------------*/
+		const CProcessPtr &	selfPtr() const { return *mListPos; }
+
+	public:
+		// Constructor / destructor
+		explicit ResumableProcess(const string &name,
+								  CProcessRunMode runMode = CProcess_Run_CanDelay,
+								  CProcessQueueMode queueMode = CProcess_Queue_Multiple) :
+			CProcess(name, runMode, queueMode),
+			mResumePoint(0), mWakeEvent()
+		{}
+		virtual ~ResumableProcess() {}
+};
+
+/*=============================================================================
+class AwaitListener
+	Wakes processes waiting in awaitEvent and awaitResource. Event types are
+	registered with the listener the first time they are awaited and stay
+	registered, so after that awaiting them costs a push_back. Resource
+	waits are keyed by resource path and matched against AsyncLoadDoneEvent.
+	A process is woken by the first event after it starts waiting, and only
+	if it is still asleep in that same wait. Awaited events must be handled
+	on the main thread, which queued events are. The engine creates this
+	after the ProcessManager and EventManager and destroys it before them.
+=============================================================================*/
+class AwaitListener : public EventListener, public Singleton<AwaitListener> {
+	friend class ResumableProcess;
+	private:
+		///// DEFINITIONS /////
+		struct Waiter {
+			weak_ptr<CProcess>	procPtr;
+			uint				sleepId;
+		};
+		typedef vector<Waiter>						WaiterList;
+		typedef hash_map<EventTypeId, WaiterList>	EventWaiterMap;
+		typedef hash_map<string, WaiterList>		ResourceWaiterMap;
+
+		///// VARIABLES /////
+		IEventHandlerPtr	mHandler;
+		EventWaiterMap		mEventWaiters;
+		ResourceWaiterMap	mResourceWaiters;
+
+		///// FUNCTIONS /////
+		bool	handleEvent(const EventPtr &ePtr);
+		bool	handleAsyncLoadDone(const EventPtr &ePtr);
+
+		/*---------------------------------------------------------------------
+			The process must already be asleep
+		---------------------------------------------------------------------*/
+		void	addEventWaiter(const string &eventType, ResumableProcess &p);
+		void	addResourceWaiter(const string &resPath, ResumableProcess &p);
+
+		static void	addWaiter(WaiterList &waiters, ResumableProcess &p);
+		static void	wakeWaiters(WaiterList &waiters, const EventPtr &ePtr);
+
+		/*---------------------------------------------------------------------
+			Source and name as the resource path, lower case with forward
+			slashes
+		---------------------------------------------------------------------*/
+		static string	makeResourceKey(const string &resPath);
+
+	public:
+		// Constructor / destructor
+		explicit AwaitListener();
+		virtual ~AwaitListener() {}
+};
@@ -1,7 +1,7 @@
 /*----==== THREADPROCESS.H ====----
 	Author:		Jeff Kiah
 	Orig.Date	05/18/2009
-	Rev.Date	06/10/2009
+	Rev.Date	10/17/2026
 ---------------------------------*/
 
 #pragma once
@@ -15,6 +15,10 @@ using boost::thread;
 
 /*=============================================================================
 class ThreadProcess
+	A process with a dedicated thread, for long running work that blocks,
+	like waiting on file I/O. Short CPU bound work should be spawned as jobs
+	on the JobSystem instead (see CProcess::spawnJob), which shares one
+	thread per core between all processes.
 =============================================================================*/
 class ThreadProcess : public CProcess {
 	private:
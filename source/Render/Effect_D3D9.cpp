@@ -1,7 +1,7 @@
 /*----==== EFFECT_D3D9.CPP ====----
 	Author:		Jeff Kiah
 	Orig.Date:	06/30/2009
-	Rev.Date:	07/08/2009
+	Rev.Date:	10/17/2026
 ---------------------------------*/
 
 #ifndef WIN32_LEAN_AND_MEAN
@@ -585,33 +585,36 @@ Effect_D3D9::~Effect_D3D9()
 
 ////////// class CheckResourceLoadedProcess //////////
 
-void Effect_D3D9::CheckResourceLoadedProcess::onUpdate(float deltaMillis) {
-	ResHandle h;
-	ResLoadResult retVal = h.tryLoad<Texture_D3D9>(mResourcePath);
-	if (retVal == ResLoadResult_Success) {
-		Texture_D3D9 *tex = static_cast<Texture_D3D9*>(h.getResPtr().get());
+void Effect_D3D9::CheckResourceLoadedProcess::onResume(float deltaMillis)
+{
+	PROC_BEGIN();
+	while ((mResult = mHandle.tryLoad<Texture_D3D9>(mResourcePath)) == ResLoadResult_Waiting) {
+		PROC_AWAIT(1, awaitResource(mResourcePath));
+	}
+	if (mResult == ResLoadResult_Success) {
+		Texture_D3D9 *tex = static_cast<Texture_D3D9*>(mHandle.getResPtr().get());
 		HRESULT hr = mpEffect->mD3DEffect->SetTexture(mParamHandle, tex->getD3DTexture());
 		if (FAILED(hr)) {
 			debugPrintf("Effect_D3D9: Error: failed to set texture \"%s\" in \"%s\"\n", mResourcePath.c_str(), mpEffect->name().c_str());
 			mpEffect->mInitialized = false; // set initialized back to false to be consistent with the way synchronous
 											// loading leaves the effect state
 		} else {
-			mpEffect->mResources.push_back(h.getResPtr());	// store a reference to the texture
+			mpEffect->mResources.push_back(mHandle.getResPtr());	// store a reference to the texture
 		}
-		finish();
-
-	} else if (retVal == ResLoadResult_Error) {
+	} else {
 		debugPrintf("Effect_D3D9: Error: failed to load child resource \"%s\" in \"%s\"\n", mResourcePath.c_str(), mpEffect->name().c_str());
 		mpEffect->mInitialized = false;
-		finish();
 	}
+	PROC_END();
 }
 
 Effect_D3D9::CheckResourceLoadedProcess::CheckResourceLoadedProcess(
 		Effect_D3D9 *pEff, D3DXHANDLE paramHandle,
 		const string &resourcePath) :
-	CProcess("CheckResourceLoadedProcess", CProcess_Run_CanDelay, CProcess_Queue_Multiple),
+	ResumableProcess("CheckResourceLoadedProcess", CProcess_Run_CanDelay, CProcess_Queue_Multiple),
 	mpEffect(pEff),
 	mResourcePath(resourcePath),
-	mParamHandle(paramHandle)
+	mParamHandle(paramHandle),
+	mHandle(),
+	mResult(ResLoadResult_Waiting)
 {}
\ No newline at end of file
@@ -1,12 +1,13 @@
 /*----==== EFFECT_D3D9.H ====----
 	Author:		Jeff Kiah
 	Orig.Date:	06/30/2009
-	Rev.Date:	07/08/2009
+	Rev.Date:	10/17/2026
 -------------------------------*/
 
 #pragma once
 
 #include "Resource_D3D9.h"
+#include "../Process/ResumableProcess.h"
 #include <d3dx9shader.h>
 #include <bitset>
 #include <vector>
@@ -77,19 +78,21 @@ class Effect_D3D9 : public Resource_D3D9 {
 			A list of spawned processes is maintained for the life of the
 			effect to protect against dereferencing a bad pointer in this
 			process. If the effect is destroyed first, it will call finish()
-			on all processes in the list that aren't already finished.
+			on all processes in the list that aren't already finished. The
+			process sleeps until the texture's load is done.
 		=====================================================================*/
-		class CheckResourceLoadedProcess : public CProcess {
+		class CheckResourceLoadedProcess : public ResumableProcess {
 			private:
 				string			mResourcePath;
 				D3DXHANDLE		mParamHandle;
 				Effect_D3D9 *	mpEffect;
+				ResHandle		mHandle;
+				ResLoadResult	mResult;
+
+			protected:
+				virtual void onResume(float deltaMillis);
 
 			public:
-				virtual void onUpdate(float deltaMillis);
-				virtual void onInitialize() {}
-				virtual void onFinish() {}
-				virtual void onTogglePause() {}
 
 				explicit CheckResourceLoadedProcess(Effect_D3D9 *pEff, D3DXHANDLE paramHandle,
 													const string &resourcePath);
@@ -1,7 +1,7 @@
 /*----==== MATERIAL_D3D9.CPP ====----
 	Author:		Jeff Kiah
 	Orig.Date:	09/14/2009
-	Rev.Date:	09/14/2009
+	Rev.Date:	10/17/2026
 -----------------------------------*/
 
 #include <d3dx9.h>
@@ -189,38 +189,45 @@ Material_D3D9::~Material_D3D9()
 
 ////////// class CheckResourceLoadedProcess //////////
 
-void Material_D3D9::CheckResourceLoadedProcess::onUpdate(float deltaMillis) {
-	ResHandle h;
+ResLoadResult Material_D3D9::CheckResourceLoadedProcess::tryLoad()
+{
+	if (mResType == MatResType_Texture) {
+		return mHandle.tryLoad<Texture_D3D9>(mResourcePath);
+	}
+	return mHandle.tryLoad<Effect_D3D9>(mResourcePath);
+}
+
+void Material_D3D9::CheckResourceLoadedProcess::onResume(float deltaMillis)
+{
+	PROC_BEGIN();
+	while ((mResult = tryLoad()) == ResLoadResult_Waiting) {
+		PROC_AWAIT(1, awaitResource(mResourcePath));
+	}
 	// handle texture loading
 	if (mResType == MatResType_Texture) {
-		ResLoadResult retVal = h.tryLoad<Texture_D3D9>(mResourcePath);
-		if (retVal == ResLoadResult_Success) {
+		if (mResult == ResLoadResult_Success) {
 			mpMaterial->mTextureFlags[mpMaterial->mTextures.size()] = true;
-			mpMaterial->mTextures.push_back(h.getResPtr());	// store a reference to the texture
-			finish();
-
-		} else if (retVal == ResLoadResult_Error) {
+			mpMaterial->mTextures.push_back(mHandle.getResPtr());	// store a reference to the texture
+		} else {
 			debugPrintf("Material_D3D9: Error: failed to load child resource \"%s\" in material\n", mResourcePath.c_str());
-			finish();
 		}
 	// handle effect loading
 	} else if (mResType == MatResType_Effect) {
-		ResLoadResult retVal = h.tryLoad<Effect_D3D9>(mResourcePath);
-		if (retVal == ResLoadResult_Success) {
-			mpMaterial->mEffect = h.getResPtr(); // store a reference to the texture
-			finish();
-
-		} else if (retVal == ResLoadResult_Error) {
+		if (mResult == ResLoadResult_Success) {
+			mpMaterial->mEffect = mHandle.getResPtr(); // store a reference to the effect
+		} else {
 			debugPrintf("Material_D3D9: Error: failed to load effect \"%s\" in material\n", mResourcePath.c_str());
-			finish();
 		}
 	}
+	PROC_END();
 }
 
 Material_D3D9::CheckResourceLoadedProcess::CheckResourceLoadedProcess(
 		Material_D3D9 *pMat, const string &resourcePath, MatResType resType) :
-	CProcess("CheckResourceLoadedProcess", CProcess_Run_CanDelay, CProcess_Queue_Multiple),
+	ResumableProcess("CheckResourceLoadedProcess", CProcess_Run_CanDelay, CProcess_Queue_Multiple),
 	mpMaterial(pMat),
 	mResourcePath(resourcePath),
-	mResType(resType)
+	mResType(resType),
+	mHandle(),
+	mResult(ResLoadResult_Waiting)
 {}
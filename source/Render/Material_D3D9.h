@@ -1,7 +1,7 @@
 /*----==== MATERIAL_D3D9.H ====----
 	Author:		Jeff Kiah
 	Orig.Date:	06/30/2009
-	Rev.Date:	06/30/2009
+	Rev.Date:	10/17/2026
 ---------------------------------*/
 
 #pragma once
@@ -12,6 +12,7 @@
 #include <memory>
 #include <boost/noncopyable.hpp>
 #include "../Resource/ResHandle.h"
+#include "../Process/ResumableProcess.h"
 
 using std::vector;
 using std::bitset;
@@ -42,9 +43,10 @@ class Material_D3D9 {
 			A list of spawned processes is maintained for the life of the
 			material to protect against dereferencing a bad pointer in this
 			process. If the material is destroyed first, it will call finish()
-			on all processes in the list that aren't already finished.
+			on all processes in the list that aren't already finished. The
+			process sleeps until the resource's load is done.
 		=====================================================================*/
-		class CheckResourceLoadedProcess : public CProcess {
+		class CheckResourceLoadedProcess : public ResumableProcess {
 			public:
 				enum MatResType : int {
 					MatResType_Texture = 0,
@@ -54,12 +56,15 @@ class Material_D3D9 {
 				string			mResourcePath;
 				MatResType		mResType;	// MatResType_Texture or MatResType_Effect
 				Material_D3D9 *	mpMaterial;
+				ResHandle		mHandle;
+				ResLoadResult	mResult;
+
+				ResLoadResult	tryLoad();
+
+			protected:
+				virtual void onResume(float deltaMillis);
 
 			public:
-				virtual void onUpdate(float deltaMillis);
-				virtual void onInitialize() {}
-				virtual void onFinish() {}
-				virtual void onTogglePause() {}
 
 				explicit CheckResourceLoadedProcess(Material_D3D9 *pMat, const string &resourcePath, MatResType resType);
 				virtual ~CheckResourceLoadedProcess() {}
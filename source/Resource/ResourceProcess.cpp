@@ -1,17 +1,32 @@
 /*----==== RESOURCEPROCESS.CPP ====----
 	Author:		Jeff Kiah
 	Orig.Date:	05/25/2009
-	Rev.Date:	06/10/2009
+	Rev.Date:	10/17/2026
 -------------------------------------*/
 
 #include "ResourceProcess.h"
 #include "../Event/EventManager.h"
 #include "../Event/RegisteredEvents.h"
+#include "../Event/EventSerialization.h"
 #include "ZipFile.h"
 
 ////////// class AsyncLoadEvent //////////
 
 const string AsyncLoadEvent::sEventType("SYS_RES_ASYNCLOAD");
+const EventTypeId AsyncLoadEvent::sEventTypeId(EVENT_TYPE_ID("SYS_RES_ASYNCLOAD"));
+
+void AsyncLoadEvent::serialize(ostream &out) const
+{
+	writeBinary(out, mResName);
+	writeBinary(out, mSourceName);
+}
+
+void AsyncLoadEvent::deserialize(istream &in)
+{
+	readBinary(in, mResName);
+	readBinary(in, mSourceName);
+	mSourcePtr.reset();
+}
 
 /*void AsyncLoadEvent::buildScriptData()
 {
@@ -41,10 +56,36 @@ AsyncLoadEvent::AsyncLoadEvent(const AnyVars &eventData) :
 ////////// class AsyncLoadDoneEvent //////////
 
 const string AsyncLoadDoneEvent::sEventType("SYS_RES_ASYNCLOAD_DONE");
+const EventTypeId AsyncLoadDoneEvent::sEventTypeId(EVENT_TYPE_ID("SYS_RES_ASYNCLOAD_DONE"));
+
+void AsyncLoadDoneEvent::serialize(ostream &out) const
+{
+	writeBinary(out, mSuccess);
+	writeBinary(out, mResName);
+	writeBinary(out, mSourceName);
+	int size = mDataPtr ? mSize : 0;
+	writeBinary(out, size);
+	if (size > 0) out.write(mDataPtr.get(), size);
+}
+
+void AsyncLoadDoneEvent::deserialize(istream &in)
+{
+	readBinary(in, mSuccess);
+	readBinary(in, mResName);
+	readBinary(in, mSourceName);
+	readBinary(in, mSize);
+	if (mSize > 0) {
+		mDataPtr.reset(new char[mSize], checked_array_deleter<char>());
+		in.read(mDataPtr.get(), mSize);
+	} else {
+		mDataPtr.reset();
+	}
+}
 
 ////////// class AsyncLoadProcess //////////
 
 const string AsyncLoadProcess::sAsyncLoadShutdownEvent("SYS_RES_ASYNCLOAD_SHUTDOWN");
+const EventTypeId AsyncLoadProcess::sAsyncLoadShutdownEventId(EVENT_TYPE_ID("SYS_RES_ASYNCLOAD_SHUTDOWN"));
 
 void AsyncLoadProcess::threadProc()
 {
@@ -55,7 +96,7 @@ void AsyncLoadProcess::threadProc()
 		// condition variable causes the process to sit idle until an event is in the queue,
 		// so a shutdown event could wake the thread and then exit. If load events
 		// are still queued, threadKilled() returning true could also cause an exit
-		if (ePtr->type() == sAsyncLoadShutdownEvent) break;
+		if (ePtr->typeId() == sAsyncLoadShutdownEventId) break;
 
 		// if it's not a shutdown event, we know it's a decompression event
 		AsyncLoadEvent &e = *(static_cast<AsyncLoadEvent*>(ePtr.get()));
@@ -93,15 +134,20 @@ AsyncLoadProcess::AsyncLoadProcess(const string &name) :
 	ThreadProcess(name)
 {
 	// register the decompress event
-	events.registerEventType(AsyncLoadEvent::sEventType,
-							 //RegEventPtr(new ScriptCallableCodeEvent<AsyncLoadEvent>(EventDataType_NotEmpty)));
-							 RegEventPtr(new CodeOnlyEvent(EventDataType_NotEmpty)));
+	//RegEventPtr loadRegPtr(new ScriptCallableCodeEvent<AsyncLoadEvent>(EventDataType_NotEmpty));
+	RegEventPtr loadRegPtr(new CodeOnlyEvent(EventDataType_NotEmpty));
+	loadRegPtr->setCategory(EventCategory_Resource);
+	loadRegPtr->setPriority(EventPriority_Bulk); // load requests can wait a frame when time is short
+	events.registerEventType(AsyncLoadEvent::sEventType, loadRegPtr);
 	// register the decompress done event
-	events.registerEventType(AsyncLoadDoneEvent::sEventType,
-							 RegEventPtr(new CodeOnlyEvent(EventDataType_NotEmpty)));
+	RegEventPtr doneRegPtr(new CodeOnlyEvent(EventDataType_NotEmpty));
+	doneRegPtr->setReadEventFunc(&deserializeEvent<AsyncLoadDoneEvent>);
+	doneRegPtr->setCategory(EventCategory_Resource);
+	events.registerEventType(AsyncLoadDoneEvent::sEventType, doneRegPtr);
 	// register the exit thread event
-	events.registerEventType(sAsyncLoadShutdownEvent,
-							 RegEventPtr(new CodeOnlyEvent(EventDataType_Empty)));
+	RegEventPtr shutdownRegPtr(new CodeOnlyEvent(EventDataType_Empty));
+	shutdownRegPtr->setCategory(EventCategory_Resource);
+	events.registerEventType(sAsyncLoadShutdownEvent, shutdownRegPtr);
 }
 
 AsyncLoadProcess::~AsyncLoadProcess()
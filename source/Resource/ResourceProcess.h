@@ -1,7 +1,7 @@
 /*----==== RESOURCEPROCESS.H ====----
 	Author:		Jeff Kiah
 	Orig.Date:	05/25/2009
-	Rev.Date:	06/10/2009
+	Rev.Date:	10/17/2026
 -----------------------------------*/
 
 #pragma once
@@ -26,6 +26,7 @@ class AsyncLoadEvent : public Event {
 
 		///// VARIABLES /////
 		static const string sEventType;
+		static const EventTypeId sEventTypeId;
 
 		string			mResName;		// the file to load from the source object
 		string			mSourceName;	// the name of the ResourceSource
@@ -33,8 +34,13 @@ class AsyncLoadEvent : public Event {
 
 		///// FUNCTIONS /////
 		const string &	type() const { return sEventType; }
-		void	serialize(ostream &out) const {}
-		void	deserialize(istream &in) {}
+		EventTypeId		typeId() const { return sEventTypeId; }
+		/*---------------------------------------------------------------------
+			Only the names are serialized, the source object can't be, so the
+			type isn't registered as serializable and isn't recorded
+		---------------------------------------------------------------------*/
+		void	serialize(ostream &out) const;
+		void	deserialize(istream &in);
 		//void	buildScriptData();
 
 		// Constructor / destructor
@@ -59,6 +65,7 @@ class AsyncLoadDoneEvent : public Event {
 
 		///// VARIABLES /////
 		static const string sEventType;
+		static const EventTypeId sEventTypeId;
 		bool		mSuccess;		// true if decompression successful
 		int			mSize;			// size of the buffer array
 		string		mResName;		// the resource path
@@ -67,8 +74,13 @@ class AsyncLoadDoneEvent : public Event {
 
 		///// FUNCTIONS /////
 		const string &	type() const { return sEventType; }
-		void	serialize(ostream &out) const {}
-		void	deserialize(istream &in) {}
+		EventTypeId		typeId() const { return sEventTypeId; }
+		/*---------------------------------------------------------------------
+			The loaded data is included, so a replayed session gets its
+			resources on the same frames without touching the disk
+		---------------------------------------------------------------------*/
+		void	serialize(ostream &out) const;
+		void	deserialize(istream &in);
 
 		// Constructor / destructor
 		explicit AsyncLoadDoneEvent(const string &resName, const string &sourceName,
@@ -77,6 +89,13 @@ class AsyncLoadDoneEvent : public Event {
 			mResName(resName), mSourceName(sourceName), mDataPtr(bPtr),
 			mSize(size), mSuccess(success)
 		{}
+		/*---------------------------------------------------------------------
+			Used by deserializeEvent, the data is filled in by deserialize
+		---------------------------------------------------------------------*/
+		explicit AsyncLoadDoneEvent() :
+			Event(),
+			mSuccess(false), mSize(0)
+		{}
 		virtual ~AsyncLoadDoneEvent() {}
 };
 
@@ -118,6 +137,7 @@ class AsyncLoadProcess : public ThreadProcess {
 
 	public:
 		static const string sAsyncLoadShutdownEvent;
+		static const EventTypeId sAsyncLoadShutdownEventId;
 
 		explicit AsyncLoadProcess(const string &name);
 		~AsyncLoadProcess();
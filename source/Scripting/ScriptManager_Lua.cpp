@@ -1,7 +1,7 @@
 /*----==== SCRIPTMANAGER_LUA.CPP ====----
 	Author:		Jeffrey Kiah
 	Orig.Date:	05/05/2009
-	Rev.Date:	05/13/2009
+	Rev.Date:	10/17/2026
 ---------------------------------------*/
 
 #include "ScriptManager_Lua.h"
@@ -18,6 +18,13 @@ using boost::any_cast;
 
 ///// STATIC VARIABLES /////
 const string LuaFunctionEvent::sEventType("SYS_SCRIPT_CALL_FUNCTION");
+const EventTypeId LuaFunctionEvent::sEventTypeId(EVENT_TYPE_ID("SYS_SCRIPT_CALL_FUNCTION"));
+
+////////// class ScriptCallEvent //////////
+
+///// STATIC VARIABLES /////
+const string ScriptCallEvent::sEventType("SYS_SCRIPT_CALL_REQUEST");
+const EventTypeId ScriptCallEvent::sEventTypeId(EVENT_TYPE_ID("SYS_SCRIPT_CALL_REQUEST"));
 
 ////////// class ScriptManager_Lua //////////
 
@@ -77,7 +84,7 @@ bool ScriptManager_Lua::registerScriptHandler(const char *eventType, LuaObject l
 {
 	_ASSERTE(luaFunc.IsFunction() && "Lua handler is not a function"); // debug error checking
 
-	EventHandlerMap::const_iterator i = mHandlerMap.find(eventType);
+	EventHandlerMap::const_iterator i = mHandlerMap.find(hashEventType(eventType));
 	if (i == mHandlerMap.end()) {
 		// if handler does not already exist, create new handler and register
 		IEventHandlerPtr p(new LuaEventHandler(luaFunc, priority));
@@ -108,7 +115,7 @@ bool ScriptManager_Lua::unregisterScriptHandler(const char *eventType, LuaObject
 	_ASSERTE(luaFunc.IsFunction() && "Lua object is not a function");
 
 	// find the handler for this event type
-	EventHandlerMap::const_iterator i = mHandlerMap.find(eventType);
+	EventHandlerMap::const_iterator i = mHandlerMap.find(hashEventType(eventType));
 	if (i != mHandlerMap.end()) {
 		LuaEventHandler &e = *(static_cast<LuaEventHandler*>(i->second.get()));
 		bool retVal = e.removeLuaFunction(luaFunc);	// tries to remove the function from the handler's list
@@ -146,6 +153,39 @@ bool ScriptManager_Lua::handleLuaFunctionEvent(const EventPtr &ePtr)
 	return true; // there should be no reason for another system to see or handle this event type, so mark it consumed
 }
 
+/*---------------------------------------------------------------------
+	Handler for ScriptCallEvent, calls the function and answers the
+	request with its return value. Runs on the main thread, so the Lua
+	state is only ever touched there. A missing function fails the
+	request so the caller isn't left waiting.
+---------------------------------------------------------------------*/
+bool ScriptManager_Lua::handleScriptCallEvent(const ScriptCallEvent &e)
+{
+	LuaObject luaObj = mGlobalState->GetGlobal(e.funcName().c_str());
+	if (!luaObj.IsFunction()) {
+		debugPrintf("%s: event \"%s\": object \"%s\" not a function\n", mName.c_str(), e.type().c_str(), e.funcName().c_str());
+		e.fail();
+		return false;
+	}
+	LuaObject paramTbl;
+	paramTbl.AssignNewTable(luaObj.GetState());
+	{
+		LuaTableWriter writer(paramTbl);
+		writer.write(e.params());
+	}
+	LuaFunction<LuaObject> luaFunc(luaObj);
+	LuaObject returnObj = luaFunc(paramTbl);
+
+	ScriptVars result;
+	if (returnObj.IsTable()) {
+		readLuaTable(returnObj, result);
+	} else {
+		readLuaValue(ScriptVarKey::index(), returnObj, result);
+	}
+	e.respond(result);
+	return true; // answered, no other system should see it
+}
+
 /*---------------------------------------------------------------------
 	Callable from script, registers a script-defined event type
 ---------------------------------------------------------------------*/
@@ -156,9 +196,11 @@ bool ScriptManager_Lua::registerEventType(const char *eventType)
 
 /*---------------------------------------------------------------------
 	Calls RegisteredEvent::raiseEventFromScript or "trigger". For
-	raising pass true, for trigger pass false.
+	raising pass true, for trigger pass false. A delay only applies to
+	raised events.
 ---------------------------------------------------------------------*/
-void ScriptManager_Lua::fireEventFromScript(const char *eventType, LuaObject &eventDataTbl, bool raise)
+void ScriptManager_Lua::fireEventFromScript(const char *eventType, LuaObject &eventDataTbl, bool raise,
+											ulong delayMillis)
 {
 	// look up item in event registry
 	RegEventPtr rePtr = events.getRegEventPtr(eventType);
@@ -168,32 +210,15 @@ void ScriptManager_Lua::fireEventFromScript(const char *eventType, LuaObject &ev
 		// found the event type in registry, but before doing anything, use a little RTTI to find out
 		// if this event is allowed to be triggered by script
 		if (rePtr->scriptAllowed()) {
-			AnyVars eventData;
-			// convert lua table data to list of pair<string, boost::any>
+			ScriptVars eventData;
+			// convert lua table data to script vars
 			if (eventDataTbl.IsTable()) {
 				if (rePtr->getEventSource() == EventSource_ScriptOnly) {
 					// for script-defined events, pass LuaObject into first position of list, don't translate
-					eventData.push_back(AnyVarsValue(string(), any(eventDataTbl)));
+					eventData.push_back(ScriptVarKey::index(), ScriptValue(any(eventDataTbl)));
 				} else {
 					// for code-defined events iterate through the lua table
-					for (LuaTableIterator it(eventDataTbl); it; it.Next()) {
-						const char *key = it.GetKey().GetString();
-						LuaObject luaValue = it.GetValue();
-						if (luaValue.IsNumber()) { // returns true for all lua numbers
-							// test if the number is an integer
-							float fVal = luaValue.GetFloat();
-							int iVal = FastMath::f2iTrunc(fVal);
-							if ((float)iVal == fVal) {
-								eventData.push_back(AnyVarsValue(string(key), iVal));
-							} else {
-								eventData.push_back(AnyVarsValue(string(key), fVal));
-							}
-						} else if (luaValue.IsString()) {
-							eventData.push_back(AnyVarsValue(string(key), string(luaValue.GetString())));
-						} else if (luaValue.IsBoolean()) {
-							eventData.push_back(AnyVarsValue(string(key), luaValue.GetBoolean()));
-						}
-					}
+					readLuaTable(eventDataTbl, eventData);
 				}
 			} else { // if what's passed in from lua isn't a table, enter a friendly reminder in debug log
 				if (!eventDataTbl.IsNone() && !eventDataTbl.IsNil()) { // but passing nothing IS legal
@@ -201,7 +226,7 @@ void ScriptManager_Lua::fireEventFromScript(const char *eventType, LuaObject &ev
 				}
 			}
 			if (raise) {
-				rePtr->raiseEventFromScript(eventType, eventData);
+				rePtr->raiseEventFromScript(eventType, eventData, delayMillis);
 			} else {
 				rePtr->triggerEventFromScript(eventType, eventData);
 			}
@@ -211,6 +236,55 @@ void ScriptManager_Lua::fireEventFromScript(const char *eventType, LuaObject &ev
 	}
 }
 
+/*---------------------------------------------------------------------
+	Converts a Lua table into script vars for a code-defined event.
+	Numbers that are whole become ints, nested tables become nested
+	ScriptVars, and number keys array elements. Names that code has
+	interned get the interned key, any other name is kept by string.
+---------------------------------------------------------------------*/
+void ScriptManager_Lua::readLuaTable(LuaObject &tbl, ScriptVars &outVars)
+{
+	for (LuaTableIterator it(tbl); it; it.Next()) {
+		LuaObject luaKey = it.GetKey();
+		ScriptVarKey key;
+		if (luaKey.IsString()) {
+			key = ScriptVarKey::fromScript(luaKey.GetString());
+		} else if (luaKey.IsNumber()) {
+			key = ScriptVarKey::index();
+		} else {
+			continue;
+		}
+		LuaObject luaValue = it.GetValue();
+		readLuaValue(key, luaValue, outVars);
+	}
+}
+
+/*---------------------------------------------------------------------
+	Converts one Lua value and adds it to outVars under key, types that
+	have no script var equivalent (functions, userdata) are skipped
+---------------------------------------------------------------------*/
+void ScriptManager_Lua::readLuaValue(const ScriptVarKey &key, LuaObject &luaValue, ScriptVars &outVars)
+{
+	if (luaValue.IsNumber()) { // returns true for all lua numbers
+		// test if the number is an integer
+		float fVal = luaValue.GetFloat();
+		int iVal = FastMath::f2iTrunc(fVal);
+		if ((float)iVal == fVal) {
+			outVars.push_back(key, ScriptValue(iVal));
+		} else {
+			outVars.push_back(key, ScriptValue(fVal));
+		}
+	} else if (luaValue.IsString()) {
+		outVars.push_back(key, ScriptValue(luaValue.GetString()));
+	} else if (luaValue.IsBoolean()) {
+		outVars.push_back(key, ScriptValue(luaValue.GetBoolean()));
+	} else if (luaValue.IsTable()) {
+		ScriptVars subVars;
+		readLuaTable(luaValue, subVars);
+		outVars.push_back(key, ScriptValue(subVars));
+	}
+}
+
 #include "../Settings.h"
 
 /*---------------------------------------------------------------------
@@ -230,6 +304,7 @@ bool ScriptManager_Lua::init(const string &initFileName)
 	mMetaTable.RegisterObjectDirect("unregisterHandler", (ScriptManager_Lua*)0, &ScriptManager_Lua::unregisterScriptHandler);
 	mMetaTable.RegisterObjectDirect("registerEvent", (ScriptManager_Lua*)0, &ScriptManager_Lua::registerEventType);
 	mMetaTable.RegisterObjectDirect("raiseEvent", (ScriptManager_Lua*)0, &ScriptManager_Lua::raiseEventFromScript);
+	mMetaTable.RegisterObjectDirect("raiseEventAfter", (ScriptManager_Lua*)0, &ScriptManager_Lua::raiseEventAfterFromScript);
 	mMetaTable.RegisterObjectDirect("triggerEvent", (ScriptManager_Lua*)0, &ScriptManager_Lua::triggerEventFromScript);
 
 	LuaObject luaStateManObj = mGlobalState->BoxPointer(this);
@@ -251,11 +326,18 @@ ScriptManager_Lua::ScriptManager_Lua() :
 	mGlobalState(true)	// 'true' indicates to init the standard Lua library
 {
 	// register the LuaFunctionEvent with EventManager
-	events.registerEventType(LuaFunctionEvent::sEventType,
-								RegEventPtr(new CodeOnlyEvent(EventDataType_NotEmpty)));
+	RegEventPtr funcRegPtr(new CodeOnlyEvent(EventDataType_NotEmpty));
+	funcRegPtr->setCategory(EventCategory_Scripting);
+	events.registerEventType(LuaFunctionEvent::sEventType, funcRegPtr);
 	// and register the handler for it
 	IEventHandlerPtr p(new EventHandler<ScriptManager_Lua>(this, &ScriptManager_Lua::handleLuaFunctionEvent));
 	registerEventHandler(LuaFunctionEvent::sEventType, p, 1); // register as priority 1 to ensure this handles the event first
+
+	// requests from other threads to call script, answered through a future
+	RegEventPtr callRegPtr(new CodeOnlyEvent(EventDataType_NotEmpty));
+	callRegPtr->setCategory(EventCategory_Scripting);
+	events.registerEventType(ScriptCallEvent::sEventType, callRegPtr);
+	subscribe(this, &ScriptManager_Lua::handleScriptCallEvent, 1);
 }
 
 ScriptManager_Lua::~ScriptManager_Lua()
@@ -267,6 +349,33 @@ ScriptManager_Lua::~ScriptManager_Lua()
 	clearHandlers();
 }
 
+////////// class LuaTableWriter //////////
+
+void LuaTableWriter::beginTable(const ScriptVarKey &key)
+{
+	TableFrame &f = mStack.back();
+	TableFrame sub;
+	sub.tbl = key.isIndex() ? f.tbl.CreateTable(f.nextIndex++) : f.tbl.CreateTable(key.name);
+	sub.nextIndex = 1;
+	mStack.push_back(sub); // f is not used after this, the push may reallocate
+}
+
+void LuaTableWriter::endTable()
+{
+	_ASSERTE(mStack.size() > 1);
+	mStack.pop_back();
+}
+
+// Constructor
+LuaTableWriter::LuaTableWriter(LuaObject &root)
+{
+	mStack.reserve(4);
+	TableFrame f;
+	f.tbl = root;
+	f.nextIndex = 1;
+	mStack.push_back(f);
+}
+
 ////////// class LuaEventHandler //////////
 
 /*---------------------------------------------------------------------
@@ -311,79 +420,59 @@ bool LuaEventHandler::removeLuaFunction(const LuaObject &luaFunc)
 	Calls each lua function that has been registered for the event type
 	and returns true if event consumed by one of the handlers in the
 	list. Lua event data is built if it hasn't already been before the
-	first handler is called.
-	**NOTE**
-	Could have the AnyVars list hold the resulting LuaObject instead of
-	parsing the boost::any values each time. Then, just check for the
-	LuaObject at the end of the list
+	first handler is called, and the Lua table is built once and shared
+	by all of the functions (handlers should treat it as immutable).
 ---------------------------------------------------------------------*/
 bool LuaEventHandler::operator()(const EventPtr &ePtr)
 {
-	RegEventPtr rePtr = events.getRegEventPtr(ePtr->type());
+	RegEventPtr rePtr = events.getRegEventPtr(ePtr->typeId());
 	if (!rePtr->scriptAllowed()) { // this handler was added before the event type was registered, but it's not valid
 		debugPrintf("LuaEventHandler: handler for \"%s\" code-only event not allowed\n", ePtr->type().c_str());
 		return false; // allow the event to propagate
 	}
+	if (mLuaFuncList.empty()) return false;
+
+	// empty events do not need event data processing, otherwise work out the single argument
+	// to pass to every function in the list
+	bool hasArg = false;
+	LuaObject eventDataTbl;
+	if (!rePtr->isEmpty()) {
+		ScriptableEvent &e = *(static_cast<ScriptableEvent*>(ePtr.get()));
+
+		// script-defined events only hold one object, the LuaObject to pass back
+		if (rePtr->getEventSource() == EventSource_ScriptOnly) {
+			_ASSERTE(e.getScriptData().size() <= 1 && "The list size should be 0 or 1 - just a LuaObject");
+			// passing nothing through a script event is legal
+			if (e.getScriptData().size() != 0) {
+				const ScriptValue &v = e.getScriptData().front().value;
+				_ASSERTE(v.type() == ScriptValue_Object && v.asObject().type() == typeid(LuaObject) && "Should be a LuaObject");
+				eventDataTbl = any_cast<LuaObject>(v.asObject());
+				hasArg = true;
+			}
+		} else {
+			// non script-defined events write their fields into a new table, use lua state already
+			// stored in the function object
+			eventDataTbl.AssignNewTable(mLuaFuncList.front().first.GetState());
+			LuaTableWriter writer(eventDataTbl);
+			if (e.isScriptDataBuilt()) {
+				// fired from script (or built by someone else), the vars are already there
+				writer.write(e.getScriptData());
+			} else {
+				// created in code, native fields go straight into the table with no intermediate list
+				e.writeScriptData(writer);
+			}
+			hasArg = true;
+		}
+	}
+
 	// cycle through all LuaFunctions in the list, if true is returned from one of the handlers
 	// the loop will exit early
 	bool retVal = false;
 	LuaFuncList::iterator fi = mLuaFuncList.begin(), end = mLuaFuncList.end();
 	while (fi != end && !retVal) {
 		LuaFunction<bool> luaFunc(fi->first); // prepare the function for calling
-		
-		// empty events do not need event data processing
-		if (!rePtr->isEmpty()) {
-			ScriptableEvent &e = *(static_cast<ScriptableEvent*>(ePtr.get()));
-
-			// if script event data hasn't been built do it now - this is possible
-			// when the event was created in code, but has script handlers
-			if (!e.isScriptDataBuilt()) e.buildScriptData();
-
-			// script-defined events only hold one object, the LuaObject to pass back
-			if (rePtr->getEventSource() == EventSource_ScriptOnly) {
-				_ASSERTE(e.getScriptData().size() <= 1 && "The list size should be 0 or 1 - just a LuaObject");
-				if (e.getScriptData().size() == 0) {
-					// passing nothing through a script event is legal
-					retVal = luaFunc();
-				} else {
-					_ASSERTE(e.getScriptData().front().second.type() == typeid(LuaObject) && "Should be a LuaObject");
-					// call the function passing table LuaObject with event data as the only parameter
-					retVal = luaFunc(any_cast<LuaObject>(e.getScriptData().front().second));
-				}
-			} else {
-				// ** NOTE **
-				// Here is where I could check the last list element and see if it's a LuaObject.
-				// If not, do the parsing below and push LuaObject onto the list (front or back).
-				// I could also erase all the other list elements and leave only the LuaObject.
-
-				// non script-defined events needs each item in the AnyVars list translated
-				// create the lua table object to be passed
-				LuaObject eventDataTbl;
-				eventDataTbl.AssignNewTable(fi->first.GetState()); // use lua state already stored in the function object
-				// iterate through the event data list, convert to lua table
-				AnyVars::const_iterator i, end = e.getScriptData().end();
-				for (i = e.getScriptData().begin(); i != end; ++i) {
-					try {
-						if (i->second.type() == typeid(int)) {
-							eventDataTbl.SetInteger(i->first.c_str(), any_cast<int>(i->second));
-						} else if (i->second.type() == typeid(float)) {
-							eventDataTbl.SetNumber(i->first.c_str(), any_cast<float>(i->second));
-						} else if (i->second.type() == typeid(string)) {
-							eventDataTbl.SetString(i->first.c_str(), any_cast<string>(i->second).c_str());
-						} else if (i->second.type() == typeid(bool)) {
-							eventDataTbl.SetBoolean(i->first.c_str(), any_cast<bool>(i->second));
-						}
-					} catch (boost::bad_any_cast &ex) {
-						debugPrintf("Lua: bad_any_cast \"%s\"\n", ex.what());
-					}
-				}
-				// call the function passing table LuaObject with event data as the only parameter
-				retVal = luaFunc(eventDataTbl);
-			}
-		} else {
-			// handles EmptyEvent types
-			retVal = luaFunc();
-		}
+		// call the function passing table LuaObject with event data as the only parameter
+		retVal = hasArg ? luaFunc(eventDataTbl) : luaFunc();
 		++fi;
 	}
 	return retVal;
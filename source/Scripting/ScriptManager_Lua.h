@@ -1,12 +1,13 @@
 /*----==== SCRIPTMANAGER_LUA.H ====----
 	Author:		Jeffrey Kiah
 	Orig.Date:	05/05/2009
-	Rev.Date:	05/13/2009
+	Rev.Date:	10/17/2026
 -------------------------------------*/
 
 #pragma once
 
 #include <string>
+#include <vector>
 #include <LuaPlus/LuaLink.h>
 #include <LuaPlus/LuaPlus.h>
 #include <LuaPlus/LuaObject.h>
@@ -14,10 +15,13 @@
 #include "../Event/EventListener.h"
 
 using std::string;
+using std::vector;
 using LuaPlus::LuaStateOwner;
 using LuaPlus::LuaObject;
 using LuaPlus::LuaFunction;
 
+class ScriptCallEvent;
+
 /*=============================================================================
 class ScriptManager_Lua
 =============================================================================*/
@@ -63,19 +67,40 @@ class ScriptManager_Lua : public EventListener {
 			Callable from script, causes event to be raised
 		---------------------------------------------------------------------*/
 		void	raiseEventFromScript(const char *eventType, LuaObject eventDataTbl) {
-					fireEventFromScript(eventType, eventDataTbl, true);
+					fireEventFromScript(eventType, eventDataTbl, true, 0);
+				}
+		/*---------------------------------------------------------------------
+			Callable from script, causes event to be raised after a delay in
+			milliseconds, replacing per-frame polling in script
+		---------------------------------------------------------------------*/
+		void	raiseEventAfterFromScript(const char *eventType, uint delayMillis, LuaObject eventDataTbl) {
+					fireEventFromScript(eventType, eventDataTbl, true, delayMillis);
 				}
 		/*---------------------------------------------------------------------
 			Callable from script, causes event to be triggered
 		---------------------------------------------------------------------*/
 		void	triggerEventFromScript(const char *eventType, LuaObject eventDataTbl) {
-					fireEventFromScript(eventType, eventDataTbl, false);
+					fireEventFromScript(eventType, eventDataTbl, false, 0);
 				}
 		/*-------------------------------------------------------------
 			Calls RegisteredEvent::raiseEventFromScript or "trigger".
-			For raising pass true, for trigger pass false.
+			For raising pass true, for trigger pass false. A delay only
+			applies to raised events.
+		-------------------------------------------------------------*/
+		void	fireEventFromScript(const char *eventType, LuaObject &eventDataTbl, bool raise, ulong delayMillis);
+
+		/*-------------------------------------------------------------
+			Converts a Lua table into script vars for a code-defined
+			event. Numbers that are whole become ints, nested tables
+			become nested ScriptVars, and number keys array elements.
+		-------------------------------------------------------------*/
+		static void	readLuaTable(LuaObject &tbl, ScriptVars &outVars);
+
+		/*-------------------------------------------------------------
+			Converts one Lua value and adds it to outVars under key,
+			types that have no script var equivalent are skipped
 		-------------------------------------------------------------*/
-		void	fireEventFromScript(const char *eventType, LuaObject &eventDataTbl, bool raise);
+		static void	readLuaValue(const ScriptVarKey &key, LuaObject &luaValue, ScriptVars &outVars);
 
 		/*---------------------------------------------------------------------
 			Handler for the LuaFunctionEvent event for code to call functions
@@ -83,6 +108,12 @@ class ScriptManager_Lua : public EventListener {
 		---------------------------------------------------------------------*/
 		bool	handleLuaFunctionEvent(const EventPtr &ePtr);
 
+		/*---------------------------------------------------------------------
+			Handler for ScriptCallEvent, calls the function and answers the
+			request with its return value
+		---------------------------------------------------------------------*/
+		bool	handleScriptCallEvent(const ScriptCallEvent &e);
+
 	public:
 		/*---------------------------------------------------------------------
 			Returns the main state used by the entire game
@@ -131,6 +162,54 @@ class ScriptManager_Lua : public EventListener {
 		~ScriptManager_Lua();
 };
 
+/*=============================================================================
+class LuaTableWriter
+	Writes script data straight into a Lua table. Code-defined events write
+	their native fields through this, so the table is filled without building
+	an intermediate ScriptVars. Index keys set the next array element
+	(1-based) of the table being written, and nested tables are tracked on a
+	small stack.
+=============================================================================*/
+class LuaTableWriter : public IScriptDataWriter {
+	private:
+		///// STRUCTURES /////
+		struct TableFrame {
+			LuaObject	tbl;
+			int			nextIndex;
+		};
+
+		///// VARIABLES /////
+		vector<TableFrame>	mStack;		// the root table first, innermost last
+
+	public:
+		virtual void	setInt(const ScriptVarKey &key, int val) {
+							TableFrame &f = mStack.back();
+							if (key.isIndex()) f.tbl.SetInteger(f.nextIndex++, val);
+							else f.tbl.SetInteger(key.name, val);
+						}
+		virtual void	setFloat(const ScriptVarKey &key, float val) {
+							TableFrame &f = mStack.back();
+							if (key.isIndex()) f.tbl.SetNumber(f.nextIndex++, val);
+							else f.tbl.SetNumber(key.name, val);
+						}
+		virtual void	setBool(const ScriptVarKey &key, bool val) {
+							TableFrame &f = mStack.back();
+							if (key.isIndex()) f.tbl.SetBoolean(f.nextIndex++, val);
+							else f.tbl.SetBoolean(key.name, val);
+						}
+		virtual void	setString(const ScriptVarKey &key, const string &val) {
+							TableFrame &f = mStack.back();
+							if (key.isIndex()) f.tbl.SetString(f.nextIndex++, val.c_str());
+							else f.tbl.SetString(key.name, val.c_str());
+						}
+		virtual void	beginTable(const ScriptVarKey &key);
+		virtual void	endTable();
+
+		// Constructor
+		explicit LuaTableWriter(LuaObject &root);
+		virtual ~LuaTableWriter() { _ASSERTE(mStack.size() == 1 && "LuaTableWriter: unbalanced beginTable"); }
+};
+
 /*=============================================================================
 class LuaEventHandler
 	This implementation of IEventHandler is for handling events with functions
@@ -149,6 +228,7 @@ class LuaEventHandler : public IEventHandler {
 		typedef pair<LuaObject, uint>		LuaFuncListValue;
 		typedef list<LuaFuncListValue>		LuaFuncList;
 
+	public:
 		///// FUNCTIONS /////
 		// Operators
 		/*---------------------------------------------------------------------
@@ -1,18 +1,23 @@
 /*----==== SCRIPTINGEVENTS.H ====----
 	Author: Jeffrey Kiah
 	Orig.Date: 05/06/2009
-	Rev.Date:  05/06/2009
+	Rev.Date:  10/17/2026
 -----------------------------------*/
 
 #pragma once
 
 #include <string>
 #include "../Event/Event.h"
+#include "../Event/EventSerialization.h"
+#include "../Event/EventFuture.h"
 
 using std::string;
 
 /*=============================================================================
 class LuaFunctionEvent
+	Calls a script function from code on the main thread. Triggered, the
+	return value is set on the event before trigger returns. Use
+	ScriptCallEvent from other threads.
 =============================================================================*/
 class LuaFunctionEvent : public Event {
 	private:
@@ -24,17 +29,25 @@ class LuaFunctionEvent : public Event {
 		///// VARIABLES /////
 		static const string		sEventType; // made public so listeners can register via this variable
 											// and not the actual string value itself
+		static const EventTypeId	sEventTypeId;
 		///// FUNCTIONS /////
 		// Accessors
 		const string &		funcName() const	{ return mFuncName; }
 		const LuaObject &	paramTable() const	{ return mParamTable; }
 		const LuaObject &	returnObj() const	{ return mReturnObj; }
 
-		virtual const string & type() const { return sEventType; }
+		virtual const string &	type() const { return sEventType; }
+		virtual EventTypeId		typeId() const { return sEventTypeId; }
+
+		/*---------------------------------------------------------------------
+			Only the function name is written, LuaObjects belong to a live Lua
+			state and can't be serialized, so the type isn't registered as
+			serializable and isn't recorded
+		---------------------------------------------------------------------*/
+		virtual void	serialize(ostream &out) const	{ writeBinary(out, mFuncName); }
+		virtual void	deserialize(istream &in)		{ readBinary(in, mFuncName); }
 
 		// Mutators
-		virtual void	serialize(ostream &out) const {}
-		virtual void	deserialize(istream &in) {}
 
 		void	setReturnObj(const LuaObject &returnObj) { mReturnObj = returnObj; }
 
@@ -43,4 +56,54 @@ class LuaFunctionEvent : public Event {
 			mFuncName(funcName)
 		{}
 		virtual ~LuaFunctionEvent() {}
-};
\ No newline at end of file
+};
+
+/*=============================================================================
+class ScriptCallEvent
+	Asks script to call a global function, from any thread, and returns the
+	answer through a future. A worker raises it with raiseThreadSafe and
+	carries on, the script manager calls the function when it handles the
+	event in notifyQueued and responds with the function's return value:
+	a returned table is converted like event data, a single value becomes
+	the first array element, nil gives an empty list. The parameters and
+	result are ScriptVars rather than LuaObjects, which belong to the Lua
+	state and must not be touched off the main thread. The future fails if
+	the function doesn't exist or the event is dropped.
+		shared_ptr<ScriptCallEvent> call(new ScriptCallEvent("aiDecide", params));
+		ScriptCallFuture decision = call->future();
+		events.raiseThreadSafe(call);
+=============================================================================*/
+class ScriptCallEvent : public RequestEvent<ScriptVars> {
+	private:
+		string		mFuncName;
+		ScriptVars	mParams;
+
+	public:
+		///// VARIABLES /////
+		static const string			sEventType;
+		static const EventTypeId	sEventTypeId;
+
+		///// FUNCTIONS /////
+		// Accessors
+		const string &		funcName() const	{ return mFuncName; }
+		const ScriptVars &	params() const		{ return mParams; }
+
+		virtual const string &	type() const { return sEventType; }
+		virtual EventTypeId		typeId() const { return sEventTypeId; }
+
+		/*---------------------------------------------------------------------
+			Only the function name is written, the future can't be carried
+			through a log, so the type isn't registered as serializable
+		---------------------------------------------------------------------*/
+		virtual void	serialize(ostream &out) const	{ writeBinary(out, mFuncName); }
+		virtual void	deserialize(istream &in)		{ readBinary(in, mFuncName); }
+
+		// Constructor / destructor
+		explicit ScriptCallEvent(const string &funcName, const ScriptVars &params = ScriptVars()) :
+			RequestEvent<ScriptVars>(),
+			mFuncName(funcName), mParams(params)
+		{}
+		virtual ~ScriptCallEvent() {}
+};
+
+typedef EventFuture<ScriptVars>	ScriptCallFuture;
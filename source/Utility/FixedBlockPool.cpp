@@ -0,0 +1,92 @@
+/*----==== FIXEDBLOCKPOOL.CPP ====----
+	Author:		Jeff Kiah
+	Orig.Date:	10/17/2026
+	Rev.Date:	10/17/2026
+-------------------------------------*/
+
+#include <malloc.h>
+#include <crtdbg.h>
+#include "FixedBlockPool.h"
+
+////////// class FixedBlockPool //////////
+
+/*-----------------------------------------------------------------------------
+	Allocates a new chunk, pushes all but one of its blocks on the free list
+	and returns the one kept back. Another thread may have grown the pool while
+	we waited on the mutex, so check the free list again first.
+-----------------------------------------------------------------------------*/
+void * FixedBlockPool::grow()
+{
+	mutex::scoped_lock lock(mGrowMutex);
+
+	void *p = InterlockedPopEntrySList(&mFreeList);
+	if (p) return p;
+
+	char *chunk = static_cast<char*>(_aligned_malloc(mBlockSize * mBlocksPerChunk, MEMORY_ALLOCATION_ALIGNMENT));
+	if (!chunk) {
+		debugPrintf("FixedBlockPool: failed to allocate chunk of %u bytes\n", mBlockSize * mBlocksPerChunk);
+		return 0;
+	}
+	mChunks.push_back(chunk);
+	InterlockedExchangeAdd(&mBlocksTotal, static_cast<LONG>(mBlocksPerChunk));
+
+	// block 0 is returned to the caller
+	for (size_t b = 1; b < mBlocksPerChunk; ++b) {
+		InterlockedPushEntrySList(&mFreeList, reinterpret_cast<PSLIST_ENTRY>(chunk + b * mBlockSize));
+	}
+	debugPrintf("FixedBlockPool: %u byte pool grown to %d blocks\n", mBlockSize, mBlocksTotal);
+	return chunk;
+}
+
+/*-----------------------------------------------------------------------------
+	Returns a block of blockSize() bytes, never returns null unless the heap
+	itself is exhausted
+-----------------------------------------------------------------------------*/
+void * FixedBlockPool::allocate()
+{
+	void *p = InterlockedPopEntrySList(&mFreeList);
+	if (!p) {
+		p = grow();
+		if (!p) return 0;
+	}
+	InterlockedIncrement(&mBlocksInUse);
+	return p;
+}
+
+/*-----------------------------------------------------------------------------
+	Returns a block to the pool, p must have come from this pool
+-----------------------------------------------------------------------------*/
+void FixedBlockPool::deallocate(void *p)
+{
+	_ASSERTE(p);
+	InterlockedPushEntrySList(&mFreeList, static_cast<PSLIST_ENTRY>(p));
+	InterlockedDecrement(&mBlocksInUse);
+}
+
+// Constructor / destructor
+FixedBlockPool::FixedBlockPool(size_t blockSize, size_t blocksPerChunk) :
+	mChunks(),
+	mBlockSize(0),
+	mBlocksPerChunk(blocksPerChunk),
+	mBlocksInUse(0),
+	mBlocksTotal(0)
+{
+	_ASSERTE(blocksPerChunk > 0);
+	// a block has to hold an SList entry while it sits on the free list
+	if (blockSize < sizeof(SLIST_ENTRY)) blockSize = sizeof(SLIST_ENTRY);
+	mBlockSize = (blockSize + MEMORY_ALLOCATION_ALIGNMENT - 1) & ~(MEMORY_ALLOCATION_ALIGNMENT - 1);
+	InitializeSListHead(&mFreeList);
+}
+
+FixedBlockPool::~FixedBlockPool()
+{
+	_ASSERTE(mBlocksInUse == 0 && "FixedBlockPool destroyed with blocks still in use");
+	if (mBlocksInUse != 0) {
+		debugPrintf("FixedBlockPool: %u byte pool destroyed with %d blocks in use\n", mBlockSize, mBlocksInUse);
+	}
+	InterlockedFlushSList(&mFreeList);
+	vector<void*>::iterator ci, end = mChunks.end();
+	for (ci = mChunks.begin(); ci != end; ++ci) {
+		_aligned_free(*ci);
+	}
+}
@@ -0,0 +1,71 @@
+/*----==== FIXEDBLOCKPOOL.H ====----
+	Author:		Jeff Kiah
+	Orig.Date:	10/17/2026
+	Rev.Date:	10/17/2026
+-----------------------------------*/
+
+#pragma once
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN	// defined in project settings
+#endif
+
+#include <Windows.h>
+#include <vector>
+#include <boost/noncopyable.hpp>
+#include <boost/thread/mutex.hpp>
+#include "Typedefs.h"
+
+using std::vector;
+using boost::mutex;
+
+///// STRUCTURES /////
+
+/*=============================================================================
+class FixedBlockPool
+	Hands out memory blocks of a single fixed size from chunks that are never
+	returned to the heap until the pool is destroyed. The free list is a Win32
+	interlocked SList so allocate and deallocate are lock-free and can be called
+	from any thread. Only growing the pool (when the free list runs dry) takes a
+	mutex, and that happens a handful of times during warm-up, after which the
+	steady state is zero heap traffic.
+	Blocks are aligned to MEMORY_ALLOCATION_ALIGNMENT, which is what the SList
+	requires of its entries and is at least as strict as what new provides.
+=============================================================================*/
+class FixedBlockPool : private boost::noncopyable {
+	private:
+		///// VARIABLES /////
+		SLIST_HEADER	mFreeList;			// must be first for alignment, free blocks are pushed here
+		vector<void*>	mChunks;			// chunks allocated from the heap, freed in destructor
+		mutex			mGrowMutex;			// serializes growth only
+		size_t			mBlockSize;			// size of each block, rounded up to alignment
+		size_t			mBlocksPerChunk;	// how many blocks to add to the pool each time it grows
+		volatile LONG	mBlocksInUse;		// number of blocks currently handed out
+		volatile LONG	mBlocksTotal;		// number of blocks owned by the pool
+
+		///// FUNCTIONS /////
+		/*---------------------------------------------------------------------
+			Allocates a new chunk, pushes all but one of its blocks on the free
+			list and returns the one kept back
+		---------------------------------------------------------------------*/
+		void *	grow();
+
+	public:
+		/*---------------------------------------------------------------------
+			Returns a block of blockSize() bytes, never returns null unless the
+			heap itself is exhausted
+		---------------------------------------------------------------------*/
+		void *	allocate();
+		/*---------------------------------------------------------------------
+			Returns a block to the pool, p must have come from this pool
+		---------------------------------------------------------------------*/
+		void	deallocate(void *p);
+
+		size_t	blockSize() const		{ return mBlockSize; }
+		uint	blocksInUse() const		{ return static_cast<uint>(mBlocksInUse); }
+		uint	blocksTotal() const		{ return static_cast<uint>(mBlocksTotal); }
+
+		// Constructor / destructor
+		explicit FixedBlockPool(size_t blockSize, size_t blocksPerChunk = 256);
+		~FixedBlockPool();
+};
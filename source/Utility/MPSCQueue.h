@@ -0,0 +1,268 @@
+/*----==== MPSCQUEUE.H ====----
+	Author:		Jeff Kiah
+	Orig.Date:	10/17/2026
+	Rev.Date:	10/17/2026
+------------------------------*/
+
+#pragma once
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN	// defined in project settings
+#endif
+
+#include <Windows.h>
+#include <malloc.h>
+#include <new>
+#include <crtdbg.h>
+#include <hash_map>
+#include <boost/noncopyable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include "Typedefs.h"
+
+using boost::mutex;
+using boost::condition_variable;
+using stdext::hash_map;
+
+///// STRUCTURES /////
+
+/*=============================================================================
+class MPSCQueue
+	A lock-free multiple producer, single consumer queue. Producers push onto a
+	Win32 interlocked SList, which is a LIFO stack. The consumer takes the
+	whole stack in one InterlockedFlushSList, reverses it into a private FIFO
+	list, and pops from that without touching shared state until it runs dry.
+	So push is a single interlocked op, and the consumer pays one interlocked
+	op per batch rather than per item.
+	Nodes are recycled through a second SList so that steady state pushing
+	doesn't allocate. waitPop blocks on a condition variable, but producers
+	only take the mutex to signal when a consumer is actually waiting, so the
+	common push path stays lock-free.
+	**NOTE**
+	Only one thread may call tryPop, waitPop, drain or empty at a time. Any
+	number of threads may push. Ordering is FIFO per producer, items from
+	different producers are interleaved in the order their pushes landed.
+=============================================================================*/
+template <typename T>
+class MPSCQueue : private boost::noncopyable {
+	private:
+		///// DEFINITIONS /////
+		struct Node {
+			SLIST_ENTRY	entry;	// must be first, nodes are cast to and from SLIST_ENTRY
+			Node *		next;	// link in the consumer's FIFO list
+			T			data;
+		};
+
+		///// VARIABLES /////
+		SLIST_HEADER	mIncoming;		// producers push here (LIFO)
+		SLIST_HEADER	mFreeNodes;		// recycled nodes, pushed by consumer and popped by producers
+		Node *			mFront;			// consumer-owned FIFO list, popped from the front
+		volatile LONG	mWaiters;		// number of consumers blocked in waitPop (0 or 1)
+		mutex			mMutex;			// only used to sleep/wake a waiting consumer
+		condition_variable	mCondVar;
+
+		///// FUNCTIONS /////
+		/*---------------------------------------------------------------------
+			Takes everything producers have pushed and appends it, oldest
+			first, to the consumer list. Returns false if there was nothing.
+		---------------------------------------------------------------------*/
+		bool	refill() {
+					Node *n = reinterpret_cast<Node*>(InterlockedFlushSList(&mIncoming));
+					if (!n) return false;
+					// the flushed stack is newest first, reverse it
+					Node *reversed = 0;
+					while (n) {
+						Node *nextIn = reinterpret_cast<Node*>(n->entry.Next);
+						n->next = reversed;
+						reversed = n;
+						n = nextIn;
+					}
+					if (!mFront) {
+						mFront = reversed;
+					} else {
+						Node *tail = mFront;
+						while (tail->next) tail = tail->next;
+						tail->next = reversed;
+					}
+					return true;
+				}
+
+		/*---------------------------------------------------------------------
+			Pops the front node into outData and recycles the node. The
+			consumer list must not be empty.
+		---------------------------------------------------------------------*/
+		void	popFront(T &outData) {
+					Node *n = mFront;
+					mFront = n->next;
+					outData = n->data;
+					freeNode(n);
+				}
+
+		Node *	allocNode(const T &inData) {
+					void *p = InterlockedPopEntrySList(&mFreeNodes);
+					if (!p) {
+						p = _aligned_malloc(sizeof(Node), MEMORY_ALLOCATION_ALIGNMENT);
+						if (!p) throw std::bad_alloc();
+					}
+					Node *n = static_cast<Node*>(p);
+					::new(static_cast<void*>(&n->data)) T(inData);
+					n->next = 0;
+					return n;
+				}
+
+		void	freeNode(Node *n) {
+					n->data.~T();
+					InterlockedPushEntrySList(&mFreeNodes, &n->entry);
+				}
+
+	public:
+		/*---------------------------------------------------------------------
+			Lock-free push, safe to call from any thread. Only touches the
+			mutex if the consumer is asleep in waitPop.
+		---------------------------------------------------------------------*/
+		void	push(const T &inData) {
+					Node *n = allocNode(inData);
+					InterlockedPushEntrySList(&mIncoming, &n->entry); // full barrier
+					if (mWaiters > 0) {
+						// taking the lock guarantees the consumer is either inside wait or
+						// hasn't checked the queue yet, so the notify can't be lost
+						mutex::scoped_lock lock(mMutex);
+						lock.unlock();
+						mCondVar.notify_one();
+					}
+				}
+
+		/*---------------------------------------------------------------------
+			Consumer only. Approximate, a push may land right after it returns.
+		---------------------------------------------------------------------*/
+		bool	empty() const {
+					return (!mFront && QueryDepthSList(const_cast<PSLIST_HEADER>(&mIncoming)) == 0);
+				}
+
+		/*---------------------------------------------------------------------
+			Consumer only. Pops the oldest item if there is one, returns
+			immediately either way.
+		---------------------------------------------------------------------*/
+		bool	tryPop(T &outData) {
+					if (!mFront && !refill()) return false;
+					popFront(outData);
+					return true;
+				}
+
+		/*---------------------------------------------------------------------
+			Consumer only. Blocks until an item is available and pops it. Most
+			likely used by a worker thread waiting on the main thread.
+		---------------------------------------------------------------------*/
+		void	waitPop(T &outData) {
+					if (tryPop(outData)) return;
+					mutex::scoped_lock lock(mMutex);
+					InterlockedIncrement(&mWaiters); // full barrier, pairs with the one in push
+					while (!mFront && !refill()) {
+						mCondVar.wait(lock);
+					}
+					InterlockedDecrement(&mWaiters);
+					lock.unlock();
+					popFront(outData);
+				}
+
+		/*---------------------------------------------------------------------
+			Consumer only. Takes every item currently in the queue in a single
+			flush and calls func(const T &) on each, oldest first. Items pushed
+			while draining (including by func itself) are left for next time.
+			If maxItems > 0 at most that many are handled and the rest stay at
+			the front of the queue. Returns the number of items handled.
+		---------------------------------------------------------------------*/
+		template <typename Func>
+		uint	drain(Func func, uint maxItems = 0) {
+					refill();
+					Node *n = mFront;
+					uint count = 0;
+					while (n && (maxItems == 0 || count < maxItems)) {
+						Node *next = n->next;
+						mFront = next; // detach first, in case func pops
+						func(static_cast<const T &>(n->data));
+						freeNode(n);
+						n = next;
+						++count;
+					}
+					return count;
+				}
+
+		/*---------------------------------------------------------------------
+			Consumer only. Discards up to count of the oldest items, returns
+			the number discarded.
+		---------------------------------------------------------------------*/
+		uint	dropFront(uint count) {
+					refill();
+					uint dropped = 0;
+					while (mFront && dropped < count) {
+						Node *n = mFront;
+						mFront = n->next;
+						freeNode(n);
+						++dropped;
+					}
+					return dropped;
+				}
+
+		/*---------------------------------------------------------------------
+			Consumer only. Collapses items that share a key, for everything in
+			the queue. keyFunc(const T &, uint64 &outGroup, uint64 &outKey)
+			returns false for items that never collapse. Items collapse when
+			both group and key are equal. The newest item of each key takes
+			the place of the oldest, and the rest are discarded. Returns the
+			number discarded.
+		---------------------------------------------------------------------*/
+		template <typename KeyFunc>
+		uint	coalesce(KeyFunc keyFunc) {
+					refill();
+					hash_map<uint64, hash_map<uint64, Node*> > firstOfKey; // by group, then key
+					uint removed = 0;
+					Node *prev = 0;
+					Node *n = mFront;
+					while (n) {
+						Node *next = n->next;
+						uint64 group, key;
+						if (keyFunc(static_cast<const T &>(n->data), group, key)) {
+							hash_map<uint64, Node*> &groupKeys = firstOfKey[group];
+							typename hash_map<uint64, Node*>::iterator ki = groupKeys.find(key);
+							if (ki != groupKeys.end()) {
+								using std::swap;
+								swap(ki->second->data, n->data); // keep the newest in the oldest's place
+								prev->next = next; // n isn't the front, a key was seen before it
+								freeNode(n);
+								++removed;
+								n = next;
+								continue;
+							}
+							groupKeys.insert(std::make_pair(key, n));
+						}
+						prev = n;
+						n = next;
+					}
+					return removed;
+				}
+
+		// Constructor / destructor
+		explicit MPSCQueue() :
+			mFront(0),
+			mWaiters(0)
+		{
+			InitializeSListHead(&mIncoming);
+			InitializeSListHead(&mFreeNodes);
+		}
+
+		~MPSCQueue() {
+			_ASSERTE(mWaiters == 0 && "MPSCQueue destroyed with a thread waiting on it");
+			refill();
+			while (mFront) {
+				Node *n = mFront;
+				mFront = n->next;
+				n->data.~T();
+				_aligned_free(n);
+			}
+			void *p;
+			while ((p = InterlockedPopEntrySList(&mFreeNodes)) != 0) {
+				_aligned_free(p);
+			}
+		}
+};
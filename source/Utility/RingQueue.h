@@ -0,0 +1,126 @@
+/*----==== RINGQUEUE.H ====----
+	Author:		Jeff Kiah
+	Orig.Date:	10/17/2026
+	Rev.Date:	10/17/2026
+------------------------------*/
+
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <crtdbg.h>
+#include "Typedefs.h"
+
+using std::vector;
+
+///// STRUCTURES /////
+
+/*=============================================================================
+class RingQueue
+	A growable FIFO over one contiguous buffer. push_back and pop_front are a
+	couple of index operations with no allocation once the buffer has grown to
+	the working size, and the buffer doubles (staying a power of 2) when full.
+	Elements can be accessed by their position from the front, which stays
+	valid until the next pop_front or grow. Every element pushed is also given
+	a sequence number, which stays valid for as long as the element is in the
+	queue regardless of pops and growth. T must be default constructible,
+	and popped slots are reset to T() so resources (like shared_ptr refs) are
+	released right away. Elements are moved with swap when growing, so types
+	with a cheap swap (shared_ptr, containers) never get copied.
+	Not thread-safe.
+=============================================================================*/
+template <typename T>
+class RingQueue {
+	private:
+		///// VARIABLES /////
+		vector<T>	mBuffer;	// size is always a power of 2
+		uint		mMask;		// mBuffer.size() - 1
+		uint		mHead;		// index of the front element
+		uint		mCount;		// number of elements in the queue
+		uint		mFrontSeq;	// sequence number of the front element, wraps
+
+		///// FUNCTIONS /////
+		/*---------------------------------------------------------------------
+			Doubles the buffer, unwrapping the elements to start at index 0
+		---------------------------------------------------------------------*/
+		void	grow() {
+					vector<T> newBuffer(mBuffer.size() * 2);
+					for (uint i = 0; i < mCount; ++i) {
+						using std::swap;
+						swap(newBuffer[i], mBuffer[(mHead + i) & mMask]);
+					}
+					mBuffer.swap(newBuffer);
+					mMask = static_cast<uint>(mBuffer.size()) - 1;
+					mHead = 0;
+				}
+
+	public:
+		uint		size() const	{ return mCount; }
+		bool		empty() const	{ return (mCount == 0); }
+		uint		capacity() const { return static_cast<uint>(mBuffer.size()); }
+
+		T &			front()			{ _ASSERTE(mCount > 0); return mBuffer[mHead]; }
+		const T &	front() const	{ _ASSERTE(mCount > 0); return mBuffer[mHead]; }
+
+		/*---------------------------------------------------------------------
+			Access by position from the front, 0 is the front
+		---------------------------------------------------------------------*/
+		T &			operator[](uint i)			{ _ASSERTE(i < mCount); return mBuffer[(mHead + i) & mMask]; }
+		const T &	operator[](uint i) const	{ _ASSERTE(i < mCount); return mBuffer[(mHead + i) & mMask]; }
+
+		/*---------------------------------------------------------------------
+			Access by sequence number. nextSequence is the number the next
+			push_back will get, hasSequence tells if an element is still in
+			the queue.
+		---------------------------------------------------------------------*/
+		uint		nextSequence() const			{ return mFrontSeq + mCount; }
+		bool		hasSequence(uint seq) const		{ return ((seq - mFrontSeq) < mCount); }
+		T &			atSequence(uint seq)			{ return (*this)[seq - mFrontSeq]; }
+		const T &	atSequence(uint seq) const		{ return (*this)[seq - mFrontSeq]; }
+
+		void		push_back(const T &val) {
+						if (mCount == mBuffer.size()) grow();
+						mBuffer[(mHead + mCount) & mMask] = val;
+						++mCount;
+					}
+
+		void		pop_front() {
+						_ASSERTE(mCount > 0);
+						mBuffer[mHead] = T();
+						mHead = (mHead + 1) & mMask;
+						--mCount;
+						++mFrontSeq;
+					}
+
+		/*---------------------------------------------------------------------
+			Swaps the front element into out and pops it, avoiding a copy
+		---------------------------------------------------------------------*/
+		void		pop_front(T &out) {
+						_ASSERTE(mCount > 0);
+						using std::swap;
+						swap(out, mBuffer[mHead]);
+						mBuffer[mHead] = T();
+						mHead = (mHead + 1) & mMask;
+						--mCount;
+						++mFrontSeq;
+					}
+
+		void		clear() {
+						while (mCount > 0) pop_front();
+						mHead = 0;
+					}
+
+		// Constructor
+		explicit RingQueue(uint initialCapacity = 256) :
+			mBuffer(),
+			mMask(0),
+			mHead(0),
+			mCount(0),
+			mFrontSeq(0)
+		{
+			uint size = 16;
+			while (size < initialCapacity) size <<= 1;
+			mBuffer.resize(size);
+			mMask = size - 1;
+		}
+};
@@ -1,17 +1,19 @@
 /*----==== WINMAIN.CPP ====----
 	Author:		Jeff Kiah
 	Orig.Date:	07/21/2007
-	Rev.Date:	06/25/2009
+	Rev.Date:	10/17/2026
 -----------------------------*/
 
 #include "Win32.h"
 #include <crtdbg.h>
 #include <cstdlib>
+#include <cstring>
 #include <boost/scoped_ptr.hpp>
 
 #include "Engine.h"
 #include "Settings.h"
 #include "HighPerfTimer.h"
+#include "Event/EventBenchmark.h"
 
 using boost::scoped_ptr;
 
@@ -41,6 +43,20 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
 		return 0;
 	}
 
+	#if EVENT_BENCHMARK
+		// run the event system benchmarks instead of the engine, -eventbench[=file.json]
+		const char *benchArg = strstr(lpCmdLine, EVENTBENCH_SWITCH);
+		if (benchArg) {
+			benchArg += sizeof(EVENTBENCH_SWITCH) - 1;
+			string benchFile(EVENTBENCH_DEFAULT_FILE);
+			if (*benchArg == '=') {
+				const char *fileEnd = strchr(++benchArg, ' ');
+				benchFile.assign(benchArg, fileEnd ? fileEnd : benchArg + strlen(benchArg));
+			}
+			return runEventBenchmarks(benchFile) ? 0 : 1;
+		}
+	#endif
+
 	scoped_ptr<Engine> engineInst(new Engine);
 
 	if (!engineInst->initEngine()) {